@@ -0,0 +1,46 @@
+#!/usr/bin/env bash
+# Builds, cooks and stages the CoopGameServer target, then reports what one match instance costs.
+# Usage: Scripts/PackageServer.sh <UE4 root> [Linux|Win64] [archive dir]
+
+set -euo pipefail
+
+UE_ROOT=${1:?"Usage: $0 <UE4 root> [Linux|Win64] [archive dir]"}
+PLATFORM=${2:-Linux}
+PROJECT_DIR=$(cd "$(dirname "$0")/.." && pwd)
+ARCHIVE_DIR=${3:-$PROJECT_DIR/Packaged}
+MAP=/Game/Maps/CyberPunk
+# Seconds to let a server instance load the map and start the first wave before sampling its memory
+SETTLE_TIME=${SETTLE_TIME:-30}
+
+"$UE_ROOT/Engine/Build/BatchFiles/RunUAT.sh" BuildCookRun \
+	-project="$PROJECT_DIR/CoopGame.uproject" -noP4 -utf8output \
+	-server -noclient -serverplatform="$PLATFORM" -serverconfig=Development \
+	-map="$MAP" -build -cook -stage -pak -archive -archivedirectory="$ARCHIVE_DIR"
+
+STAGED_DIR="$ARCHIVE_DIR/${PLATFORM}Server"
+if [ "$PLATFORM" = "Win64" ]; then
+	STAGED_DIR="$ARCHIVE_DIR/WindowsServer"
+fi
+
+BINARY_BYTES=$(find "$STAGED_DIR" -path "*/Binaries/*" -type f -print0 | du -cb --files0-from=- | tail -n 1 | cut -f 1)
+COOKED_BYTES=$(find "$STAGED_DIR" -name "*.pak" -type f -print0 | du -cb --files0-from=- | tail -n 1 | cut -f 1)
+
+echo "Server binaries: $((BINARY_BYTES / 1048576)) MB"
+echo "Server cooked content: $((COOKED_BYTES / 1048576)) MB"
+
+if [ "$PLATFORM" != "Linux" ]; then
+	echo "Resident memory is only measured for Linux servers"
+	exit 0
+fi
+
+SERVER_BIN="$STAGED_DIR/CoopGame/Binaries/Linux/CoopGameServer"
+"$SERVER_BIN" CoopGame "$MAP" -log -unattended -port=17777 > "$ARCHIVE_DIR/ServerInstance.log" 2>&1 &
+SERVER_PID=$!
+trap 'kill $SERVER_PID 2>/dev/null || true' EXIT
+
+sleep "$SETTLE_TIME"
+
+RSS_KB=$(awk '/^VmRSS/ { print $2 }' "/proc/$SERVER_PID/status")
+HWM_KB=$(awk '/^VmHWM/ { print $2 }' "/proc/$SERVER_PID/status")
+
+echo "Resident memory per instance: $((RSS_KB / 1024)) MB (peak $((HWM_KB / 1024)) MB)"
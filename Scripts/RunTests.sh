@@ -0,0 +1,26 @@
+#!/usr/bin/env bash
+# Runs the CoopGame automation tests headless, including the damage benchmark, and writes a report.
+# Usage: Scripts/RunTests.sh <UE4 root> [test filter] [report dir]
+
+set -euo pipefail
+
+UE_ROOT=${1:?"Usage: $0 <UE4 root> [test filter] [report dir]"}
+FILTER=${2:-CoopGame}
+PROJECT_DIR=$(cd "$(dirname "$0")/.." && pwd)
+REPORT_DIR=${3:-$PROJECT_DIR/Saved/TestReports}
+
+case "$(uname -s)" in
+	Linux*) EDITOR_BIN="$UE_ROOT/Engine/Binaries/Linux/UE4Editor-Cmd" ;;
+	Darwin*) EDITOR_BIN="$UE_ROOT/Engine/Binaries/Mac/UE4Editor-Cmd" ;;
+	*) EDITOR_BIN="$UE_ROOT/Engine/Binaries/Win64/UE4Editor-Cmd.exe" ;;
+esac
+
+mkdir -p "$REPORT_DIR"
+
+"$EDITOR_BIN" "$PROJECT_DIR/CoopGame.uproject" \
+	-ExecCmds="Automation RunTests $FILTER; Quit" \
+	-unattended -nullrhi -nosplash -nosound -nopause -stdout -utf8output \
+	-ReportOutputPath="$REPORT_DIR" -abslog="$REPORT_DIR/Tests.log"
+
+# The benchmark reports its ns per event as test info lines
+grep -h "ns/event" "$REPORT_DIR/Tests.log" || true
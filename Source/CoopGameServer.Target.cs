@@ -0,0 +1,19 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+using UnrealBuildTool;
+using System.Collections.Generic;
+
+public class CoopGameServerTarget : TargetRules
+{
+	public CoopGameServerTarget(TargetInfo Target) : base(Target)
+	{
+		Type = TargetType.Server;
+
+		ExtraModuleNames.AddRange( new string[] { "CoopGame" } );
+
+		// Several match instances share a host, leave out what only clients need
+		bCompileCEF3 = false;
+		bUseLoggingInShipping = true;
+		bWithPerfCounters = true;
+	}
+}
@@ -3,8 +3,16 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "Stats/Stats.h"
 
 #define SURFACE_FLESHDEFAULT		SurfaceType1
 #define SURFACE_FLESHVULNERABLE		SurfaceType2
 
-#define COLLISION_WEAPON			ECC_GameTraceChannel1
\ No newline at end of file
+#define COLLISION_WEAPON			ECC_GameTraceChannel1
+
+// Effects, sounds and camera shakes are compiled out of server targets
+#ifndef WITH_COOP_COSMETICS
+#define WITH_COOP_COSMETICS			!UE_SERVER
+#endif
+
+DECLARE_STATS_GROUP(TEXT("CoopGame"), STATGROUP_CoopGame, STATCAT_Advanced);
\ No newline at end of file
@@ -0,0 +1,81 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "SBTTask_FlowFieldChase.h"
+#include "SFlowFieldComponent.h"
+#include "SGameMode.h"
+#include "AIController.h"
+#include "BehaviorTree/BlackboardComponent.h"
+#include "GameFramework/Pawn.h"
+
+
+USBTTask_FlowFieldChase::USBTTask_FlowFieldChase()
+{
+	NodeName = "Chase (Flow Field)";
+	bNotifyTick = true;
+
+	AcceptableRadius = 150.0f;
+	bSteerDirectlyWhenOffField = true;
+
+	BlackboardKey.AddObjectFilter(this, GET_MEMBER_NAME_CHECKED(USBTTask_FlowFieldChase, BlackboardKey), AActor::StaticClass());
+}
+
+
+EBTNodeResult::Type USBTTask_FlowFieldChase::ExecuteTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory)
+{
+	AAIController* AIController = OwnerComp.GetAIOwner();
+	UBlackboardComponent* Blackboard = OwnerComp.GetBlackboardComponent();
+	if (AIController == nullptr || AIController->GetPawn() == nullptr || Blackboard == nullptr)
+	{
+		return EBTNodeResult::Failed;
+	}
+
+	if (Cast<AActor>(Blackboard->GetValueAsObject(BlackboardKey.SelectedKeyName)) == nullptr)
+	{
+		return EBTNodeResult::Failed;
+	}
+
+	return EBTNodeResult::InProgress;
+}
+
+
+void USBTTask_FlowFieldChase::TickTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, float DeltaSeconds)
+{
+	AAIController* AIController = OwnerComp.GetAIOwner();
+	APawn* MyPawn = AIController ? AIController->GetPawn() : nullptr;
+	AActor* TargetActor = Cast<AActor>(OwnerComp.GetBlackboardComponent()->GetValueAsObject(BlackboardKey.SelectedKeyName));
+	if (MyPawn == nullptr || TargetActor == nullptr)
+	{
+		FinishLatentTask(OwnerComp, EBTNodeResult::Failed);
+		return;
+	}
+
+	const FVector MyLocation = MyPawn->GetActorLocation();
+	if (FVector::DistSquared2D(MyLocation, TargetActor->GetActorLocation()) <= FMath::Square(AcceptableRadius))
+	{
+		FinishLatentTask(OwnerComp, EBTNodeResult::Succeeded);
+		return;
+	}
+
+	ASGameMode* GM = Cast<ASGameMode>(GetWorld()->GetAuthGameMode());
+	USFlowFieldComponent* FlowField = GM ? GM->GetFlowFieldComp() : nullptr;
+
+	FVector MoveDirection;
+	if (FlowField == nullptr || !FlowField->GetFlowDirection(MyLocation, TargetActor, MoveDirection))
+	{
+		if (!bSteerDirectlyWhenOffField)
+		{
+			FinishLatentTask(OwnerComp, EBTNodeResult::Failed);
+			return;
+		}
+
+		MoveDirection = (TargetActor->GetActorLocation() - MyLocation).GetSafeNormal2D();
+	}
+
+	MyPawn->AddMovementInput(MoveDirection);
+}
+
+
+FString USBTTask_FlowFieldChase::GetStaticDescription() const
+{
+	return FString::Printf(TEXT("%s: %s (radius %.0f)"), *Super::GetStaticDescription(), *BlackboardKey.SelectedKeyName.ToString(), AcceptableRadius);
+}
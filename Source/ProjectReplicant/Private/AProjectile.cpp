@@ -8,6 +8,8 @@
 #include <Runtime\Engine\Classes\Kismet\GameplayStatics.h>
 #include <ProjectReplicant\Public\SCharacter.h>
 #include <ProjectReplicant\CoopGame.h>
+#include "SFXManagerComponent.h"
+#include "SDamageQueueComponent.h"
 
 AProjectile::AProjectile()
 {
@@ -36,70 +38,121 @@ AProjectile::AProjectile()
 	// Die after 3 seconds by default
 	InitialLifeSpan = 3.0f;
 
-	SetReplicates(true);
-	SetReplicateMovement(true);
+	ProjectileId = 0;
+	bSimulated = false;
+
+	// Matches the health component's unassigned team until InitProjectile reads the owner's
+	TeamNum = 255;
+
+	// Clients simulate their own copy from the weapon's spawn event, no actor channel or movement replication
+	SetReplicates(false);
+	SetReplicateMovement(false);
+}
+
+void AProjectile::InitProjectile(ASWeapon* Weapon, uint16 InProjectileId, float Speed, bool bInSimulated)
+{
+	SourceWeapon = Weapon;
+	ProjectileId = InProjectileId;
+	bSimulated = bInSimulated;
+
+	ProjectileMovement->InitialSpeed = Speed;
+	ProjectileMovement->MaxSpeed = FMath::Max(ProjectileMovement->MaxSpeed, Speed);
+
+	ASCharacter* SCharacter = Cast<ASCharacter>(GetOwner());
+	if (SCharacter)
+	{
+		TeamNum = SCharacter->TeamNum;
+	}
+
+	// Pawns move differently on each machine, only the server decides what a projectile hits among them
+	if (bSimulated)
+	{
+		CollisionComp->SetCollisionResponseToChannel(ECC_Pawn, ECR_Ignore);
+	}
+}
+
+void AProjectile::TerminateAt(const FVector& ImpactPoint, EPhysicalSurface InSurfaceType)
+{
+	SetActorLocation(ImpactPoint);
+
+	PlayImpactEffects(InSurfaceType, ImpactPoint);
+
+	Destroy();
 }
 
 void AProjectile::OnHit(UPrimitiveComponent* HitComp, AActor* OtherActor, UPrimitiveComponent* OtherComp, FVector NormalImpulse, const FHitResult& Hit)
 {
 	AActor* MyOwner = this;
-	AActor* ProjectileOwner = this->GetOwner();
-	ASCharacter* SCharacter = Cast<ASCharacter>(ProjectileOwner);
-	ASWeapon* currentWeapon = SCharacter->GetCurrentWeapon();
-	float baseDamage = currentWeapon->GetBaseDamage();
-	TeamNum = SCharacter->TeamNum;
-	UParticleSystem* FleshImpactEffect = currentWeapon->GetFleshImpactEffect();;
-	UParticleSystem* DefaultImpactEffect = currentWeapon->GetDefaultImpactEffect();
-	USoundBase* ImpactSound = currentWeapon->GetImpactSound();
-	EPhysicalSurface SurfaceType = SurfaceType_Default;
-	SurfaceType = UPhysicalMaterial::DetermineSurfaceType(Hit.PhysMaterial.Get());
-
-	if (ImpactSound)
+	ASWeapon* currentWeapon = SourceWeapon.Get();
+	if (currentWeapon == nullptr)
 	{
-		UGameplayStatics::PlaySoundAtLocation(GetWorld(), ImpactSound, Hit.ImpactNormal);
+		this->Destroy();
+		return;
 	}
+	float baseDamage = currentWeapon->GetBaseDamage();
+
+	EPhysicalSurface HitSurfaceType = UPhysicalMaterial::DetermineSurfaceType(Hit.PhysMaterial.Get());
+
 	//play the impact effect
-	PlayImpactEffects(SurfaceType, Hit.ImpactPoint, DefaultImpactEffect, FleshImpactEffect);
+	PlayImpactEffects(HitSurfaceType, Hit.ImpactPoint);
+
+	if (bSimulated)
+	{
+		this->Destroy();
+		return;
+	}
+
+	// Clients end their simulated copy here
+	currentWeapon->OnProjectileImpact(ProjectileId, Hit.ImpactPoint, HitSurfaceType);
+
+	// Only the server has a damage queue
+	USDamageQueueComponent* DamageQueue = USDamageQueueComponent::Get(this);
 
 	//If projectile type apply damage
-	if (this->ProjectileType == ProjectileType::Projectile)
+	if (DamageQueue && this->ProjectileType == ProjectileType::Projectile)
 	{
 		if ((OtherActor != NULL) && (OtherActor != this) && (OtherComp != NULL))
 		{
-			UGameplayStatics::ApplyDamage(OtherActor, baseDamage, MyOwner->GetInstigatorController(), MyOwner, DamageType);
+			DamageQueue->QueueDamage(OtherActor, baseDamage, DamageType, MyOwner->GetInstigatorController(), MyOwner);
 		}
 	}
 
 	//If AOE type Conditionally deal AE damage
-	if (ProjectileType == ProjectileType::AOE)
+	if (DamageQueue && ProjectileType == ProjectileType::AOE)
 	{
-		UWorld* world = GetWorld();
 		const  TArray<AActor*> IgnoreActors;
 		AController* EventInstigator = GetInstigatorController();
-		UGameplayStatics::ApplyRadialDamage(world, baseDamage, GetActorLocation(), AOERadius, DamageType, IgnoreActors, MyOwner, EventInstigator, true);
+		DamageQueue->QueueRadialDamage(GetActorLocation(), AOERadius, baseDamage, DamageType, IgnoreActors, EventInstigator, MyOwner);
 	}
 
 	this->Destroy();
 }
 
-void AProjectile::PlayImpactEffects(EPhysicalSurface SurfaceType, FVector ImpactPoint, UParticleSystem* DefaultImpactEffect, UParticleSystem* FleshImpactEffect)
+void AProjectile::PlayImpactEffects(EPhysicalSurface SurfaceType, FVector ImpactPoint)
 {
+#if WITH_COOP_COSMETICS
+	USFXManagerComponent* FXManager = USFXManagerComponent::Get(this);
+	ASWeapon* Weapon = SourceWeapon.Get();
+	if (FXManager == nullptr || Weapon == nullptr)
+	{
+		return;
+	}
+
 	UParticleSystem* SelectedEffect = nullptr;
 	switch (SurfaceType)
 	{
 	case SURFACE_FLESHDEFAULT:
 	case SURFACE_FLESHVULNERABLE:
-		SelectedEffect = FleshImpactEffect;
+		SelectedEffect = Weapon->GetFleshImpactEffect();
 		break;
 	default:
-		SelectedEffect = DefaultImpactEffect;
+		SelectedEffect = Weapon->GetDefaultImpactEffect();
 		break;
 	}
 
-	if (SelectedEffect)
-	{
-		UGameplayStatics::SpawnEmitterAtLocation(GetWorld(), SelectedEffect, ImpactPoint);
-	}
+	FXManager->SpawnEmitterAtLocation(ESFXKind::Impact, SelectedEffect, ImpactPoint);
+	FXManager->PlaySoundAtLocation(Weapon->GetImpactSound(), ImpactPoint);
+#endif
 }
 
 uint8 AProjectile::GetTeamNum()
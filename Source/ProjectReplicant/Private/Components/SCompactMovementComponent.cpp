@@ -0,0 +1,309 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "SCompactMovementComponent.h"
+#include "STickRateComponent.h"
+#include "CoopGame.h"
+#include "GameFramework/Character.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "GameFramework/PlayerController.h"
+#include "Engine/NetSerialization.h"
+#include "Engine/World.h"
+#include "Net/UnrealNetwork.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Compact Movement Extrapolating"), STAT_CompactMovementExtrapolating, STATGROUP_CoopGame);
+
+// Samples kept on the client, a couple of seconds even at the lowest send rate
+static const int32 MaxSamples = 8;
+
+// Stamps (hundredths of a second) a sample may arrive behind the last one and still count as merely late
+static const int16 CompactMovementStaleStamps = 100;
+
+
+bool FSCompactMovement::NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess)
+{
+	// Same packing as FVector_NetQuantize, whole units with the bit count scaled to the value
+	bOutSuccess = SerializePackedVector<1, 20>(Location, Ar);
+
+	Ar << Yaw;
+	Ar << TimeStamp;
+
+	return true;
+}
+
+
+// Sets default values for this component's properties
+USCompactMovementComponent::USCompactMovementComponent()
+{
+	PrimaryComponentTick.bCanEverTick = true;
+	PrimaryComponentTick.bStartWithTickEnabled = false;
+
+	SetIsReplicated(true);
+
+	bCompactMovement = false;
+	MaxUpdateRate = 20.0f;
+	MinUpdateRate = 2.0f;
+	FarViewerDistance = 6000.0f;
+	MaxExtrapolationTime = 0.25f;
+	TeleportDistance = 1000.0f;
+
+	TimeToRateUpdate = 0.0f;
+	ServerTimeOffset = 0.0;
+	AverageSampleInterval = 0.1f;
+	LastTimeStamp = 0;
+}
+
+
+void USCompactMovementComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	OwnerCharacter = Cast<ACharacter>(GetOwner());
+	if (!bCompactMovement || OwnerCharacter == nullptr)
+	{
+		return;
+	}
+
+	if (GetOwnerRole() == ROLE_Authority)
+	{
+		OwnerCharacter->SetReplicateMovement(false);
+	}
+	else
+	{
+		// Movement is driven from the samples, nothing to simulate
+		OwnerCharacter->GetCharacterMovement()->SetComponentTickEnabled(false);
+	}
+
+	SetComponentTickEnabled(true);
+}
+
+
+bool USCompactMovementComponent::IsCompactMovementEnabled() const
+{
+	return bCompactMovement && OwnerCharacter != nullptr;
+}
+
+
+void USCompactMovementComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	if (GetOwnerRole() == ROLE_Authority)
+	{
+		UpdateServer(DeltaTime);
+	}
+	else if (GetOwnerRole() == ROLE_SimulatedProxy)
+	{
+		UpdateClient();
+	}
+}
+
+
+void USCompactMovementComponent::UpdateServer(float DeltaTime)
+{
+	FSCompactMovement NewMovement;
+	const FVector Location = OwnerCharacter->GetActorLocation();
+	NewMovement.Location = FVector(FMath::RoundToFloat(Location.X), FMath::RoundToFloat(Location.Y), FMath::RoundToFloat(Location.Z));
+	NewMovement.Yaw = FRotator::CompressAxisToByte(OwnerCharacter->GetActorRotation().Yaw);
+
+	// Only a changed position gets a new time stamp, bots standing still send nothing
+	if (NewMovement.Location != Movement.Location || NewMovement.Yaw != Movement.Yaw)
+	{
+		NewMovement.TimeStamp = (uint16)((uint32)(GetWorld()->TimeSeconds * 100.0f) & 0xFFFF);
+		Movement = NewMovement;
+	}
+
+	TimeToRateUpdate -= DeltaTime;
+	if (TimeToRateUpdate > 0.0f)
+	{
+		return;
+	}
+	TimeToRateUpdate = 0.25f;
+
+	const float Speed = OwnerCharacter->GetVelocity().Size();
+	float UpdateRate = MinUpdateRate;
+	if (Speed > 1.0f)
+	{
+		const float DistanceAlpha = FMath::Clamp(GetNearestViewerDistance() / FarViewerDistance, 0.0f, 1.0f);
+		const float SpeedAlpha = FMath::Clamp(Speed / OwnerCharacter->GetCharacterMovement()->GetMaxSpeed(), 0.0f, 1.0f);
+		UpdateRate = FMath::Lerp(MinUpdateRate, MaxUpdateRate, SpeedAlpha * (1.0f - DistanceAlpha));
+	}
+
+	// Updates beyond the server tick rate can't be sent
+	const int32 ServerTickRate = USTickRateComponent::GetServerTickRate(this);
+	if (ServerTickRate > 0)
+	{
+		UpdateRate = FMath::Min(UpdateRate, (float)ServerTickRate);
+	}
+
+	OwnerCharacter->NetUpdateFrequency = FMath::Max(UpdateRate, MinUpdateRate);
+	OwnerCharacter->MinNetUpdateFrequency = MinUpdateRate;
+}
+
+
+float USCompactMovementComponent::GetNearestViewerDistance() const
+{
+	float NearestDistSquared = BIG_NUMBER;
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		APlayerController* PC = It->Get();
+		if (PC && PC->GetPawn())
+		{
+			NearestDistSquared = FMath::Min(NearestDistSquared, FVector::DistSquared(PC->GetPawn()->GetActorLocation(), OwnerCharacter->GetActorLocation()));
+		}
+	}
+
+	return FMath::Sqrt(NearestDistSquared);
+}
+
+
+float USCompactMovementComponent::GetNetPriorityScale(const FVector& ViewLocation) const
+{
+	if (!IsCompactMovementEnabled())
+	{
+		return 1.0f;
+	}
+
+	const float DistanceAlpha = FMath::Clamp(FVector::Dist(ViewLocation, OwnerCharacter->GetActorLocation()) / FarViewerDistance, 0.0f, 1.0f);
+
+	return FMath::Lerp(1.0f, 0.25f, DistanceAlpha);
+}
+
+
+void USCompactMovementComponent::OnRep_Movement()
+{
+	if (!IsCompactMovementEnabled())
+	{
+		return;
+	}
+
+	const double LocalTime = GetWorld()->GetTimeSeconds();
+
+	FSCompactMovementSample Sample;
+	Sample.Location = Movement.Location;
+	Sample.Yaw = FRotator::DecompressAxisFromByte(Movement.Yaw);
+
+	// Time stamps wrap every 655 seconds, the signed difference stays correct across the wrap up to half of that
+	const int16 StampDelta = (int16)(Movement.TimeStamp - LastTimeStamp);
+	if (Samples.Num() > 0 && StampDelta < -CompactMovementStaleStamps)
+	{
+		// Not a late packet, more than ~327 seconds passed since the last update and the difference flipped sign. Start over
+		Samples.Reset();
+	}
+
+	if (Samples.Num() == 0)
+	{
+		// The first sample sets the time base, only differences between stamps matter
+		Sample.ServerTime = LocalTime;
+	}
+	else
+	{
+		const FSCompactMovementSample& Last = Samples.Last();
+
+		if (StampDelta <= 0)
+		{
+			// Stale or duplicate
+			return;
+		}
+
+		Sample.ServerTime = Last.ServerTime + StampDelta * 0.01;
+
+		if (FVector::DistSquared(Sample.Location, Last.Location) > FMath::Square(TeleportDistance))
+		{
+			Samples.Reset();
+		}
+		else
+		{
+			AverageSampleInterval = FMath::Lerp(AverageSampleInterval, (float)(Sample.ServerTime - Last.ServerTime), 0.2f);
+		}
+	}
+
+	// Smooth the clock estimate so one late packet doesn't shift the render time
+	const double SampleOffset = Sample.ServerTime - LocalTime;
+	ServerTimeOffset = Samples.Num() == 0 ? SampleOffset : FMath::Lerp(ServerTimeOffset, SampleOffset, 0.1);
+
+	LastTimeStamp = Movement.TimeStamp;
+
+	if (Samples.Num() >= MaxSamples)
+	{
+		Samples.RemoveAt(0, 1, false);
+	}
+	Samples.Add(Sample);
+
+	if (Samples.Num() == 1)
+	{
+		OwnerCharacter->SetActorLocationAndRotation(Sample.Location, FRotator(0.0f, Sample.Yaw, 0.0f));
+	}
+}
+
+
+void USCompactMovementComponent::UpdateClient()
+{
+	if (Samples.Num() == 0)
+	{
+		return;
+	}
+
+	// Render a bit more than one send interval in the past so there is usually a sample on each side
+	const float InterpolationDelay = FMath::Clamp(AverageSampleInterval * 1.5f, 0.05f, 0.6f);
+	const double RenderTime = GetWorld()->GetTimeSeconds() + ServerTimeOffset - InterpolationDelay;
+
+	FVector Location = Samples[0].Location;
+	float Yaw = Samples[0].Yaw;
+	FVector Velocity = FVector::ZeroVector;
+
+	const FSCompactMovementSample& Last = Samples.Last();
+	if (RenderTime >= Last.ServerTime)
+	{
+		Location = Last.Location;
+		Yaw = Last.Yaw;
+
+		if (Samples.Num() >= 2)
+		{
+			const FSCompactMovementSample& Previous = Samples[Samples.Num() - 2];
+			Velocity = (Last.Location - Previous.Location) / FMath::Max((float)(Last.ServerTime - Previous.ServerTime), KINDA_SMALL_NUMBER);
+
+			const float ExtrapolationTime = FMath::Min((float)(RenderTime - Last.ServerTime), MaxExtrapolationTime);
+			Location += Velocity * ExtrapolationTime;
+
+			if (RenderTime - Last.ServerTime > MaxExtrapolationTime)
+			{
+				Velocity = FVector::ZeroVector;
+			}
+			else
+			{
+				INC_DWORD_STAT(STAT_CompactMovementExtrapolating);
+			}
+		}
+	}
+	else
+	{
+		for (int32 i = Samples.Num() - 1; i > 0; i--)
+		{
+			const FSCompactMovementSample& From = Samples[i - 1];
+			const FSCompactMovementSample& To = Samples[i];
+			if (RenderTime >= From.ServerTime)
+			{
+				const float Interval = FMath::Max((float)(To.ServerTime - From.ServerTime), KINDA_SMALL_NUMBER);
+				const float Alpha = FMath::Clamp((float)(RenderTime - From.ServerTime) / Interval, 0.0f, 1.0f);
+
+				Location = FMath::Lerp(From.Location, To.Location, Alpha);
+				Yaw = FMath::Lerp(FRotator(0.0f, From.Yaw, 0.0f), FRotator(0.0f, To.Yaw, 0.0f), Alpha).Yaw;
+				Velocity = (To.Location - From.Location) / Interval;
+				break;
+			}
+		}
+	}
+
+	OwnerCharacter->SetActorLocationAndRotation(Location, FRotator(0.0f, Yaw, 0.0f));
+
+	// Animation blueprints read the speed from the movement component
+	OwnerCharacter->GetCharacterMovement()->Velocity = Velocity;
+}
+
+
+void USCompactMovementComponent::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME(USCompactMovementComponent, Movement);
+}
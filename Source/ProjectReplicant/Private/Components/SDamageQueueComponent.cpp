@@ -0,0 +1,229 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "SDamageQueueComponent.h"
+#include "SHealthComponent.h"
+#include "SGameMode.h"
+#include "SMatchRecorderComponent.h"
+#include "CoopGame.h"
+#include "GameFramework/DamageType.h"
+#include "Engine/World.h"
+
+DECLARE_CYCLE_STAT(TEXT("Damage Resolve"), STAT_DamageResolve, STATGROUP_CoopGame);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Damage Hits"), STAT_DamageHits, STATGROUP_CoopGame);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Damage Victims"), STAT_DamageVictims, STATGROUP_CoopGame);
+
+
+// Same damage event ApplyDamage, ApplyPointDamage or ApplyRadialDamage would send, so the victim's damage events and impulses still happen
+static void TakeQueuedDamage(AActor* Victim, const FSDamageRecord& Record)
+{
+	const TSubclassOf<UDamageType> ValidDamageType = Record.DamageType ? Record.DamageType : TSubclassOf<UDamageType>(UDamageType::StaticClass());
+	AController* InstigatedBy = Record.InstigatedBy.Get();
+	AActor* DamageCauser = Record.DamageCauser.Get(true);
+
+	switch (Record.Kind)
+	{
+	case ESDamageKind::Point:
+		Victim->TakeDamage(Record.Damage, FPointDamageEvent(Record.Damage, Record.HitInfo, Record.ShotDirection, ValidDamageType), InstigatedBy, DamageCauser);
+		break;
+	case ESDamageKind::Radial:
+	{
+		// Inner and outer radius match, full damage anywhere in the blast
+		FRadialDamageEvent DamageEvent;
+		DamageEvent.DamageTypeClass = ValidDamageType;
+		DamageEvent.Origin = Record.Origin;
+		DamageEvent.Params = FRadialDamageParams(Record.Damage, Record.Radius);
+		DamageEvent.ComponentHits.Add(Record.HitInfo);
+		Victim->TakeDamage(Record.Damage, DamageEvent, InstigatedBy, DamageCauser);
+		break;
+	}
+	default:
+		Victim->TakeDamage(Record.Damage, FDamageEvent(ValidDamageType), InstigatedBy, DamageCauser);
+		break;
+	}
+}
+
+
+// Sets default values for this component's properties
+USDamageQueueComponent::USDamageQueueComponent()
+{
+	PrimaryComponentTick.bCanEverTick = true;
+	// After movement, timers and projectile hits, so everything dealt this frame lands this frame
+	PrimaryComponentTick.TickGroup = TG_PostUpdateWork;
+
+	TotalHitsResolved = 0;
+}
+
+
+USDamageQueueComponent* USDamageQueueComponent::Get(const UObject* WorldContextObject)
+{
+	UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	ASGameMode* GM = World ? Cast<ASGameMode>(World->GetAuthGameMode()) : nullptr;
+
+	return GM ? GM->GetDamageQueueComp() : nullptr;
+}
+
+
+int32 USDamageQueueComponent::GetNumHitsResolved() const
+{
+	return TotalHitsResolved;
+}
+
+
+FSDamageRecord* USDamageQueueComponent::AddRecord(AActor* Victim, float Damage, TSubclassOf<UDamageType> DamageType, AController* InstigatedBy, AActor* DamageCauser)
+{
+	if (Victim == nullptr || Damage == 0.0f)
+	{
+		return nullptr;
+	}
+
+	FSDamageRecord& Record = PendingDamage.AddDefaulted_GetRef();
+	Record.Victim = Victim;
+	Record.Damage = Damage;
+	Record.DamageType = DamageType;
+	Record.InstigatedBy = InstigatedBy;
+	Record.DamageCauser = DamageCauser;
+
+	return &Record;
+}
+
+
+void USDamageQueueComponent::QueueDamage(AActor* Victim, float Damage, TSubclassOf<UDamageType> DamageType, AController* InstigatedBy, AActor* DamageCauser)
+{
+	AddRecord(Victim, Damage, DamageType, InstigatedBy, DamageCauser);
+}
+
+
+void USDamageQueueComponent::QueuePointDamage(AActor* Victim, float Damage, const FVector& ShotDirection, const FHitResult& HitInfo, TSubclassOf<UDamageType> DamageType, AController* InstigatedBy, AActor* DamageCauser)
+{
+	FSDamageRecord* Record = AddRecord(Victim, Damage, DamageType, InstigatedBy, DamageCauser);
+	if (Record)
+	{
+		Record->Kind = ESDamageKind::Point;
+		Record->HitInfo = HitInfo;
+		Record->ShotDirection = ShotDirection;
+	}
+}
+
+
+void USDamageQueueComponent::QueueRadialDamage(const FVector& Origin, float Radius, float Damage, TSubclassOf<UDamageType> DamageType, const TArray<AActor*>& IgnoreActors, AController* InstigatedBy, AActor* DamageCauser)
+{
+	FCollisionQueryParams SphereParams(SCENE_QUERY_STAT(QueueRadialDamage), false, DamageCauser);
+	SphereParams.AddIgnoredActors(IgnoreActors);
+
+	TArray<FOverlapResult> Overlaps;
+	GetWorld()->OverlapMultiByObjectType(Overlaps, Origin, FQuat::Identity, FCollisionObjectQueryParams(FCollisionObjectQueryParams::InitType::AllDynamicObjects), FCollisionShape::MakeSphere(Radius), SphereParams);
+
+	TArray<AActor*, TInlineAllocator<16>> Victims;
+	for (const FOverlapResult& Overlap : Overlaps)
+	{
+		AActor* OverlapActor = Overlap.GetActor();
+		if (OverlapActor == nullptr || Victims.Contains(OverlapActor))
+		{
+			continue;
+		}
+
+		// Same visibility rule as ApplyRadialDamage, walls block the blast
+		FCollisionQueryParams LineParams(SCENE_QUERY_STAT(QueueRadialDamageLOS), true, DamageCauser);
+		LineParams.AddIgnoredActors(IgnoreActors);
+
+		FHitResult Hit;
+		const FVector TargetLocation = Overlap.Component.IsValid() ? Overlap.Component->Bounds.Origin : OverlapActor->GetActorLocation();
+		if (GetWorld()->LineTraceSingleByChannel(Hit, Origin, TargetLocation, ECC_Visibility, LineParams))
+		{
+			if (Hit.GetActor() != OverlapActor)
+			{
+				continue;
+			}
+		}
+		else
+		{
+			// Nothing in the way, the engine fakes a hit on the component's centre the same way
+			Hit = FHitResult(OverlapActor, Overlap.Component.Get(), TargetLocation, (TargetLocation - Origin).GetSafeNormal());
+		}
+
+		Victims.Add(OverlapActor);
+
+		FSDamageRecord* Record = AddRecord(OverlapActor, Damage, DamageType, InstigatedBy, DamageCauser);
+		if (Record)
+		{
+			Record->Kind = ESDamageKind::Radial;
+			Record->HitInfo = Hit;
+			Record->Origin = Origin;
+			Record->Radius = Radius;
+		}
+	}
+}
+
+
+void USDamageQueueComponent::ResolveDamage()
+{
+	SCOPE_CYCLE_COUNTER(STAT_DamageResolve);
+
+	Swap(PendingDamage, ResolvingDamage);
+
+	INC_DWORD_STAT_BY(STAT_DamageHits, ResolvingDamage.Num());
+	TotalHitsResolved += ResolvingDamage.Num();
+
+	USMatchRecorderComponent* Recorder = USMatchRecorderComponent::Get(this);
+
+	// Group hits per victim, stable so each victim still sees its hits in the order they happened
+	ResolvingDamage.StableSort([](const FSDamageRecord& A, const FSDamageRecord& B) { return A.Victim.Get(true) < B.Victim.Get(true); });
+
+	int32 GroupStart = 0;
+	while (GroupStart < ResolvingDamage.Num())
+	{
+		AActor* Victim = ResolvingDamage[GroupStart].Victim.Get(true);
+
+		int32 GroupEnd = GroupStart + 1;
+		while (GroupEnd < ResolvingDamage.Num() && ResolvingDamage[GroupEnd].Victim.Get(true) == Victim)
+		{
+			GroupEnd++;
+		}
+
+		// Same as the UGameplayStatics damage calls, actors that can't be damaged get no events either
+		if (Victim && !Victim->IsPendingKill() && Victim->CanBeDamaged())
+		{
+			INC_DWORD_STAT(STAT_DamageVictims);
+
+			if (Recorder)
+			{
+				for (int32 i = GroupStart; i < GroupEnd; i++)
+				{
+					Recorder->RecordDamage(Victim, ResolvingDamage[i].Damage);
+				}
+			}
+
+			// Every hit still goes through TakeDamage, the health component collects them and changes health once
+			USHealthComponent* HealthComp = Cast<USHealthComponent>(Victim->GetComponentByClass(USHealthComponent::StaticClass()));
+			if (HealthComp)
+			{
+				HealthComp->BeginDamageBatch();
+			}
+
+			for (int32 i = GroupStart; i < GroupEnd && !Victim->IsPendingKill(); i++)
+			{
+				TakeQueuedDamage(Victim, ResolvingDamage[i]);
+			}
+
+			if (HealthComp)
+			{
+				HealthComp->EndDamageBatch();
+			}
+		}
+
+		GroupStart = GroupEnd;
+	}
+
+	ResolvingDamage.Reset();
+}
+
+
+void USDamageQueueComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	if (PendingDamage.Num() > 0)
+	{
+		ResolveDamage();
+	}
+}
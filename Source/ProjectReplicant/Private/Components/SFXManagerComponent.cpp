@@ -0,0 +1,365 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "SFXManagerComponent.h"
+#include "SGameState.h"
+#include "CoopGame.h"
+#include "Particles/ParticleSystem.h"
+#include "Particles/ParticleSystemComponent.h"
+#include "Components/AudioComponent.h"
+#include "Sound/SoundBase.h"
+#include "Camera/PlayerCameraManager.h"
+#include "GameFramework/PlayerController.h"
+#include "Engine/World.h"
+
+static TAutoConsoleVariable<int32> CVarStripServerCosmetics(
+	TEXT("coop.StripServerCosmetics"),
+	1,
+	TEXT("Skip effects, sounds and camera shakes on dedicated servers.\n")
+	TEXT("0: play them anyway (for benchmarking), 1: strip them (default)"),
+	ECVF_Cheat);
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("FX Spawned"), STAT_FXSpawned, STATGROUP_CoopGame);
+DECLARE_DWORD_COUNTER_STAT(TEXT("FX Culled"), STAT_FXCulled, STATGROUP_CoopGame);
+DECLARE_DWORD_COUNTER_STAT(TEXT("FX Sounds Batched"), STAT_FXSoundsBatched, STATGROUP_CoopGame);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("FX Live Emitters"), STAT_FXLiveEmitters, STATGROUP_CoopGame);
+
+
+// Sets default values for this component's properties
+USFXManagerComponent::USFXManagerComponent()
+{
+	PrimaryComponentTick.bCanEverTick = true;
+
+	MaxEffectDistance = 8000.0f;
+	DetailDistance = 3000.0f;
+	OutOfViewDistance = 800.0f;
+	MaxSpawnsPerFrame = 24;
+	MaxEffectsPerArea = 12;
+	AreaCellSize = 1000.0f;
+	MaxParticleComponents = 96;
+	MaxAudioComponents = 32;
+	SoundBatchInterval = 0.05f;
+
+	NumAudioComponents = 0;
+	SpawnsThisFrame = 0;
+	ViewCosHalfFOV = 0.0f;
+	bHasView = false;
+}
+
+
+USFXManagerComponent* USFXManagerComponent::Get(const UObject* WorldContextObject)
+{
+	if (!ShouldPlayCosmetics(WorldContextObject))
+	{
+		return nullptr;
+	}
+
+	ASGameState* GS = WorldContextObject->GetWorld()->GetGameState<ASGameState>();
+
+	return GS ? GS->GetFXManager() : nullptr;
+}
+
+
+bool USFXManagerComponent::ShouldPlayCosmetics(const UObject* WorldContextObject)
+{
+#if WITH_COOP_COSMETICS
+	UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	if (World == nullptr)
+	{
+		return false;
+	}
+
+	return World->GetNetMode() != NM_DedicatedServer || CVarStripServerCosmetics.GetValueOnGameThread() == 0;
+#else
+	return false;
+#endif
+}
+
+
+void USFXManagerComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (!ShouldPlayCosmetics(this))
+	{
+		SetComponentTickEnabled(false);
+	}
+}
+
+
+void USFXManagerComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	SpawnsThisFrame = 0;
+
+	UpdateView();
+
+	// Forget batched sounds that can no longer suppress anything
+	const float Now = GetWorld()->TimeSeconds;
+	for (auto It = LastSoundPlayTimes.CreateIterator(); It; ++It)
+	{
+		if (Now - It.Value() > SoundBatchInterval)
+		{
+			It.RemoveCurrent();
+		}
+	}
+}
+
+
+void USFXManagerComponent::UpdateView()
+{
+	APlayerController* PC = GetWorld()->GetFirstPlayerController();
+	bHasView = PC && PC->PlayerCameraManager;
+	if (bHasView)
+	{
+		ViewLocation = PC->PlayerCameraManager->GetCameraLocation();
+		ViewDirection = PC->PlayerCameraManager->GetCameraRotation().Vector();
+
+		// Pad the FOV so effects at the screen edge don't pop
+		const float HalfFOV = FMath::Min(PC->PlayerCameraManager->GetFOVAngle() * 0.5f + 15.0f, 89.0f);
+		ViewCosHalfFOV = FMath::Cos(FMath::DegreesToRadians(HalfFOV));
+	}
+}
+
+
+bool USFXManagerComponent::ShouldSpawn(ESFXKind Kind, const FVector& Location, bool bLocallyOwned) const
+{
+	if (bLocallyOwned || !bHasView)
+	{
+		return true;
+	}
+
+	const FVector ToEffect = Location - ViewLocation;
+	const float DistSquared = ToEffect.SizeSquared();
+	if (DistSquared > FMath::Square(MaxEffectDistance))
+	{
+		return false;
+	}
+
+	if (DistSquared <= FMath::Square(OutOfViewDistance))
+	{
+		return true;
+	}
+
+	const bool bInView = FVector::DotProduct(ToEffect.GetSafeNormal(), ViewDirection) >= ViewCosHalfFOV;
+	if (!bInView)
+	{
+		return false;
+	}
+
+	// Far away only impacts survive, tracers and muzzle flashes are too small to read
+	return DistSquared <= FMath::Square(DetailDistance) || Kind == ESFXKind::Impact;
+}
+
+
+FIntVector USFXManagerComponent::GetAreaCell(const FVector& Location) const
+{
+	return FIntVector(FMath::FloorToInt(Location.X / AreaCellSize), FMath::FloorToInt(Location.Y / AreaCellSize), FMath::FloorToInt(Location.Z / AreaCellSize));
+}
+
+
+UParticleSystemComponent* USFXManagerComponent::AcquireParticleComponent(UParticleSystem* Template, const FVector& Location)
+{
+	if (SpawnsThisFrame >= MaxSpawnsPerFrame)
+	{
+		return nullptr;
+	}
+
+	const FIntVector Area = GetAreaCell(Location);
+	int32& AreaCount = ActiveEffectsPerArea.FindOrAdd(Area);
+	if (AreaCount >= MaxEffectsPerArea)
+	{
+		return nullptr;
+	}
+
+	UParticleSystemComponent* PSC = nullptr;
+	if (FreeParticles.Num() > 0)
+	{
+		PSC = FreeParticles.Pop(false);
+	}
+	else if (ActiveParticleAreas.Num() < MaxParticleComponents)
+	{
+		PSC = NewObject<UParticleSystemComponent>(GetOwner());
+		PSC->bAutoActivate = false;
+		PSC->bAutoDestroy = false;
+		PSC->SecondsBeforeInactive = 0.0f;
+		PSC->OnSystemFinished.AddDynamic(this, &USFXManagerComponent::OnParticleFinished);
+		PSC->RegisterComponent();
+	}
+
+	if (PSC == nullptr)
+	{
+		return nullptr;
+	}
+
+	AreaCount++;
+	SpawnsThisFrame++;
+	ActiveParticleAreas.Add(PSC, Area);
+
+	PSC->SetTemplate(Template);
+
+	INC_DWORD_STAT(STAT_FXSpawned);
+	INC_DWORD_STAT(STAT_FXLiveEmitters);
+
+	return PSC;
+}
+
+
+void USFXManagerComponent::OnParticleFinished(UParticleSystemComponent* PSystem)
+{
+	FIntVector Area;
+	if (!ActiveParticleAreas.RemoveAndCopyValue(PSystem, Area))
+	{
+		return;
+	}
+
+	int32* AreaCount = ActiveEffectsPerArea.Find(Area);
+	if (AreaCount && --(*AreaCount) <= 0)
+	{
+		ActiveEffectsPerArea.Remove(Area);
+	}
+
+	PSystem->DetachFromComponent(FDetachmentTransformRules::KeepWorldTransform);
+	FreeParticles.Add(PSystem);
+
+	DEC_DWORD_STAT(STAT_FXLiveEmitters);
+}
+
+
+UParticleSystemComponent* USFXManagerComponent::SpawnEmitterAtLocation(ESFXKind Kind, UParticleSystem* Template, const FVector& Location, const FRotator& Rotation)
+{
+	if (Template == nullptr)
+	{
+		return nullptr;
+	}
+
+	if (!ShouldSpawn(Kind, Location, false))
+	{
+		INC_DWORD_STAT(STAT_FXCulled);
+		return nullptr;
+	}
+
+	UParticleSystemComponent* PSC = AcquireParticleComponent(Template, Location);
+	if (PSC == nullptr)
+	{
+		INC_DWORD_STAT(STAT_FXCulled);
+		return nullptr;
+	}
+
+	PSC->SetWorldLocationAndRotation(Location, Rotation);
+	PSC->ActivateSystem(true);
+
+	return PSC;
+}
+
+
+UParticleSystemComponent* USFXManagerComponent::SpawnEmitterAttached(ESFXKind Kind, UParticleSystem* Template, USceneComponent* AttachToComponent, FName AttachPointName, bool bLocallyOwned)
+{
+	if (Template == nullptr || AttachToComponent == nullptr)
+	{
+		return nullptr;
+	}
+
+	const FVector Location = AttachToComponent->GetComponentLocation();
+	if (!ShouldSpawn(Kind, Location, bLocallyOwned))
+	{
+		INC_DWORD_STAT(STAT_FXCulled);
+		return nullptr;
+	}
+
+	UParticleSystemComponent* PSC = AcquireParticleComponent(Template, Location);
+	if (PSC == nullptr)
+	{
+		INC_DWORD_STAT(STAT_FXCulled);
+		return nullptr;
+	}
+
+	PSC->AttachToComponent(AttachToComponent, FAttachmentTransformRules::SnapToTargetNotIncludingScale, AttachPointName);
+	PSC->ActivateSystem(true);
+
+	return PSC;
+}
+
+
+void USFXManagerComponent::PlaySoundAtLocation(USoundBase* Sound, const FVector& Location)
+{
+	if (Sound == nullptr)
+	{
+		return;
+	}
+
+	if (bHasView && FVector::DistSquared(Location, ViewLocation) > FMath::Square(Sound->GetMaxDistance()))
+	{
+		INC_DWORD_STAT(STAT_FXCulled);
+		return;
+	}
+
+	// Collapse repeats of the same sound in the same area into one voice
+	const float Now = GetWorld()->TimeSeconds;
+	float& LastPlayTime = LastSoundPlayTimes.FindOrAdd(TPair<const USoundBase*, FIntVector>(Sound, GetAreaCell(Location)), -BIG_NUMBER);
+	if (Now - LastPlayTime < SoundBatchInterval)
+	{
+		INC_DWORD_STAT(STAT_FXSoundsBatched);
+		return;
+	}
+
+	UAudioComponent* AudioComp = nullptr;
+	if (FreeAudio.Num() > 0)
+	{
+		AudioComp = FreeAudio.Pop(false);
+	}
+	else if (NumAudioComponents < MaxAudioComponents)
+	{
+		AudioComp = NewObject<UAudioComponent>(GetOwner());
+		AudioComp->bAutoActivate = false;
+		AudioComp->bAutoDestroy = false;
+		AudioComp->bAllowSpatialization = true;
+		AudioComp->OnAudioFinishedNative.AddUObject(this, &USFXManagerComponent::OnAudioFinished);
+		AudioComp->RegisterComponent();
+		NumAudioComponents++;
+	}
+
+	if (AudioComp == nullptr)
+	{
+		INC_DWORD_STAT(STAT_FXCulled);
+		return;
+	}
+
+	LastPlayTime = Now;
+
+	AudioComp->SetSound(Sound);
+	AudioComp->SetWorldLocation(Location);
+	AudioComp->Play();
+}
+
+
+void USFXManagerComponent::OnAudioFinished(UAudioComponent* AudioComp)
+{
+	FreeAudio.AddUnique(AudioComp);
+}
+
+
+void USFXManagerComponent::ResetForBenchmark()
+{
+	TArray<UParticleSystemComponent*> LiveParticles;
+	ActiveParticleAreas.GetKeys(LiveParticles);
+	for (UParticleSystemComponent* PSC : LiveParticles)
+	{
+		PSC->DeactivateImmediate();
+		// No-op if deactivating already reported the system finished
+		OnParticleFinished(PSC);
+	}
+
+	TInlineComponentArray<UAudioComponent*> AudioComps(GetOwner());
+	for (UAudioComponent* AudioComp : AudioComps)
+	{
+		if (AudioComp->OnAudioFinishedNative.IsBoundToObject(this))
+		{
+			AudioComp->Stop();
+			FreeAudio.AddUnique(AudioComp);
+		}
+	}
+
+	LastSoundPlayTimes.Reset();
+	SpawnsThisFrame = 0;
+}
@@ -0,0 +1,147 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "SFireSchedulerComponent.h"
+#include "SWeapon.h"
+#include "SGameState.h"
+#include "CoopGame.h"
+#include "Engine/World.h"
+
+DECLARE_CYCLE_STAT(TEXT("Fire Scheduler"), STAT_FireScheduler, STATGROUP_CoopGame);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Shots Fired"), STAT_ShotsFired, STATGROUP_CoopGame);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Shots Dropped"), STAT_ShotsDropped, STATGROUP_CoopGame);
+
+
+// Sets default values for this component's properties
+USFireSchedulerComponent::USFireSchedulerComponent()
+{
+	PrimaryComponentTick.bCanEverTick = true;
+	PrimaryComponentTick.TickGroup = TG_PrePhysics;
+
+	MaxShotsPerWeaponPerFrame = 8;
+}
+
+
+USFireSchedulerComponent* USFireSchedulerComponent::Get(const UObject* WorldContextObject)
+{
+	UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	ASGameState* GS = World ? World->GetGameState<ASGameState>() : nullptr;
+
+	return GS ? GS->GetFireScheduler() : nullptr;
+}
+
+
+int32 USFireSchedulerComponent::FindSchedule(const ASWeapon* Weapon) const
+{
+	return Schedules.IndexOfByPredicate([Weapon](const FSFireSchedule& Schedule) { return Schedule.Weapon.Get() == Weapon; });
+}
+
+
+void USFireSchedulerComponent::StartFiring(ASWeapon* Weapon, float FirstShotTime, float Interval)
+{
+	if (Weapon == nullptr || Interval <= 0.0f)
+	{
+		return;
+	}
+
+	const float Now = GetWorld()->TimeSeconds;
+
+	int32 Index = FindSchedule(Weapon);
+	if (Index == INDEX_NONE)
+	{
+		Index = Schedules.AddDefaulted();
+	}
+
+	FSFireSchedule& Schedule = Schedules[Index];
+	Schedule.Weapon = Weapon;
+	Schedule.Interval = Interval;
+	Schedule.NextShotTime = FMath::Max(FirstShotTime, Now);
+
+	// The press itself shoots without waiting for the next tick
+	if (Schedule.NextShotTime <= Now)
+	{
+		Schedule.NextShotTime += Interval;
+
+		INC_DWORD_STAT(STAT_ShotsFired);
+		Weapon->Fire(Now);
+		Weapon->CacheShotViewPoint();
+	}
+}
+
+
+void USFireSchedulerComponent::StopFiring(ASWeapon* Weapon)
+{
+	const int32 Index = FindSchedule(Weapon);
+	if (Index != INDEX_NONE)
+	{
+		Schedules.RemoveAtSwap(Index, 1, false);
+	}
+}
+
+
+bool USFireSchedulerComponent::IsFiring(const ASWeapon* Weapon) const
+{
+	return FindSchedule(Weapon) != INDEX_NONE;
+}
+
+
+void USFireSchedulerComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	SCOPE_CYCLE_COUNTER(STAT_FireScheduler);
+
+	const float Now = GetWorld()->TimeSeconds;
+
+	ShotBatch.Reset();
+	for (int32 i = Schedules.Num() - 1; i >= 0; i--)
+	{
+		FSFireSchedule& Schedule = Schedules[i];
+		ASWeapon* Weapon = Schedule.Weapon.Get();
+		if (Weapon == nullptr || Weapon->IsPendingKill())
+		{
+			Schedules.RemoveAtSwap(i, 1, false);
+			continue;
+		}
+
+		int32 NumShots = 0;
+		while (Schedule.NextShotTime <= Now && NumShots < MaxShotsPerWeaponPerFrame)
+		{
+			ShotBatch.Add({ Weapon, Schedule.NextShotTime });
+			Schedule.NextShotTime += Schedule.Interval;
+			NumShots++;
+		}
+
+		if (Schedule.NextShotTime <= Now)
+		{
+			const int32 Dropped = FMath::FloorToInt((Now - Schedule.NextShotTime) / Schedule.Interval) + 1;
+			Schedule.NextShotTime += Dropped * Schedule.Interval;
+			INC_DWORD_STAT_BY(STAT_ShotsDropped, Dropped);
+		}
+	}
+
+	if (ShotBatch.Num() > 0)
+	{
+		// Fire in the order the shots actually happened, not the order weapons started firing
+		ShotBatch.Sort([](const FSScheduledShot& A, const FSScheduledShot& B) { return A.ShotTime < B.ShotTime; });
+
+		for (const FSScheduledShot& Shot : ShotBatch)
+		{
+			// An earlier shot in the batch may have ended the weapon's owner
+			if (!Shot.Weapon->IsPendingKill())
+			{
+				Shot.Weapon->Fire(Shot.ShotTime);
+			}
+		}
+
+		INC_DWORD_STAT_BY(STAT_ShotsFired, ShotBatch.Num());
+	}
+
+	// Remember this frame's aim so next frame's shots can interpolate from it
+	for (const FSFireSchedule& Schedule : Schedules)
+	{
+		if (ASWeapon* Weapon = Schedule.Weapon.Get())
+		{
+			Weapon->CacheShotViewPoint();
+		}
+	}
+}
@@ -0,0 +1,416 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "SFlowFieldComponent.h"
+#include "SHealthComponent.h"
+#include "SLevelBakeData.h"
+#include "CoopGame.h"
+#include "NavigationSystem.h"
+#include "NavigationData.h"
+#include "GameFramework/Pawn.h"
+#include "GameFramework/PlayerController.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+
+DECLARE_CYCLE_STAT(TEXT("FlowField Update"), STAT_FlowFieldUpdate, STATGROUP_CoopGame);
+DECLARE_CYCLE_STAT(TEXT("FlowField Sample"), STAT_FlowFieldSample, STATGROUP_CoopGame);
+
+static const int32 NeighbourOffsetsX[8] = { 1, -1, 0, 0, 1, 1, -1, -1 };
+static const int32 NeighbourOffsetsY[8] = { 0, 0, 1, -1, 1, -1, 1, -1 };
+
+
+// Sets default values for this component's properties
+USFlowFieldComponent::USFlowFieldComponent()
+{
+	PrimaryComponentTick.bCanEverTick = true;
+
+	CellSize = 100.0f;
+	MaxCellsPerAxis = 256;
+	MaxStepHeight = 60.0f;
+	MaxCellsPerTick = 4096;
+
+	NumCellsX = 0;
+	NumCellsY = 0;
+}
+
+
+// Called when the game starts
+void USFlowFieldComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (GetOwnerRole() == ROLE_Authority)
+	{
+		BuildGrid();
+	}
+}
+
+
+void USFlowFieldComponent::BuildGrid()
+{
+	const double StartTime = FPlatformTime::Seconds();
+
+	// Prefer the grid baked into the level, sampling the navmesh at startup delays the first wave
+	FSFlowFieldGrid Grid;
+	bool bBaked = false;
+	for (TActorIterator<ASLevelBakeData> It(GetWorld()); It; ++It)
+	{
+		if (It->GetFlowFieldGrid().IsValid())
+		{
+			Grid = It->GetFlowFieldGrid();
+			bBaked = true;
+			break;
+		}
+	}
+
+	if (!bBaked && !BuildGridData(GetWorld(), CellSize, MaxCellsPerAxis, MaxStepHeight, Grid))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("No navigation data found, flow field disabled for %s"), *GetOwner()->GetName());
+		return;
+	}
+
+	CellSize = Grid.CellSize;
+	GridOrigin = Grid.Origin;
+	NumCellsX = Grid.NumCellsX;
+	NumCellsY = Grid.NumCellsY;
+	CellHeights = MoveTemp(Grid.CellHeights);
+
+	const int32 NumCells = NumCellsX * NumCellsY;
+	Walkable.Init(false, NumCells);
+
+	int32 NumWalkable = 0;
+	for (int32 Cell = 0; Cell < NumCells; Cell++)
+	{
+		if (Grid.Walkable[Cell] != 0)
+		{
+			Walkable[Cell] = true;
+			NumWalkable++;
+		}
+	}
+
+	UE_LOG(LogTemp, Log, TEXT("Flow field grid %s: %dx%d cells of %.0f units, %d walkable, %.1f ms"),
+		bBaked ? TEXT("loaded from level bake") : TEXT("built"), NumCellsX, NumCellsY, CellSize, NumWalkable, (FPlatformTime::Seconds() - StartTime) * 1000.0);
+}
+
+
+bool USFlowFieldComponent::BuildGridData(UWorld* World, float MinCellSize, int32 MaxCellsPerAxis, float MaxStepHeight, FSFlowFieldGrid& OutGrid)
+{
+	UNavigationSystemV1* NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(World);
+	ANavigationData* NavData = NavSys ? NavSys->GetDefaultNavDataInstance() : nullptr;
+	if (NavData == nullptr)
+	{
+		return false;
+	}
+
+	const FBox Bounds = NavData->GetBounds();
+	const FVector Size = Bounds.GetSize();
+
+	// Grow the cells on big maps rather than the grid
+	const float GridCellSize = FMath::Max(MinCellSize, FMath::Max(Size.X, Size.Y) / MaxCellsPerAxis);
+
+	OutGrid.Origin = Bounds.Min;
+	OutGrid.CellSize = GridCellSize;
+	OutGrid.NumCellsX = FMath::Max(1, FMath::CeilToInt(Size.X / GridCellSize));
+	OutGrid.NumCellsY = FMath::Max(1, FMath::CeilToInt(Size.Y / GridCellSize));
+
+	const int32 NumCells = OutGrid.NumCellsX * OutGrid.NumCellsY;
+	OutGrid.CellHeights.SetNumZeroed(NumCells);
+	OutGrid.Walkable.SetNumZeroed(NumCells);
+
+	const FVector ProjectExtent(GridCellSize * 0.5f, GridCellSize * 0.5f, Size.Z * 0.5f + MaxStepHeight);
+
+	for (int32 Cell = 0; Cell < NumCells; Cell++)
+	{
+		const int32 X = Cell % OutGrid.NumCellsX;
+		const int32 Y = Cell / OutGrid.NumCellsX;
+		const FVector CellCenter(OutGrid.Origin.X + (X + 0.5f) * GridCellSize, OutGrid.Origin.Y + (Y + 0.5f) * GridCellSize, Bounds.GetCenter().Z);
+
+		FNavLocation NavLocation;
+		if (NavSys->ProjectPointToNavigation(CellCenter, NavLocation, ProjectExtent, NavData))
+		{
+			OutGrid.Walkable[Cell] = 1;
+			OutGrid.CellHeights[Cell] = NavLocation.Location.Z;
+		}
+	}
+
+	return true;
+}
+
+
+void USFlowFieldComponent::RefreshTargets()
+{
+	ExtraTargets.RemoveAll([](const TWeakObjectPtr<APawn>& Target) { return !Target.IsValid(); });
+
+	// Drop fields of players that left or died
+	Layers.RemoveAll([this](const FSFlowFieldLayer& Layer)
+	{
+		APawn* Target = Layer.Target.Get();
+		return Target == nullptr || (!Target->IsPlayerControlled() && !ExtraTargets.Contains(Layer.Target));
+	});
+
+	TArray<APawn*, TInlineAllocator<8>> Targets;
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		APlayerController* PC = It->Get();
+		if (PC && PC->GetPawn())
+		{
+			Targets.Add(PC->GetPawn());
+		}
+	}
+
+	for (const TWeakObjectPtr<APawn>& Target : ExtraTargets)
+	{
+		Targets.Add(Target.Get());
+	}
+
+	for (APawn* MyPawn : Targets)
+	{
+		USHealthComponent* HealthComp = Cast<USHealthComponent>(MyPawn->GetComponentByClass(USHealthComponent::StaticClass()));
+		if (HealthComp && HealthComp->GetHealth() <= 0.0f)
+		{
+			continue;
+		}
+
+		if (FindLayer(MyPawn) == nullptr)
+		{
+			FSFlowFieldLayer& Layer = Layers.AddDefaulted_GetRef();
+			Layer.Target = MyPawn;
+		}
+	}
+}
+
+
+void USFlowFieldComponent::UpdateLayers(int32 CellBudget)
+{
+	const uint16 Unreached = MAX_uint16;
+
+	int32 NumBuilding = 0;
+	for (FSFlowFieldLayer& Layer : Layers)
+	{
+		// Only start a new build once the previous one is served, so a moving player can't starve the field
+		if (Layer.PendingGoalCell == INDEX_NONE)
+		{
+			const int32 TargetCell = WorldToCell(Layer.Target->GetActorLocation());
+			if (TargetCell != INDEX_NONE && Walkable[TargetCell] && TargetCell != Layer.GoalCell)
+			{
+				Layer.PendingGoalCell = TargetCell;
+				Layer.PendingIntegration.Init(Unreached, Walkable.Num());
+				Layer.PendingIntegration[TargetCell] = 0;
+				Layer.Frontier.Reset();
+				Layer.Frontier.Add(TargetCell);
+				Layer.FrontierHead = 0;
+			}
+		}
+
+		if (Layer.PendingGoalCell != INDEX_NONE)
+		{
+			NumBuilding++;
+		}
+	}
+
+	if (NumBuilding == 0)
+	{
+		return;
+	}
+
+	const int32 LayerBudget = FMath::Max(1, CellBudget / NumBuilding);
+
+	for (FSFlowFieldLayer& Layer : Layers)
+	{
+		if (Layer.PendingGoalCell == INDEX_NONE)
+		{
+			continue;
+		}
+
+		// Breadth first expansion over the 4-connected grid
+		int32 Expanded = 0;
+		while (Layer.FrontierHead < Layer.Frontier.Num() && Expanded < LayerBudget)
+		{
+			const int32 Cell = Layer.Frontier[Layer.FrontierHead++];
+			const uint16 NextCost = (uint16)FMath::Min<int32>(Layer.PendingIntegration[Cell] + 1, Unreached - 1);
+			const int32 CellX = Cell % NumCellsX;
+			const int32 CellY = Cell / NumCellsX;
+
+			for (int32 i = 0; i < 4; i++)
+			{
+				const int32 X = CellX + NeighbourOffsetsX[i];
+				const int32 Y = CellY + NeighbourOffsetsY[i];
+				if (X < 0 || Y < 0 || X >= NumCellsX || Y >= NumCellsY)
+				{
+					continue;
+				}
+
+				const int32 Neighbour = Y * NumCellsX + X;
+				if (Layer.PendingIntegration[Neighbour] == Unreached && AreCellsConnected(Cell, Neighbour))
+				{
+					Layer.PendingIntegration[Neighbour] = NextCost;
+					Layer.Frontier.Add(Neighbour);
+				}
+			}
+
+			Expanded++;
+		}
+
+		if (Layer.FrontierHead >= Layer.Frontier.Num())
+		{
+			// Build complete, start serving it
+			Swap(Layer.Integration, Layer.PendingIntegration);
+			Layer.GoalCell = Layer.PendingGoalCell;
+			Layer.PendingGoalCell = INDEX_NONE;
+			Layer.Frontier.Reset();
+			Layer.FrontierHead = 0;
+		}
+	}
+}
+
+
+bool USFlowFieldComponent::AreCellsConnected(int32 CellA, int32 CellB) const
+{
+	return Walkable[CellA] && Walkable[CellB] && FMath::Abs(CellHeights[CellA] - CellHeights[CellB]) <= MaxStepHeight;
+}
+
+
+int32 USFlowFieldComponent::WorldToCell(const FVector& Location) const
+{
+	const int32 X = FMath::FloorToInt((Location.X - GridOrigin.X) / CellSize);
+	const int32 Y = FMath::FloorToInt((Location.Y - GridOrigin.Y) / CellSize);
+	if (X < 0 || Y < 0 || X >= NumCellsX || Y >= NumCellsY)
+	{
+		return INDEX_NONE;
+	}
+
+	return Y * NumCellsX + X;
+}
+
+
+FVector USFlowFieldComponent::CellToWorld(int32 Cell) const
+{
+	const int32 X = Cell % NumCellsX;
+	const int32 Y = Cell / NumCellsX;
+
+	return FVector(GridOrigin.X + (X + 0.5f) * CellSize, GridOrigin.Y + (Y + 0.5f) * CellSize, CellHeights[Cell]);
+}
+
+
+const FSFlowFieldLayer* USFlowFieldComponent::FindLayer(const AActor* Target) const
+{
+	return Layers.FindByPredicate([Target](const FSFlowFieldLayer& Layer) { return Layer.Target.Get() == Target; });
+}
+
+
+void USFlowFieldComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	if (!IsGridReady())
+	{
+		return;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_FlowFieldUpdate);
+
+	RefreshTargets();
+	UpdateLayers(MaxCellsPerTick);
+}
+
+
+void USFlowFieldComponent::AddExtraTarget(APawn* Pawn)
+{
+	if (Pawn)
+	{
+		ExtraTargets.AddUnique(Pawn);
+	}
+}
+
+
+const TArray<TWeakObjectPtr<APawn>>& USFlowFieldComponent::GetExtraTargets() const
+{
+	return ExtraTargets;
+}
+
+
+bool USFlowFieldComponent::IsGridReady() const
+{
+	return Walkable.Num() > 0;
+}
+
+
+bool USFlowFieldComponent::GetGroundHeight(const FVector& Location, float& OutHeight) const
+{
+	const int32 Cell = WorldToCell(Location);
+	if (Cell == INDEX_NONE || !Walkable[Cell])
+	{
+		return false;
+	}
+
+	OutHeight = CellHeights[Cell];
+	return true;
+}
+
+
+bool USFlowFieldComponent::GetFlowDirection(const FVector& Location, const AActor* Target, FVector& OutDirection) const
+{
+	return Target && GetFlowDirection(Location, FindLayer(Target), Target->GetActorLocation(), OutDirection);
+}
+
+
+bool USFlowFieldComponent::GetFlowDirection(const FVector& Location, const FSFlowFieldLayer* Layer, const FVector& GoalLocation, FVector& OutDirection) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_FlowFieldSample);
+
+	if (Layer == nullptr || Layer->GoalCell == INDEX_NONE)
+	{
+		return false;
+	}
+
+	const int32 Cell = WorldToCell(Location);
+	if (Cell == INDEX_NONE || Layer->Integration[Cell] == MAX_uint16)
+	{
+		return false;
+	}
+
+	FVector Goal = GoalLocation;
+
+	if (Layer->Integration[Cell] > 0)
+	{
+		// Steer toward the cheapest neighbour, diagonals only when both sides are open so bots don't cut corners
+		const int32 CellX = Cell % NumCellsX;
+		const int32 CellY = Cell / NumCellsX;
+		int32 BestCell = INDEX_NONE;
+		uint16 BestCost = Layer->Integration[Cell];
+
+		for (int32 i = 0; i < 8; i++)
+		{
+			const int32 X = CellX + NeighbourOffsetsX[i];
+			const int32 Y = CellY + NeighbourOffsetsY[i];
+			if (X < 0 || Y < 0 || X >= NumCellsX || Y >= NumCellsY)
+			{
+				continue;
+			}
+
+			const int32 Neighbour = Y * NumCellsX + X;
+			if (Layer->Integration[Neighbour] >= BestCost || !AreCellsConnected(Cell, Neighbour))
+			{
+				continue;
+			}
+
+			if (i >= 4 && (!AreCellsConnected(Cell, CellY * NumCellsX + X) || !AreCellsConnected(Cell, Y * NumCellsX + CellX)))
+			{
+				continue;
+			}
+
+			BestCell = Neighbour;
+			BestCost = Layer->Integration[Neighbour];
+		}
+
+		if (BestCell == INDEX_NONE)
+		{
+			return false;
+		}
+
+		Goal = CellToWorld(BestCell);
+	}
+
+	OutDirection = (Goal - Location).GetSafeNormal2D();
+
+	return !OutDirection.IsZero();
+}
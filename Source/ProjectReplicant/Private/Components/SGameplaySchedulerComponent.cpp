@@ -0,0 +1,445 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "SGameplaySchedulerComponent.h"
+#include "SGameState.h"
+#include "CoopGame.h"
+#include "Engine/World.h"
+
+DECLARE_CYCLE_STAT(TEXT("Gameplay Scheduler"), STAT_GameplayScheduler, STATGROUP_CoopGame);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Scheduled Timers"), STAT_ScheduledTimers, STATGROUP_CoopGame);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Timers Fired"), STAT_TimersFired, STATGROUP_CoopGame);
+
+
+FSTimingWheel::FSTimingWheel()
+{
+	SlotHeads.Init(INDEX_NONE, Level0Slots + (NumLevels - 1) * LevelSlots);
+
+	CurrentTick = 0;
+	NextSerial = 1;
+	NumScheduled = 0;
+	NumFiredLastAdvance = 0;
+}
+
+
+void FSTimingWheel::Reset(double Now)
+{
+	Nodes.Reset();
+	FreeNodes.Reset();
+	DueBatch.Reset();
+
+	for (int32& Head : SlotHeads)
+	{
+		Head = INDEX_NONE;
+	}
+
+	CurrentTick = (int64)FMath::FloorToDouble(Now * (1 << TickBits));
+	NumScheduled = 0;
+	NumFiredLastAdvance = 0;
+}
+
+
+int64 FSTimingWheel::ToTick(double Seconds) const
+{
+	// Rounded up, a callback may run a fraction of a millisecond late but never early
+	return (int64)FMath::CeilToDouble(Seconds * (1 << TickBits));
+}
+
+
+int32 FSTimingWheel::AllocNode()
+{
+	int32 Index;
+	if (FreeNodes.Num() > 0)
+	{
+		Index = FreeNodes.Pop(false);
+	}
+	else
+	{
+		Index = Nodes.AddDefaulted();
+	}
+
+	FNode& Node = Nodes[Index];
+	Node.Serial = NextSerial++;
+
+	// Zero marks a free node
+	if (NextSerial == 0)
+	{
+		NextSerial = 1;
+	}
+
+	NumScheduled++;
+
+	return Index;
+}
+
+
+void FSTimingWheel::FreeNode(int32 Index)
+{
+	FNode& Node = Nodes[Index];
+	Node.Callback.Unbind();
+	Node.Serial = 0;
+	Node.Slot = INDEX_NONE;
+
+	FreeNodes.Add(Index);
+
+	NumScheduled--;
+}
+
+
+void FSTimingWheel::Link(int32 Index)
+{
+	// Ticks up to CurrentTick are done, CurrentTick + 1 is the next one run
+	const int64 Base = CurrentTick + 1;
+	const int64 MaxDelta = ((int64)1 << (Level0Bits + (NumLevels - 1) * LevelBits)) - 1;
+
+	FNode& Node = Nodes[Index];
+	Node.ExpireTick = FMath::Clamp(Node.ExpireTick, Base, Base + MaxDelta);
+
+	const int64 Delta = Node.ExpireTick - Base;
+
+	int32 Slot = (int32)(Node.ExpireTick & (Level0Slots - 1));
+	if (Delta >= Level0Slots)
+	{
+		for (int32 Level = 1; Level < NumLevels; Level++)
+		{
+			if (Delta < ((int64)1 << (Level0Bits + Level * LevelBits)) || Level == NumLevels - 1)
+			{
+				const int32 LevelSlot = (int32)((Node.ExpireTick >> (Level0Bits + (Level - 1) * LevelBits)) & (LevelSlots - 1));
+				Slot = Level0Slots + (Level - 1) * LevelSlots + LevelSlot;
+				break;
+			}
+		}
+	}
+
+	Node.Slot = Slot;
+	Node.Prev = INDEX_NONE;
+	Node.Next = SlotHeads[Slot];
+
+	if (Node.Next != INDEX_NONE)
+	{
+		Nodes[Node.Next].Prev = Index;
+	}
+
+	SlotHeads[Slot] = Index;
+}
+
+
+void FSTimingWheel::Unlink(int32 Index)
+{
+	FNode& Node = Nodes[Index];
+
+	if (Node.Prev != INDEX_NONE)
+	{
+		Nodes[Node.Prev].Next = Node.Next;
+	}
+	else
+	{
+		SlotHeads[Node.Slot] = Node.Next;
+	}
+
+	if (Node.Next != INDEX_NONE)
+	{
+		Nodes[Node.Next].Prev = Node.Prev;
+	}
+
+	Node.Prev = INDEX_NONE;
+	Node.Next = INDEX_NONE;
+	Node.Slot = INDEX_NONE;
+}
+
+
+void FSTimingWheel::Cascade(int32 Level, int32 LevelSlot)
+{
+	const int32 Slot = Level0Slots + (Level - 1) * LevelSlots + LevelSlot;
+
+	int32 Index = SlotHeads[Slot];
+	SlotHeads[Slot] = INDEX_NONE;
+
+	// Everything in the slot is now less than one turn of the finer levels away
+	while (Index != INDEX_NONE)
+	{
+		const int32 Next = Nodes[Index].Next;
+		Link(Index);
+		Index = Next;
+	}
+}
+
+
+bool FSTimingWheel::IsValidHandle(const FSScheduleHandle& Handle) const
+{
+	return Nodes.IsValidIndex(Handle.Index) && Handle.Serial != 0 && Nodes[Handle.Index].Serial == Handle.Serial;
+}
+
+
+void FSTimingWheel::Schedule(FSScheduleHandle& Handle, double Now, ESScheduleGroup Group, float Delay, FSimpleDelegate Callback, float Interval)
+{
+	int32 Index = Handle.Index;
+	if (IsValidHandle(Handle))
+	{
+		if (Nodes[Index].Slot != INDEX_NONE)
+		{
+			Unlink(Index);
+		}
+	}
+	else
+	{
+		Index = AllocNode();
+	}
+
+	FNode& Node = Nodes[Index];
+	Node.Callback = MoveTemp(Callback);
+	Node.Group = Group;
+	Node.ExpireTick = ToTick(Now + FMath::Max(Delay, 0.0f));
+	Node.IntervalTicks = Interval > 0.0f ? FMath::Max<int64>(FMath::RoundToInt(Interval * (1 << TickBits)), 1) : 0;
+
+	Link(Index);
+
+	Handle.Index = Index;
+	Handle.Serial = Node.Serial;
+}
+
+
+bool FSTimingWheel::Reschedule(const FSScheduleHandle& Handle, double Now, float Delay)
+{
+	if (!IsValidHandle(Handle))
+	{
+		return false;
+	}
+
+	if (Nodes[Handle.Index].Slot != INDEX_NONE)
+	{
+		Unlink(Handle.Index);
+	}
+
+	Nodes[Handle.Index].ExpireTick = ToTick(Now + FMath::Max(Delay, 0.0f));
+	Link(Handle.Index);
+
+	return true;
+}
+
+
+void FSTimingWheel::Cancel(FSScheduleHandle& Handle)
+{
+	if (IsValidHandle(Handle))
+	{
+		if (Nodes[Handle.Index].Slot != INDEX_NONE)
+		{
+			Unlink(Handle.Index);
+		}
+
+		FreeNode(Handle.Index);
+	}
+
+	Handle = FSScheduleHandle();
+}
+
+
+bool FSTimingWheel::IsScheduled(const FSScheduleHandle& Handle) const
+{
+	return IsValidHandle(Handle);
+}
+
+
+void FSTimingWheel::Advance(double Now)
+{
+	NumFiredLastAdvance = 0;
+
+	const int64 TargetTick = (int64)FMath::FloorToDouble(Now * (1 << TickBits));
+	if (NumScheduled == 0)
+	{
+		CurrentTick = FMath::Max(CurrentTick, TargetTick);
+		return;
+	}
+
+	while (CurrentTick < TargetTick)
+	{
+		CurrentTick++;
+
+		// Finest level wrapped, pull the next turn's worth down from the coarser levels, coarsest first
+		if ((CurrentTick & (Level0Slots - 1)) == 0)
+		{
+			int32 CascadeLevels = 1;
+			while (CascadeLevels < NumLevels - 1 && ((CurrentTick >> (Level0Bits + (CascadeLevels - 1) * LevelBits)) & (LevelSlots - 1)) == 0)
+			{
+				CascadeLevels++;
+			}
+
+			// Link is relative to the tick after CurrentTick, step back while cascading so this tick's nodes land in its slot
+			CurrentTick--;
+			for (int32 Level = CascadeLevels; Level >= 1; Level--)
+			{
+				Cascade(Level, (int32)(((CurrentTick + 1) >> (Level0Bits + (Level - 1) * LevelBits)) & (LevelSlots - 1)));
+			}
+			CurrentTick++;
+		}
+
+		const int32 Slot = (int32)(CurrentTick & (Level0Slots - 1));
+		int32 Index = SlotHeads[Slot];
+		SlotHeads[Slot] = INDEX_NONE;
+
+		while (Index != INDEX_NONE)
+		{
+			FNode& Node = Nodes[Index];
+			const int32 Next = Node.Next;
+
+			// Unlinked but still scheduled until it runs, so its handle stays valid for the callbacks before it
+			Node.Prev = INDEX_NONE;
+			Node.Next = INDEX_NONE;
+			Node.Slot = INDEX_NONE;
+
+			FDueNode& Due = DueBatch[DueBatch.AddUninitialized()];
+			Due.Index = Index;
+			Due.Serial = Node.Serial;
+			Due.ExpireTick = Node.ExpireTick;
+			Due.Group = Node.Group;
+
+			Index = Next;
+		}
+	}
+
+	if (DueBatch.Num() == 0)
+	{
+		return;
+	}
+
+	DueBatch.StableSort([](const FDueNode& A, const FDueNode& B)
+	{
+		return A.Group != B.Group ? A.Group < B.Group : A.ExpireTick < B.ExpireTick;
+	});
+
+	for (const FDueNode& Due : DueBatch)
+	{
+		FNode& Node = Nodes[Due.Index];
+
+		// Cancelled, or rescheduled by an earlier callback in the batch
+		if (Node.Serial != Due.Serial || Node.Slot != INDEX_NONE)
+		{
+			continue;
+		}
+
+		// Its object is gone
+		if (!Node.Callback.IsBound())
+		{
+			FreeNode(Due.Index);
+			continue;
+		}
+
+		NumFiredLastAdvance++;
+
+		// Callbacks may schedule, which can grow Nodes, so nothing refers into it past here
+		if (Node.IntervalTicks > 0)
+		{
+			FSimpleDelegate Callback = Node.Callback;
+			Node.ExpireTick += Node.IntervalTicks;
+			Link(Due.Index);
+			Callback.Execute();
+		}
+		else
+		{
+			FSimpleDelegate Callback = MoveTemp(Node.Callback);
+			FreeNode(Due.Index);
+			Callback.Execute();
+		}
+	}
+
+	DueBatch.Reset();
+}
+
+
+int32 FSTimingWheel::GetNumScheduled() const
+{
+	return NumScheduled;
+}
+
+
+int32 FSTimingWheel::GetNumFiredLastAdvance() const
+{
+	return NumFiredLastAdvance;
+}
+
+
+// Sets default values for this component's properties
+USGameplaySchedulerComponent::USGameplaySchedulerComponent()
+{
+	PrimaryComponentTick.bCanEverTick = true;
+	// Where world timers run, after physics and before the damage queue resolves
+	PrimaryComponentTick.TickGroup = TG_PostPhysics;
+
+	bWheelStarted = false;
+}
+
+
+USGameplaySchedulerComponent* USGameplaySchedulerComponent::Get(const UObject* WorldContextObject)
+{
+	UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	ASGameState* GS = World ? World->GetGameState<ASGameState>() : nullptr;
+
+	return GS ? GS->GetGameplayScheduler() : nullptr;
+}
+
+
+void USGameplaySchedulerComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (!bWheelStarted)
+	{
+		Wheel.Reset(GetNow());
+		bWheelStarted = true;
+	}
+}
+
+
+double USGameplaySchedulerComponent::GetNow() const
+{
+	return GetWorld()->GetTimeSeconds();
+}
+
+
+void USGameplaySchedulerComponent::Schedule(FSScheduleHandle& Handle, ESScheduleGroup Group, float Delay, FSimpleDelegate Callback, float Interval)
+{
+	// Other actors' BeginPlay may run before ours
+	if (!bWheelStarted)
+	{
+		Wheel.Reset(GetNow());
+		bWheelStarted = true;
+	}
+
+	Wheel.Schedule(Handle, GetNow(), Group, Delay, MoveTemp(Callback), Interval);
+}
+
+
+bool USGameplaySchedulerComponent::Reschedule(const FSScheduleHandle& Handle, float Delay)
+{
+	return Wheel.Reschedule(Handle, GetNow(), Delay);
+}
+
+
+void USGameplaySchedulerComponent::Cancel(FSScheduleHandle& Handle)
+{
+	Wheel.Cancel(Handle);
+}
+
+
+bool USGameplaySchedulerComponent::IsScheduled(const FSScheduleHandle& Handle) const
+{
+	return Wheel.IsScheduled(Handle);
+}
+
+
+int32 USGameplaySchedulerComponent::GetNumScheduled() const
+{
+	return Wheel.GetNumScheduled();
+}
+
+
+void USGameplaySchedulerComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	SCOPE_CYCLE_COUNTER(STAT_GameplayScheduler);
+
+	Wheel.Advance(GetNow());
+
+	SET_DWORD_STAT(STAT_ScheduledTimers, Wheel.GetNumScheduled());
+	INC_DWORD_STAT_BY(STAT_TimersFired, Wheel.GetNumFiredLastAdvance());
+}
@@ -2,7 +2,10 @@
 
 #include "SHealthComponent.h"
 #include "SGameMode.h"
+#include "SDamageQueueComponent.h"
+#include "SGameState.h"
 #include "Net/UnrealNetwork.h"
+#include "GameFramework/DamageType.h"
 #include <ProjectReplicant\Public\AProjectile.h>
 
 
@@ -11,6 +14,9 @@ USHealthComponent::USHealthComponent()
 {
 	DefaultHealth = 100;
 	bIsDead = false;
+	bBatchingDamage = false;
+	HealthResetCount = 0;
+	LastHealthResetCount = 0;
 
 	TeamNum = 255;
 
@@ -40,6 +46,13 @@ void USHealthComponent::BeginPlay()
 
 void USHealthComponent::OnRep_Health(float OldHealth)
 {
+	// Arrives with the health it reset, the difference is no damage
+	if (HealthResetCount != LastHealthResetCount)
+	{
+		LastHealthResetCount = HealthResetCount;
+		return;
+	}
+
 	float Damage = Health - OldHealth;
 
 	OnHealthChanged.Broadcast(this, Health, Damage, nullptr, nullptr, nullptr);
@@ -49,33 +62,113 @@ void USHealthComponent::OnRep_Health(float OldHealth)
 void USHealthComponent::HandleTakeAnyDamage(AActor* DamagedActor, float Damage, const class UDamageType* DamageType, class AController* InstigatedBy,
 	AActor* DamageCauser)
 {
-	if (Damage <= 0.0f || bIsDead)
+	// Damage from outside the damage queue (Blueprints, world damage) is applied as a batch of one
+	FSDamageRecord SingleHit;
+	FSDamageRecord& Hit = bBatchingDamage ? BatchedHits.AddDefaulted_GetRef() : SingleHit;
+	Hit.Victim = DamagedActor;
+	Hit.Damage = Damage;
+	Hit.DamageType = DamageType ? DamageType->GetClass() : nullptr;
+	Hit.InstigatedBy = InstigatedBy;
+	Hit.DamageCauser = DamageCauser;
+
+	if (!bBatchingDamage)
+	{
+		ApplyDamageBatch(TArrayView<const FSDamageRecord>(&SingleHit, 1));
+	}
+}
+
+
+void USHealthComponent::BeginDamageBatch()
+{
+	bBatchingDamage = true;
+	BatchedHits.Reset();
+}
+
+
+void USHealthComponent::EndDamageBatch()
+{
+	// Damage dealt in response to the batch is applied on its own
+	bBatchingDamage = false;
+
+	if (BatchedHits.Num() > 0)
+	{
+		ApplyDamageBatch(BatchedHits);
+		BatchedHits.Reset();
+	}
+}
+
+
+void USHealthComponent::ApplyDamageBatch(TArrayView<const FSDamageRecord> Hits)
+{
+	if (bIsDead)
 	{
 		return;
 	}
 
-	if (DamageCauser != DamagedActor && IsFriendly(DamagedActor, DamageCauser))
+	AActor* MyOwner = GetOwner();
+
+	ASGameState* GS = GetWorld()->GetGameState<ASGameState>();
+
+	float TotalDamage = 0.0f;
+	const FSDamageRecord* LastHit = nullptr;
+	const FSDamageRecord* KillingHit = nullptr;
+	for (const FSDamageRecord& Hit : Hits)
+	{
+		AActor* DamageCauser = Hit.DamageCauser.Get(true);
+		if (Hit.Damage <= 0.0f)
+		{
+			continue;
+		}
+
+		if (DamageCauser != MyOwner && IsFriendly(MyOwner, DamageCauser))
+		{
+			continue;
+		}
+
+		// Only the part of the hit that took health counts toward the scoreboard
+		if (GS)
+		{
+			GS->RecordDamage(Hit.InstigatedBy.Get(), FMath::Clamp(Health - TotalDamage, 0.0f, Hit.Damage));
+		}
+
+		TotalDamage += Hit.Damage;
+		LastHit = &Hit;
+
+		if (KillingHit == nullptr && Health - TotalDamage <= 0.0f)
+		{
+			KillingHit = &Hit;
+		}
+	}
+
+	if (LastHit == nullptr)
 	{
 		return;
 	}
 
 	// Update health clamped
-	Health = FMath::Clamp(Health - Damage, 0.0f, DefaultHealth);
+	Health = FMath::Clamp(Health - TotalDamage, 0.0f, DefaultHealth);
 
-	UE_LOG(LogTemp, Log, TEXT("Health Changed: %s"), *FString::SanitizeFloat(Health));
+	UE_LOG(LogTemp, Log, TEXT("Health Changed: %s (%d hits)"), *FString::SanitizeFloat(Health), Hits.Num());
 
 	bIsDead = Health <= 0.0f;
 
-	OnHealthChanged.Broadcast(this, Health, Damage, DamageType, InstigatedBy, DamageCauser);
+	// Kill credit goes to the hit that actually finished the owner, not whichever landed last
+	const FSDamageRecord& CreditedHit = KillingHit ? *KillingHit : *LastHit;
+	AController* InstigatedBy = CreditedHit.InstigatedBy.Get();
+	AActor* DamageCauser = CreditedHit.DamageCauser.Get(true);
+	const UDamageType* DamageType = CreditedHit.DamageType ? CreditedHit.DamageType->GetDefaultObject<UDamageType>() : GetDefault<UDamageType>();
 
+	// Kill first, dying characters detach from their controller on health change and the victim's player state goes with it
 	if (bIsDead)
 	{
 		ASGameMode* GM = Cast<ASGameMode>(GetWorld()->GetAuthGameMode());
 		if (GM)
 		{
-			GM->OnActorKilled.Broadcast(GetOwner(), DamageCauser, InstigatedBy);
+			GM->OnActorKilled.Broadcast(MyOwner, DamageCauser, InstigatedBy);
 		}
 	}
+
+	OnHealthChanged.Broadcast(this, Health, TotalDamage, DamageType, InstigatedBy, DamageCauser);
 }
 
 
@@ -115,6 +208,11 @@ bool USHealthComponent::IsFriendly(AActor* ActorA, AActor* ActorB)
 		else
 		{
 			USHealthComponent* HealthCompA = Cast<USHealthComponent>(ActorA->GetComponentByClass(USHealthComponent::StaticClass()));
+			if (HealthCompA == nullptr)
+			{
+				// Assume friendly
+				return true;
+			}
 			actorATeam = HealthCompA->TeamNum;
 		}
 		if (ActorB->IsA<AProjectile>())
@@ -125,6 +223,11 @@ bool USHealthComponent::IsFriendly(AActor* ActorA, AActor* ActorB)
 		else
 		{
 			USHealthComponent* HealthCompB = Cast<USHealthComponent>(ActorB->GetComponentByClass(USHealthComponent::StaticClass()));
+			if (HealthCompB == nullptr)
+			{
+				// Assume friendly
+				return true;
+			}
 			actorBTeam = HealthCompB->TeamNum;
 		}
 
@@ -150,9 +253,30 @@ float USHealthComponent::GetHealth() const
 }
 
 
+float USHealthComponent::GetDefaultHealth() const
+{
+	return DefaultHealth;
+}
+
+
+void USHealthComponent::SetHealth(float NewHealth)
+{
+	const float ResetHealth = FMath::Clamp(NewHealth, 0.0f, DefaultHealth);
+	if (ResetHealth != Health)
+	{
+		// Only bumped alongside a health change, so OnRep_Health is there to see it
+		Health = ResetHealth;
+		HealthResetCount++;
+	}
+
+	bIsDead = Health <= 0.0f;
+}
+
+
 void USHealthComponent::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
 {
 	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
 
 	DOREPLIFETIME(USHealthComponent, Health);
+	DOREPLIFETIME(USHealthComponent, HealthResetCount);
 }
\ No newline at end of file
@@ -0,0 +1,411 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "SHitboxRigComponent.h"
+#include "CoopGame.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "Components/CapsuleComponent.h"
+#include "GameFramework/Character.h"
+#include "Engine/SkeletalMesh.h"
+#include "PhysicsEngine/PhysicsAsset.h"
+#include "PhysicsEngine/SkeletalBodySetup.h"
+#include "PhysicalMaterials/PhysicalMaterial.h"
+
+DECLARE_CYCLE_STAT(TEXT("Hitbox Trace"), STAT_HitboxTrace, STATGROUP_CoopGame);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Hitbox Pose Samples"), STAT_HitboxPoseSamples, STATGROUP_CoopGame);
+
+
+namespace SHitboxRig
+{
+	bool SegmentBox(const FVector& S, const FVector& E, const FVector& Extent, float& OutT, FVector& OutNormal)
+	{
+		const FVector D = E - S;
+		float TMin = 0.0f;
+		float TMax = 1.0f;
+		int32 EntryAxis = INDEX_NONE;
+		float EntrySign = 0.0f;
+
+		for (int32 Axis = 0; Axis < 3; Axis++)
+		{
+			if (FMath::Abs(D[Axis]) < KINDA_SMALL_NUMBER)
+			{
+				if (FMath::Abs(S[Axis]) > Extent[Axis])
+				{
+					return false;
+				}
+				continue;
+			}
+
+			const float InvD = 1.0f / D[Axis];
+			float T0 = (-Extent[Axis] - S[Axis]) * InvD;
+			float T1 = (Extent[Axis] - S[Axis]) * InvD;
+			float Sign = -1.0f;
+			if (T0 > T1)
+			{
+				Swap(T0, T1);
+				Sign = 1.0f;
+			}
+
+			if (T0 > TMin)
+			{
+				TMin = T0;
+				EntryAxis = Axis;
+				EntrySign = Sign;
+			}
+			TMax = FMath::Min(TMax, T1);
+
+			if (TMin > TMax)
+			{
+				return false;
+			}
+		}
+
+		OutT = TMin;
+		OutNormal = FVector::ZeroVector;
+		if (EntryAxis != INDEX_NONE)
+		{
+			OutNormal[EntryAxis] = EntrySign;
+		}
+		else
+		{
+			// Started inside
+			OutNormal = -D.GetSafeNormal();
+		}
+
+		return true;
+	}
+
+	bool SegmentSphere(const FVector& S, const FVector& E, const FVector& Center, float Radius, float& OutT, FVector& OutNormal)
+	{
+		const FVector D = E - S;
+		const FVector M = S - Center;
+		const float C = M.SizeSquared() - Radius * Radius;
+
+		if (C <= 0.0f)
+		{
+			OutT = 0.0f;
+			OutNormal = -D.GetSafeNormal();
+			return true;
+		}
+
+		const float A = D.SizeSquared();
+		const float B = FVector::DotProduct(M, D);
+		const float Disc = B * B - A * C;
+		if (A < KINDA_SMALL_NUMBER || B > 0.0f || Disc < 0.0f)
+		{
+			return false;
+		}
+
+		const float T = (-B - FMath::Sqrt(Disc)) / A;
+		if (T < 0.0f || T > 1.0f)
+		{
+			return false;
+		}
+
+		OutT = T;
+		OutNormal = (M + D * T) / Radius;
+		return true;
+	}
+
+	bool SegmentCapsule(const FVector& S, const FVector& E, float Radius, float HalfLength, float& OutT, FVector& OutNormal)
+	{
+		const FVector D = E - S;
+		bool bHit = false;
+		OutT = BIG_NUMBER;
+
+		// Cylinder wall
+		const float A = D.X * D.X + D.Y * D.Y;
+		if (A > KINDA_SMALL_NUMBER)
+		{
+			const float B = S.X * D.X + S.Y * D.Y;
+			const float C = S.X * S.X + S.Y * S.Y - Radius * Radius;
+			const float Disc = B * B - A * C;
+			if (Disc >= 0.0f)
+			{
+				const float T = (-B - FMath::Sqrt(Disc)) / A;
+				const float Z = S.Z + D.Z * T;
+				if (T >= 0.0f && T <= 1.0f && FMath::Abs(Z) <= HalfLength)
+				{
+					const FVector P = S + D * T;
+					OutT = T;
+					OutNormal = FVector(P.X, P.Y, 0.0f) / Radius;
+					bHit = true;
+				}
+			}
+		}
+
+		// End caps
+		for (float CapZ : { -HalfLength, HalfLength })
+		{
+			float T;
+			FVector Normal;
+			if (SegmentSphere(S, E, FVector(0.0f, 0.0f, CapZ), Radius, T, Normal) && T < OutT)
+			{
+				OutT = T;
+				OutNormal = Normal;
+				bHit = true;
+			}
+		}
+
+		return bHit;
+	}
+}
+
+
+// Sets default values for this component's properties
+USHitboxRigComponent::USHitboxRigComponent()
+{
+	PoseSampleRate = 10.0f;
+	bApproximateCrouch = true;
+	AimBone = "spine_02";
+	MaxAimYaw = 90.0f;
+
+	AimBoneIndex = INDEX_NONE;
+	bUseReferencePose = false;
+	LastPoseSampleTime = -BIG_NUMBER;
+	StandingHalfHeight = 0.0f;
+}
+
+
+void USHitboxRigComponent::BuildFromMesh(USkeletalMeshComponent* InMesh, const TMap<FName, ESHitZone>& ZoneBones)
+{
+	Hitboxes.Reset();
+	ReferencePose.Reset();
+	Mesh = InMesh;
+
+	UPhysicsAsset* PhysicsAsset = InMesh ? InMesh->GetPhysicsAsset() : nullptr;
+	if (PhysicsAsset == nullptr || InMesh->SkeletalMesh == nullptr)
+	{
+		return;
+	}
+
+	const FReferenceSkeleton& RefSkeleton = InMesh->SkeletalMesh->RefSkeleton;
+	const TArray<FTransform>& RefBonePose = RefSkeleton.GetRefBonePose();
+
+	// Parents always come before their children
+	ReferencePose.SetNum(RefBonePose.Num());
+	for (int32 BoneIndex = 0; BoneIndex < RefBonePose.Num(); BoneIndex++)
+	{
+		FTransform LocalTransform = RefBonePose[BoneIndex];
+		const FRotator* PoseRotation = PoseBoneRotations.Find(RefSkeleton.GetBoneName(BoneIndex));
+		if (PoseRotation)
+		{
+			LocalTransform.SetRotation(LocalTransform.GetRotation() * PoseRotation->Quaternion());
+		}
+
+		const int32 ParentIndex = RefSkeleton.GetParentIndex(BoneIndex);
+		ReferencePose[BoneIndex] = ParentIndex == INDEX_NONE ? LocalTransform : LocalTransform * ReferencePose[ParentIndex];
+	}
+
+	AimBoneIndex = AimBone.IsNone() ? INDEX_NONE : RefSkeleton.FindBoneIndex(AimBone);
+
+	for (USkeletalBodySetup* Body : PhysicsAsset->SkeletalBodySetups)
+	{
+		const int32 BoneIndex = Body ? RefSkeleton.FindBoneIndex(Body->BoneName) : INDEX_NONE;
+		if (BoneIndex == INDEX_NONE)
+		{
+			continue;
+		}
+
+		ESHitZone Zone = ESHitZone::Body;
+		const ESHitZone* BoneZone = ZoneBones.Find(Body->BoneName);
+		if (BoneZone)
+		{
+			Zone = *BoneZone;
+		}
+		else if (UPhysicalMaterial::DetermineSurfaceType(Body->PhysMaterial) == SURFACE_FLESHVULNERABLE)
+		{
+			Zone = ESHitZone::Head;
+		}
+
+		FSHitbox Hitbox;
+		Hitbox.BoneName = Body->BoneName;
+		Hitbox.BoneIndex = BoneIndex;
+		Hitbox.Zone = Zone;
+		Hitbox.PhysMaterial = Body->PhysMaterial;
+		Hitbox.HalfLength = 0.0f;
+
+		Hitbox.bFollowsAim = false;
+		for (int32 ChainIndex = BoneIndex; ChainIndex != INDEX_NONE && AimBoneIndex != INDEX_NONE; ChainIndex = RefSkeleton.GetParentIndex(ChainIndex))
+		{
+			if (ChainIndex == AimBoneIndex)
+			{
+				Hitbox.bFollowsAim = true;
+				break;
+			}
+		}
+
+		const FKAggregateGeom& Geom = Body->AggGeom;
+		for (const FKSphylElem& Sphyl : Geom.SphylElems)
+		{
+			Hitbox.Shape = ESHitboxShape::Capsule;
+			Hitbox.BoneLocalTransform = FTransform(Sphyl.Rotation, Sphyl.Center);
+			Hitbox.Extent = FVector(Sphyl.Radius);
+			Hitbox.HalfLength = Sphyl.Length * 0.5f;
+			Hitboxes.Add(Hitbox);
+		}
+
+		for (const FKBoxElem& Box : Geom.BoxElems)
+		{
+			Hitbox.Shape = ESHitboxShape::Box;
+			Hitbox.BoneLocalTransform = FTransform(Box.Rotation, Box.Center);
+			Hitbox.Extent = FVector(Box.X, Box.Y, Box.Z) * 0.5f;
+			Hitboxes.Add(Hitbox);
+		}
+
+		for (const FKSphereElem& Sphere : Geom.SphereElems)
+		{
+			Hitbox.Shape = ESHitboxShape::Sphere;
+			Hitbox.BoneLocalTransform = FTransform(Sphere.Center);
+			Hitbox.Extent = FVector(Sphere.Radius);
+			Hitboxes.Add(Hitbox);
+		}
+	}
+
+	ACharacter* Character = Cast<ACharacter>(GetOwner());
+	StandingHalfHeight = Character ? Character->GetDefaultHalfHeight() : 0.0f;
+
+	// A dedicated server doesn't evaluate the mesh's pose, see OnlyTickMontagesWhenNotRendered in ASCharacter
+	bUseReferencePose = IsRunningDedicatedServer();
+	LastPoseSampleTime = -BIG_NUMBER;
+}
+
+
+bool USHitboxRigComponent::HasHitboxes() const
+{
+	return Hitboxes.Num() > 0 && Mesh.IsValid();
+}
+
+
+void USHitboxRigComponent::SamplePose()
+{
+	INC_DWORD_STAT(STAT_HitboxPoseSamples);
+
+	USkeletalMeshComponent* MeshComp = Mesh.Get();
+	const TArray<FTransform>& MeshPose = MeshComp->GetComponentSpaceTransforms();
+	const bool bSampleMesh = !bUseReferencePose && MeshPose.Num() == ReferencePose.Num();
+	const TArray<FTransform>& Pose = bSampleMesh ? MeshPose : ReferencePose;
+
+	float HeightScale = 1.0f;
+	ACharacter* Character = Cast<ACharacter>(GetOwner());
+	if (!bSampleMesh && bApproximateCrouch && Character && StandingHalfHeight > 0.0f)
+	{
+		HeightScale = Character->GetCapsuleComponent()->GetUnscaledCapsuleHalfHeight() / StandingHalfHeight;
+	}
+
+	// Aim pitch and yaw about the actor's axes, moved into component space and pivoting on the aim bone
+	FQuat AimRotation = FQuat::Identity;
+	FVector AimPivot = FVector::ZeroVector;
+	APawn* Pawn = Cast<APawn>(GetOwner());
+	if (!bSampleMesh && Pawn && AimBoneIndex != INDEX_NONE)
+	{
+		const FRotator AimOffset = (Pawn->GetBaseAimRotation() - Pawn->GetActorRotation()).GetNormalized();
+		const FRotator ClampedOffset(FMath::Clamp(AimOffset.Pitch, -90.0f, 90.0f), FMath::Clamp(AimOffset.Yaw, -MaxAimYaw, MaxAimYaw), 0.0f);
+
+		const FQuat ActorQuat = Pawn->GetActorQuat();
+		const FQuat ComponentQuat = MeshComp->GetComponentQuat();
+		AimRotation = ComponentQuat.Inverse() * ActorQuat * ClampedOffset.Quaternion() * ActorQuat.Inverse() * ComponentQuat;
+		AimPivot = Pose[AimBoneIndex].GetLocation();
+	}
+
+	for (FSHitbox& Hitbox : Hitboxes)
+	{
+		Hitbox.ComponentTransform = Hitbox.BoneLocalTransform * Pose[Hitbox.BoneIndex];
+
+		if (Hitbox.bFollowsAim && !AimRotation.Equals(FQuat::Identity))
+		{
+			Hitbox.ComponentTransform.SetLocation(AimPivot + AimRotation.RotateVector(Hitbox.ComponentTransform.GetLocation() - AimPivot));
+			Hitbox.ComponentTransform.SetRotation(AimRotation * Hitbox.ComponentTransform.GetRotation());
+		}
+
+		if (HeightScale < 1.0f)
+		{
+			FVector Location = Hitbox.ComponentTransform.GetLocation();
+			Location.Z *= HeightScale;
+			Hitbox.ComponentTransform.SetLocation(Location);
+		}
+	}
+}
+
+
+bool USHitboxRigComponent::LineTrace(const FVector& TraceStart, const FVector& TraceEnd, FHitResult& OutHit, ESHitZone& OutZone)
+{
+	SCOPE_CYCLE_COUNTER(STAT_HitboxTrace);
+
+	if (!HasHitboxes())
+	{
+		return false;
+	}
+
+	USkeletalMeshComponent* MeshComp = Mesh.Get();
+
+	// Crouching and aiming change the approximation, so the reference pose is resampled at the same rate
+	const float Now = GetWorld()->TimeSeconds;
+	if (Now - LastPoseSampleTime >= 1.0f / PoseSampleRate)
+	{
+		SamplePose();
+		LastPoseSampleTime = Now;
+	}
+
+	const FTransform& ComponentToWorld = MeshComp->GetComponentTransform();
+
+	const FSHitbox* ClosestHitbox = nullptr;
+	float ClosestT = BIG_NUMBER;
+	FVector ClosestNormal = FVector::ZeroVector;
+	FTransform ClosestTransform;
+
+	for (const FSHitbox& Hitbox : Hitboxes)
+	{
+		// Shapes are tested unscaled, a uniform scale is folded into their size
+		FTransform HitboxToWorld = Hitbox.ComponentTransform * ComponentToWorld;
+		const float Scale = HitboxToWorld.GetMaximumAxisScale();
+		HitboxToWorld.SetScale3D(FVector::OneVector);
+
+		const FVector LocalStart = HitboxToWorld.InverseTransformPositionNoScale(TraceStart) / Scale;
+		const FVector LocalEnd = HitboxToWorld.InverseTransformPositionNoScale(TraceEnd) / Scale;
+
+		float T = 0.0f;
+		FVector Normal = FVector::ZeroVector;
+		bool bHit = false;
+		switch (Hitbox.Shape)
+		{
+		case ESHitboxShape::Sphere:
+			bHit = SHitboxRig::SegmentSphere(LocalStart, LocalEnd, FVector::ZeroVector, Hitbox.Extent.X, T, Normal);
+			break;
+		case ESHitboxShape::Capsule:
+			bHit = SHitboxRig::SegmentCapsule(LocalStart, LocalEnd, Hitbox.Extent.X, Hitbox.HalfLength, T, Normal);
+			break;
+		case ESHitboxShape::Box:
+			bHit = SHitboxRig::SegmentBox(LocalStart, LocalEnd, Hitbox.Extent, T, Normal);
+			break;
+		}
+
+		if (bHit && T < ClosestT)
+		{
+			ClosestHitbox = &Hitbox;
+			ClosestT = T;
+			ClosestNormal = Normal;
+			ClosestTransform = HitboxToWorld;
+		}
+	}
+
+	if (ClosestHitbox == nullptr)
+	{
+		return false;
+	}
+
+	const FVector ImpactPoint = FMath::Lerp(TraceStart, TraceEnd, ClosestT);
+	const FVector ImpactNormal = ClosestTransform.TransformVectorNoScale(ClosestNormal).GetSafeNormal();
+
+	OutHit = FHitResult(MeshComp->GetOwner(), MeshComp, ImpactPoint, ImpactNormal);
+	OutHit.bBlockingHit = true;
+	OutHit.Time = ClosestT;
+	OutHit.Distance = FVector::Dist(TraceStart, ImpactPoint);
+	OutHit.TraceStart = TraceStart;
+	OutHit.TraceEnd = TraceEnd;
+	OutHit.BoneName = ClosestHitbox->BoneName;
+	OutHit.PhysMaterial = ClosestHitbox->PhysMaterial;
+
+	OutZone = ClosestHitbox->Zone;
+
+	return true;
+}
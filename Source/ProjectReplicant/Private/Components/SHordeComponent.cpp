@@ -0,0 +1,379 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "SHordeComponent.h"
+#include "SFlowFieldComponent.h"
+#include "SHealthComponent.h"
+#include "SCharacter.h"
+#include "SGameMode.h"
+#include "CoopGame.h"
+#include "Components/CapsuleComponent.h"
+#include "GameFramework/PlayerController.h"
+#include "Engine/World.h"
+#include "Async/ParallelFor.h"
+
+DECLARE_CYCLE_STAT(TEXT("Horde Update"), STAT_HordeUpdate, STATGROUP_CoopGame);
+DECLARE_CYCLE_STAT(TEXT("Horde Parallel Update"), STAT_HordeParallelUpdate, STATGROUP_CoopGame);
+DECLARE_CYCLE_STAT(TEXT("Horde Apply"), STAT_HordeApply, STATGROUP_CoopGame);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Horde Actions"), STAT_HordeActions, STATGROUP_CoopGame);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Horde Agents"), STAT_HordeAgents, STATGROUP_CoopGame);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Horde Promoted"), STAT_HordePromoted, STATGROUP_CoopGame);
+
+static TAutoConsoleVariable<int32> CVarHordeParallel(
+	TEXT("coop.HordeParallel"),
+	1,
+	TEXT("Update horde agents on the task graph workers.\n")
+	TEXT("0: on the game thread only, 1: in parallel (default)"),
+	ECVF_Default);
+
+// Agents per parallel job, few enough that a wave splits across the workers and enough to cover the job's overhead
+static const int32 HordeAgentsPerBatch = 64;
+
+
+// Player view used for promotion, copied so workers don't read from actors
+struct FSHordeViewer
+{
+	FVector Location;
+
+	FVector Direction;
+
+	// Also the goal of the pawn's flow field layer
+	FVector PawnLocation;
+
+	// Looked up on the game thread, null while the pawn has no field yet
+	const FSFlowFieldLayer* FlowLayer;
+};
+
+
+// Sets default values for this component's properties
+USHordeComponent::USHordeComponent()
+{
+	PrimaryComponentTick.bCanEverTick = true;
+	PrimaryComponentTick.TickInterval = 0.1f;
+
+	PromoteDistance = 4000.0f;
+	DemoteDistance = 5000.0f;
+	TargetedDistance = 10000.0f;
+	TargetedHalfAngle = 3.0f;
+	MaxPromotedBots = 48;
+	AgentSpeed = 400.0f;
+	SpawnScatterRadius = 300.0f;
+
+	NumPromoted = 0;
+}
+
+
+void USHordeComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	ASGameMode* GM = Cast<ASGameMode>(GetOwner());
+	FlowField = GM ? GM->GetFlowFieldComp() : nullptr;
+
+	if (!IsHordeEnabled())
+	{
+		SetComponentTickEnabled(false);
+	}
+}
+
+
+void USHordeComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	Super::EndPlay(EndPlayReason);
+
+	SET_DWORD_STAT(STAT_HordeAgents, 0);
+	SET_DWORD_STAT(STAT_HordePromoted, 0);
+}
+
+
+bool USHordeComponent::IsHordeEnabled() const
+{
+	return BotClass != nullptr && FlowField != nullptr;
+}
+
+
+int32 USHordeComponent::GetNumAgents() const
+{
+	return Agents.Num();
+}
+
+
+void USHordeComponent::SpawnAgents(const FVector& Location, int32 Count)
+{
+	if (!IsHordeEnabled())
+	{
+		return;
+	}
+
+	const USHealthComponent* DefaultHealthComp = BotClass->GetDefaultObject<ASCharacter>()->GetHealthComp();
+	const float DefaultHealth = DefaultHealthComp ? DefaultHealthComp->GetDefaultHealth() : 100.0f;
+
+	for (int32 i = 0; i < Count; i++)
+	{
+		FSHordeAgent Agent;
+		Agent.Location = Location;
+		Agent.Health = DefaultHealth;
+
+		const FVector2D Offset = FMath::RandPointInCircle(SpawnScatterRadius);
+		const FVector Scattered = Location + FVector(Offset, 0.0f);
+		if (FlowField->GetGroundHeight(Scattered, Agent.Location.Z))
+		{
+			Agent.Location.X = Scattered.X;
+			Agent.Location.Y = Scattered.Y;
+		}
+
+		Agents.Add(Agent);
+	}
+}
+
+
+void USHordeComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	SCOPE_CYCLE_COUNTER(STAT_HordeUpdate);
+
+	TArray<FSHordeViewer, TInlineAllocator<8>> Viewers;
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		APlayerController* PC = It->Get();
+		if (PC && PC->GetPawn())
+		{
+			FVector ViewLocation;
+			FRotator ViewRotation;
+			PC->GetPlayerViewPoint(ViewLocation, ViewRotation);
+
+			FSHordeViewer Viewer;
+			Viewer.Location = ViewLocation;
+			Viewer.Direction = ViewRotation.Vector();
+			Viewer.PawnLocation = PC->GetPawn()->GetActorLocation();
+			Viewer.FlowLayer = FlowField->FindLayer(PC->GetPawn());
+			Viewers.Add(Viewer);
+		}
+	}
+
+	// Pawns standing in for players, match replay puppets and soak defenders
+	for (const TWeakObjectPtr<APawn>& ExtraTarget : FlowField->GetExtraTargets())
+	{
+		APawn* Pawn = ExtraTarget.Get();
+		ASCharacter* Character = Cast<ASCharacter>(Pawn);
+		if (Pawn == nullptr || Pawn->IsPlayerControlled() || (Character && Character->IsDead()))
+		{
+			continue;
+		}
+
+		FSHordeViewer Viewer;
+		Viewer.Location = Pawn->GetPawnViewLocation();
+		Viewer.Direction = Pawn->GetViewRotation().Vector();
+		Viewer.PawnLocation = Pawn->GetActorLocation();
+		Viewer.FlowLayer = FlowField->FindLayer(Pawn);
+		Viewers.Add(Viewer);
+	}
+
+	GatherPromotedAgents();
+
+	const float TargetedCos = FMath::Cos(FMath::DegreesToRadians(TargetedHalfAngle));
+	const float PromoteDistSquared = FMath::Square(PromoteDistance);
+	const float DemoteDistSquared = FMath::Square(DemoteDistance);
+	const float TargetedDistSquared = FMath::Square(TargetedDistance);
+	const int32 NumBatches = FMath::DivideAndRoundUp(Agents.Num(), HordeAgentsPerBatch);
+
+	// Each batch only writes its own agents, anything touching actors goes through PendingActions
+	{
+		SCOPE_CYCLE_COUNTER(STAT_HordeParallelUpdate);
+
+		ParallelFor(NumBatches, [&](int32 BatchIndex)
+		{
+			const int32 First = BatchIndex * HordeAgentsPerBatch;
+			const int32 Last = FMath::Min(First + HordeAgentsPerBatch, Agents.Num());
+
+			for (int32 i = First; i < Last; i++)
+			{
+				FSHordeAgent& Agent = Agents[i];
+
+				const FSHordeViewer* NearestViewer = nullptr;
+				float NearestDistSquared = BIG_NUMBER;
+				bool bTargeted = false;
+
+				for (const FSHordeViewer& Viewer : Viewers)
+				{
+					const float DistSquared = FVector::DistSquared(Agent.Location, Viewer.PawnLocation);
+					if (DistSquared < NearestDistSquared)
+					{
+						NearestDistSquared = DistSquared;
+						NearestViewer = &Viewer;
+					}
+
+					const FVector ToAgentFromView = Agent.Location - Viewer.Location;
+					if (!bTargeted && ToAgentFromView.SizeSquared() < TargetedDistSquared)
+					{
+						bTargeted = FVector::DotProduct(ToAgentFromView.GetSafeNormal(), Viewer.Direction) >= TargetedCos;
+					}
+				}
+
+				if (Agent.bPromoted)
+				{
+					if (!bTargeted && NearestDistSquared > DemoteDistSquared)
+					{
+						PendingActions.Enqueue(FSHordeAction{ i, false, false, NearestDistSquared });
+					}
+					continue;
+				}
+
+				if (bTargeted || NearestDistSquared < PromoteDistSquared)
+				{
+					PendingActions.Enqueue(FSHordeAction{ i, true, bTargeted, NearestDistSquared });
+				}
+
+				// Far agents only follow the flow field, no collision or avoidance. Ones waiting for a character keep moving until they get one
+				FVector Direction;
+				if (NearestViewer && FlowField->GetFlowDirection(Agent.Location, NearestViewer->FlowLayer, NearestViewer->PawnLocation, Direction))
+				{
+					const FVector NewLocation = Agent.Location + Direction * AgentSpeed * DeltaTime;
+					float GroundHeight;
+					if (FlowField->GetGroundHeight(NewLocation, GroundHeight))
+					{
+						Agent.Location = FVector(NewLocation.X, NewLocation.Y, GroundHeight);
+					}
+				}
+			}
+		}, CVarHordeParallel.GetValueOnGameThread() == 0);
+	}
+
+	ApplyActions();
+
+	SET_DWORD_STAT(STAT_HordeAgents, Agents.Num());
+	SET_DWORD_STAT(STAT_HordePromoted, NumPromoted);
+}
+
+
+void USHordeComponent::GatherPromotedAgents()
+{
+	for (int32 i = Agents.Num() - 1; i >= 0; i--)
+	{
+		FSHordeAgent& Agent = Agents[i];
+		if (!Agent.bPromoted)
+		{
+			continue;
+		}
+
+		ASCharacter* Character = Agent.Character.Get();
+		if (Character == nullptr || Character->IsDead())
+		{
+			// Killed, the character plays out its death on its own
+			NumPromoted--;
+			Agents.RemoveAtSwap(i, 1, false);
+			continue;
+		}
+
+		Agent.Location = Character->GetActorLocation() - FVector(0.0f, 0.0f, Character->GetCapsuleComponent()->GetScaledCapsuleHalfHeight());
+	}
+}
+
+
+void USHordeComponent::ApplyActions()
+{
+	SCOPE_CYCLE_COUNTER(STAT_HordeApply);
+
+	ActionBatch.Reset();
+
+	FSHordeAction Action;
+	while (PendingActions.Dequeue(Action))
+	{
+		ActionBatch.Add(Action);
+	}
+
+	// Workers queue in any order, sorting keeps promotion the same from run to run for match replays
+	ActionBatch.Sort([](const FSHordeAction& A, const FSHordeAction& B)
+	{
+		if (A.bPromote != B.bPromote)
+		{
+			return !A.bPromote;
+		}
+		if (A.bTargeted != B.bTargeted)
+		{
+			return A.bTargeted;
+		}
+		if (A.NearestDistSquared != B.NearestDistSquared)
+		{
+			return A.NearestDistSquared < B.NearestDistSquared;
+		}
+		return A.AgentIndex < B.AgentIndex;
+	});
+
+	for (const FSHordeAction& Pending : ActionBatch)
+	{
+		if (!Pending.bPromote)
+		{
+			Demote(Agents[Pending.AgentIndex]);
+		}
+		else if (NumPromoted < MaxPromotedBots)
+		{
+			Promote(Agents[Pending.AgentIndex]);
+		}
+		else
+		{
+			break;
+		}
+	}
+
+	INC_DWORD_STAT_BY(STAT_HordeActions, ActionBatch.Num());
+}
+
+
+void USHordeComponent::Promote(FSHordeAgent& Agent)
+{
+	const float HalfHeight = BotClass->GetDefaultObject<ASCharacter>()->GetCapsuleComponent()->GetScaledCapsuleHalfHeight();
+	const FVector SpawnLocation = Agent.Location + FVector(0.0f, 0.0f, HalfHeight);
+
+	ASCharacter* Character = nullptr;
+	while (Character == nullptr && FreeBots.Num() > 0)
+	{
+		Character = FreeBots.Pop(false);
+		if (Character && !Character->IsPendingKill())
+		{
+			Character->TeleportTo(SpawnLocation, FRotator::ZeroRotator, false, true);
+			Character->SetPooled(false);
+		}
+		else
+		{
+			Character = nullptr;
+		}
+	}
+
+	if (Character == nullptr)
+	{
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
+
+		Character = GetWorld()->SpawnActor<ASCharacter>(BotClass, SpawnLocation, FRotator::ZeroRotator, SpawnParams);
+		if (Character == nullptr)
+		{
+			return;
+		}
+
+		if (Character->GetController() == nullptr)
+		{
+			Character->SpawnDefaultController();
+		}
+	}
+
+	Character->GetHealthComp()->SetHealth(Agent.Health);
+
+	Agent.Character = Character;
+	Agent.bPromoted = true;
+	NumPromoted++;
+}
+
+
+void USHordeComponent::Demote(FSHordeAgent& Agent)
+{
+	ASCharacter* Character = Agent.Character.Get();
+
+	Agent.Health = Character->GetHealthComp()->GetHealth();
+	Agent.Character = nullptr;
+	Agent.bPromoted = false;
+	NumPromoted--;
+
+	Character->SetPooled(true);
+	FreeBots.Add(Character);
+}
@@ -0,0 +1,89 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "SLevelStreamerComponent.h"
+#include "SWorldSettings.h"
+#include "Kismet/GameplayStatics.h"
+#include "Engine/LatentActionManager.h"
+#include "Engine/World.h"
+#include "HAL/PlatformMemory.h"
+
+
+// Sets default values for this component's properties
+USLevelStreamerComponent::USLevelStreamerComponent()
+{
+	StreamingStartTime = 0.0;
+	NextLatentUUID = 0;
+	bStreamingComplete = false;
+}
+
+
+void USLevelStreamerComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	const bool bDedicatedServer = GetWorld()->GetNetMode() == NM_DedicatedServer;
+
+	// The list belongs to the map, maps saved before ASWorldSettings have none
+	ASWorldSettings* WorldSettings = Cast<ASWorldSettings>(GetWorld()->GetWorldSettings());
+	if (WorldSettings == nullptr)
+	{
+		bStreamingComplete = true;
+		return;
+	}
+
+	for (const FSStreamedLevel& Level : WorldSettings->GetDeferredLevels())
+	{
+		// Art, lighting and audio sublevels never load on a dedicated server
+		if (!bDedicatedServer || Level.bServerRelevant)
+		{
+			PendingLevels.Add(Level.LevelName);
+		}
+	}
+
+	if (PendingLevels.Num() == 0)
+	{
+		bStreamingComplete = true;
+		return;
+	}
+
+	StreamingStartTime = FPlatformTime::Seconds();
+	LoadNextLevel();
+}
+
+
+void USLevelStreamerComponent::LoadNextLevel()
+{
+	if (PendingLevels.Num() == 0)
+	{
+		const FPlatformMemoryStats MemoryStats = FPlatformMemory::GetStats();
+		UE_LOG(LogTemp, Log, TEXT("Deferred sublevels streamed in %.2fs, peak memory %.1f MB"),
+			FPlatformTime::Seconds() - StreamingStartTime, MemoryStats.PeakUsedPhysical / (1024.0 * 1024.0));
+
+		bStreamingComplete = true;
+		return;
+	}
+
+	const FName LevelName = PendingLevels[0];
+	PendingLevels.RemoveAt(0);
+
+	// One level at a time spreads the load hitches instead of stacking them
+	FLatentActionInfo LatentInfo;
+	LatentInfo.CallbackTarget = this;
+	LatentInfo.ExecutionFunction = GET_FUNCTION_NAME_CHECKED(USLevelStreamerComponent, OnLevelLoaded);
+	LatentInfo.Linkage = 0;
+	LatentInfo.UUID = NextLatentUUID++;
+
+	UGameplayStatics::LoadStreamLevel(this, LevelName, true, false, LatentInfo);
+}
+
+
+void USLevelStreamerComponent::OnLevelLoaded()
+{
+	LoadNextLevel();
+}
+
+
+bool USLevelStreamerComponent::IsStreamingComplete() const
+{
+	return bStreamingComplete;
+}
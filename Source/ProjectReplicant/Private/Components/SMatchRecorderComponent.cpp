@@ -0,0 +1,580 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "SMatchRecorderComponent.h"
+#include "SGameMode.h"
+#include "SGameState.h"
+#include "SCharacter.h"
+#include "SWeapon.h"
+#include "SHealthComponent.h"
+#include "SFlowFieldComponent.h"
+#include "GameFramework/PlayerController.h"
+#include "Engine/World.h"
+#include "Misc/App.h"
+#include "Misc/CommandLine.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+static const uint32 MatchRecordingMagic = 0x434D5452;
+
+static const int32 MatchRecordingVersion = 1;
+
+
+FArchive& operator<<(FArchive& Ar, FSMatchEvent& Event)
+{
+	Ar << Event.Time;
+	Ar << (uint8&)Event.Type;
+	Ar << Event.Slot;
+
+	switch (Event.Type)
+	{
+	case ESMatchEventType::PlayerSample:
+	case ESMatchEventType::Shot:
+		Ar << Event.Location;
+		Ar << Event.Rotation;
+		break;
+	case ESMatchEventType::Damage:
+		Ar << Event.Value;
+		break;
+	default:
+		break;
+	}
+
+	return Ar;
+}
+
+
+// Sets default values for this component's properties
+USMatchRecorderComponent::USMatchRecorderComponent()
+{
+	PrimaryComponentTick.bCanEverTick = true;
+
+	SampleInterval = 0.05f;
+	ReplayTickRate = 30.0f;
+
+	bRecording = false;
+	bReplaying = false;
+	bHasNextEvent = false;
+	Seed = 0;
+	StartTime = 0.0f;
+	LastSampleTime = 0.0f;
+	LastFrameRealTime = 0.0;
+	ReplayEndTime = 0.0f;
+}
+
+
+USMatchRecorderComponent* USMatchRecorderComponent::Get(const UObject* WorldContextObject)
+{
+	UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	ASGameMode* GM = World ? Cast<ASGameMode>(World->GetAuthGameMode()) : nullptr;
+
+	return GM ? GM->GetMatchRecorderComp() : nullptr;
+}
+
+
+// Called when the game starts
+void USMatchRecorderComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	FString FileName;
+	if (FParse::Value(FCommandLine::Get(), TEXT("CoopReplay="), FileName))
+	{
+		StartReplay(FileName);
+	}
+	else if (FParse::Param(FCommandLine::Get(), TEXT("CoopRecord")))
+	{
+		StartRecording();
+	}
+
+	if (!bRecording && !bReplaying)
+	{
+		SetComponentTickEnabled(false);
+		return;
+	}
+
+	ASGameMode* GM = Cast<ASGameMode>(GetOwner());
+	if (GM)
+	{
+		GM->OnActorKilled.AddDynamic(this, &USMatchRecorderComponent::HandleActorKilled);
+	}
+}
+
+
+void USMatchRecorderComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (bRecording)
+	{
+		bRecording = false;
+		EventWriter.Reset();
+
+		FString MapName = GetWorld()->GetMapName();
+		MapName.RemoveFromStart(GetWorld()->StreamingLevelsPrefix);
+
+		TArray<uint8> FileData;
+		FMemoryWriter Ar(FileData);
+
+		uint32 Magic = MatchRecordingMagic;
+		int32 Version = MatchRecordingVersion;
+		Ar << Magic;
+		Ar << Version;
+		Ar << Seed;
+		Ar << MapName;
+		Ar.Serialize(EventData.GetData(), EventData.Num());
+
+		const FString FilePath = FPaths::Combine(GetRecordingDir(), FString::Printf(TEXT("%s_%s.coopmatch"), *MapName, *FDateTime::Now().ToString()));
+		if (FFileHelper::SaveArrayToFile(FileData, *FilePath))
+		{
+			UE_LOG(LogTemp, Log, TEXT("Match recording saved to %s: %d bytes, %d shots, %d bot spawns, %d kills, %.0f damage"),
+				*FilePath, FileData.Num(), RecordedStats.Shots, RecordedStats.BotSpawns, RecordedStats.Kills, RecordedStats.Damage);
+		}
+		else
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Failed to save match recording to %s"), *FilePath);
+		}
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+
+FString USMatchRecorderComponent::GetRecordingDir() const
+{
+	return FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("MatchRecordings"));
+}
+
+
+void USMatchRecorderComponent::StartRecording()
+{
+	// The same seed drives the replay's RNG
+	Seed = FMath::Rand();
+	FMath::RandInit(Seed);
+	FMath::SRandInit(Seed);
+
+	EventData.Reset();
+	EventWriter = MakeUnique<FMemoryWriter>(EventData);
+
+	StartTime = GetWorld()->TimeSeconds;
+	LastSampleTime = -SampleInterval;
+	bRecording = true;
+
+	UE_LOG(LogTemp, Log, TEXT("Recording match, seed %d"), Seed);
+}
+
+
+void USMatchRecorderComponent::StartReplay(const FString& FileName)
+{
+	ReplayFileName = FPaths::IsRelative(FileName) ? FPaths::Combine(GetRecordingDir(), FileName) : FileName;
+	if (!FFileHelper::LoadFileToArray(ReplayData, *ReplayFileName))
+	{
+		UE_LOG(LogTemp, Error, TEXT("Could not load match recording %s"), *ReplayFileName);
+		return;
+	}
+
+	EventReader = MakeUnique<FMemoryReader>(ReplayData);
+
+	uint32 Magic = 0;
+	int32 Version = 0;
+	FString MapName;
+	*EventReader << Magic;
+	*EventReader << Version;
+	*EventReader << Seed;
+	*EventReader << MapName;
+
+	if (EventReader->IsError() || Magic != MatchRecordingMagic || Version != MatchRecordingVersion)
+	{
+		UE_LOG(LogTemp, Error, TEXT("%s is not a match recording this build can replay"), *ReplayFileName);
+		EventReader.Reset();
+		return;
+	}
+
+	FString CurrentMapName = GetWorld()->GetMapName();
+	CurrentMapName.RemoveFromStart(GetWorld()->StreamingLevelsPrefix);
+	if (MapName != CurrentMapName)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Match recording was made on %s but %s is loaded"), *MapName, *CurrentMapName);
+	}
+
+	// Fixed steps and the recorded seed so every build replays the same simulation
+	FMath::RandInit(Seed);
+	FMath::SRandInit(Seed);
+	FApp::SetUseFixedTimeStep(true);
+	FApp::SetFixedDeltaTime(1.0 / ReplayTickRate);
+
+	StartTime = GetWorld()->TimeSeconds;
+	LastFrameRealTime = 0.0;
+	bReplaying = true;
+	bHasNextEvent = ReadNextEvent();
+
+	UE_LOG(LogTemp, Log, TEXT("Replaying match %s at %.0f Hz, seed %d"), *ReplayFileName, ReplayTickRate, Seed);
+}
+
+
+void USMatchRecorderComponent::WriteEvent(FSMatchEvent& Event)
+{
+	*EventWriter << Event;
+}
+
+
+bool USMatchRecorderComponent::ReadNextEvent()
+{
+	if (!EventReader.IsValid() || EventReader->AtEnd())
+	{
+		return false;
+	}
+
+	*EventReader << NextEvent;
+
+	return !EventReader->IsError();
+}
+
+
+int32 USMatchRecorderComponent::FindOrAddSlot(APawn* Pawn)
+{
+	AController* Controller = Pawn ? Pawn->GetController() : nullptr;
+	if (Controller == nullptr || !Controller->IsPlayerController())
+	{
+		return INDEX_NONE;
+	}
+
+	const uint8* Slot = PlayerSlots.Find(Controller);
+	if (Slot)
+	{
+		return *Slot;
+	}
+
+	if (PlayerSlots.Num() >= MAX_uint8)
+	{
+		return INDEX_NONE;
+	}
+
+	return PlayerSlots.Add(Controller, (uint8)PlayerSlots.Num());
+}
+
+
+void USMatchRecorderComponent::SamplePlayers()
+{
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		APlayerController* PC = It->Get();
+		APawn* MyPawn = PC ? PC->GetPawn() : nullptr;
+		const int32 Slot = FindOrAddSlot(MyPawn);
+		if (Slot == INDEX_NONE)
+		{
+			continue;
+		}
+
+		FSMatchEvent Event;
+		Event.Time = GetWorld()->TimeSeconds - StartTime;
+		Event.Type = ESMatchEventType::PlayerSample;
+		Event.Slot = (uint8)Slot;
+		Event.Location = MyPawn->GetActorLocation();
+		Event.Rotation = PC->GetControlRotation();
+		WriteEvent(Event);
+	}
+}
+
+
+APawn* USMatchRecorderComponent::GetOrSpawnPuppet(uint8 Slot, const FVector& Location, const FRotator& Rotation)
+{
+	APawn* Puppet = Puppets.FindRef(Slot).Get();
+	if (Puppet && !Puppet->IsPendingKill())
+	{
+		USHealthComponent* HealthComp = Cast<USHealthComponent>(Puppet->GetComponentByClass(USHealthComponent::StaticClass()));
+		if (HealthComp == nullptr || HealthComp->GetHealth() > 0.0f)
+		{
+			return Puppet;
+		}
+	}
+
+	// The recorded player is alive again after dying in the replay, or appears for the first time
+	ASGameMode* GM = Cast<ASGameMode>(GetOwner());
+	if (GM == nullptr || GM->DefaultPawnClass == nullptr)
+	{
+		return nullptr;
+	}
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
+
+	Puppet = GetWorld()->SpawnActor<APawn>(GM->DefaultPawnClass, Location, FRotator(0.0f, Rotation.Yaw, 0.0f), SpawnParams);
+	if (Puppet)
+	{
+		Puppet->SpawnDefaultController();
+		Puppets.Add(Slot, Puppet);
+
+		// Bots chase puppets the way they chased the recorded players
+		USFlowFieldComponent* FlowField = GM->GetFlowFieldComp();
+		if (FlowField)
+		{
+			FlowField->AddExtraTarget(Puppet);
+		}
+	}
+
+	return Puppet;
+}
+
+
+void USMatchRecorderComponent::ApplyEvent(const FSMatchEvent& Event)
+{
+	ASGameMode* GM = Cast<ASGameMode>(GetOwner());
+
+	switch (Event.Type)
+	{
+	case ESMatchEventType::PlayerSample:
+	case ESMatchEventType::Shot:
+	{
+		APawn* Puppet = GetOrSpawnPuppet(Event.Slot, Event.Location, Event.Rotation);
+		if (Puppet == nullptr)
+		{
+			break;
+		}
+
+		Puppet->SetActorLocationAndRotation(Event.Location, FRotator(0.0f, Event.Rotation.Yaw, 0.0f));
+		if (Puppet->GetController())
+		{
+			Puppet->GetController()->SetControlRotation(Event.Rotation);
+		}
+
+		if (Event.Type == ESMatchEventType::Shot)
+		{
+			RecordedStats.Shots++;
+
+			ASCharacter* PuppetChar = Cast<ASCharacter>(Puppet);
+			ASWeapon* Weapon = PuppetChar ? PuppetChar->GetCurrentWeapon() : nullptr;
+			if (Weapon)
+			{
+				Weapon->Fire(GetWorld()->TimeSeconds);
+				ReplayedStats.Shots++;
+			}
+		}
+		break;
+	}
+	case ESMatchEventType::BotSpawn:
+		RecordedStats.BotSpawns++;
+		if (GM)
+		{
+			GM->ReplayBotSpawn();
+			ReplayedStats.BotSpawns++;
+		}
+		break;
+	case ESMatchEventType::WaveState:
+		if (GM)
+		{
+			GM->ReplayWaveState((EWaveState)Event.Slot);
+		}
+		break;
+	case ESMatchEventType::Damage:
+		RecordedStats.Damage += Event.Value;
+		break;
+	case ESMatchEventType::Kill:
+		RecordedStats.Kills++;
+		break;
+	}
+}
+
+
+void USMatchRecorderComponent::FinishReplay()
+{
+	bReplaying = false;
+	SetComponentTickEnabled(false);
+
+	FrameTimes.Sort();
+
+	float TotalFrameTime = 0.0f;
+	for (float FrameTime : FrameTimes)
+	{
+		TotalFrameTime += FrameTime;
+	}
+
+	auto Percentile = [this](float Fraction)
+	{
+		return FrameTimes.Num() > 0 ? FrameTimes[FMath::Min(FMath::FloorToInt(Fraction * FrameTimes.Num()), FrameTimes.Num() - 1)] : 0.0f;
+	};
+
+	const FString Report = FString::Printf(
+		TEXT("Replay of %s\n")
+		TEXT("Frames: %d at %.0f Hz\n")
+		TEXT("Frame ms: avg %.2f, p50 %.2f, p95 %.2f, p99 %.2f, max %.2f\n")
+		TEXT("Shots: %d recorded, %d replayed\n")
+		TEXT("Bot spawns: %d recorded, %d replayed\n")
+		TEXT("Kills: %d recorded, %d replayed\n")
+		TEXT("Damage: %.0f recorded, %.0f replayed\n"),
+		*ReplayFileName, FrameTimes.Num(), ReplayTickRate,
+		FrameTimes.Num() > 0 ? TotalFrameTime / FrameTimes.Num() : 0.0f, Percentile(0.5f), Percentile(0.95f), Percentile(0.99f), Percentile(1.0f),
+		RecordedStats.Shots, ReplayedStats.Shots,
+		RecordedStats.BotSpawns, ReplayedStats.BotSpawns,
+		RecordedStats.Kills, ReplayedStats.Kills,
+		RecordedStats.Damage, ReplayedStats.Damage);
+
+	UE_LOG(LogTemp, Log, TEXT("%s"), *Report);
+
+	const FString ReportPath = FPaths::ChangeExtension(ReplayFileName, TEXT("report.txt"));
+	FFileHelper::SaveStringToFile(Report, *ReportPath);
+
+	// Replays are run from scripts, hand control back once done
+	FPlatformMisc::RequestExit(false);
+}
+
+
+// Called every frame
+void USMatchRecorderComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	const float MatchTime = GetWorld()->TimeSeconds - StartTime;
+
+	if (bRecording)
+	{
+		if (MatchTime - LastSampleTime >= SampleInterval)
+		{
+			LastSampleTime = MatchTime;
+			SamplePlayers();
+		}
+		return;
+	}
+
+	if (!bReplaying)
+	{
+		return;
+	}
+
+	// DeltaTime is fixed while replaying, the real cost of a frame is wall clock time
+	const double Now = FPlatformTime::Seconds();
+	if (LastFrameRealTime > 0.0)
+	{
+		FrameTimes.Add((float)((Now - LastFrameRealTime) * 1000.0));
+	}
+	LastFrameRealTime = Now;
+
+	while (bHasNextEvent && NextEvent.Time <= MatchTime)
+	{
+		ApplyEvent(NextEvent);
+
+		bHasNextEvent = ReadNextEvent();
+		if (!bHasNextEvent)
+		{
+			// Let the last shots and bots play out
+			ReplayEndTime = MatchTime + 2.0f;
+		}
+	}
+
+	if (!bHasNextEvent && MatchTime >= ReplayEndTime)
+	{
+		FinishReplay();
+	}
+}
+
+
+bool USMatchRecorderComponent::IsRecording() const
+{
+	return bRecording;
+}
+
+
+bool USMatchRecorderComponent::IsReplaying() const
+{
+	return bReplaying;
+}
+
+
+void USMatchRecorderComponent::RecordShot(APawn* Shooter, float ShotTime)
+{
+	if (!bRecording)
+	{
+		return;
+	}
+
+	const int32 Slot = FindOrAddSlot(Shooter);
+	if (Slot == INDEX_NONE)
+	{
+		return;
+	}
+
+	FSMatchEvent Event;
+	Event.Time = ShotTime - StartTime;
+	Event.Type = ESMatchEventType::Shot;
+	Event.Slot = (uint8)Slot;
+	Event.Location = Shooter->GetActorLocation();
+	Event.Rotation = Shooter->GetControlRotation();
+	WriteEvent(Event);
+
+	RecordedStats.Shots++;
+}
+
+
+void USMatchRecorderComponent::RecordBotSpawn()
+{
+	if (!bRecording)
+	{
+		return;
+	}
+
+	FSMatchEvent Event;
+	Event.Time = GetWorld()->TimeSeconds - StartTime;
+	Event.Type = ESMatchEventType::BotSpawn;
+	WriteEvent(Event);
+
+	RecordedStats.BotSpawns++;
+}
+
+
+void USMatchRecorderComponent::RecordWaveState(EWaveState NewState)
+{
+	if (!bRecording)
+	{
+		return;
+	}
+
+	FSMatchEvent Event;
+	Event.Time = GetWorld()->TimeSeconds - StartTime;
+	Event.Type = ESMatchEventType::WaveState;
+	Event.Slot = (uint8)NewState;
+	WriteEvent(Event);
+}
+
+
+void USMatchRecorderComponent::RecordDamage(AActor* Victim, float Damage)
+{
+	if (bReplaying)
+	{
+		ReplayedStats.Damage += Damage;
+		return;
+	}
+
+	if (!bRecording)
+	{
+		return;
+	}
+
+	FSMatchEvent Event;
+	Event.Time = GetWorld()->TimeSeconds - StartTime;
+	Event.Type = ESMatchEventType::Damage;
+	Event.Value = Damage;
+	WriteEvent(Event);
+
+	RecordedStats.Damage += Damage;
+}
+
+
+void USMatchRecorderComponent::HandleActorKilled(AActor* VictimActor, AActor* KillerActor, AController* KillerController)
+{
+	if (bReplaying)
+	{
+		ReplayedStats.Kills++;
+		return;
+	}
+
+	if (!bRecording)
+	{
+		return;
+	}
+
+	FSMatchEvent Event;
+	Event.Time = GetWorld()->TimeSeconds - StartTime;
+	Event.Type = ESMatchEventType::Kill;
+	WriteEvent(Event);
+
+	RecordedStats.Kills++;
+}
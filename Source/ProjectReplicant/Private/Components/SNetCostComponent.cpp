@@ -0,0 +1,696 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "SNetCostComponent.h"
+#include "SGameMode.h"
+#include "CoopGame.h"
+#include "Engine/NetConnection.h"
+#include "Engine/NetDriver.h"
+#include "Engine/NetworkObjectList.h"
+#include "Engine/World.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "UObject/CoreNet.h"
+#include "UObject/UnrealType.h"
+
+DECLARE_CYCLE_STAT(TEXT("Net Cost Sample"), STAT_NetCostSample, STATGROUP_CoopGame);
+
+static const double NetCostBucketSeconds = 1.0;
+
+
+// Bit writer that needs no package map, object references are written as a 32 bit stand-in for their NetGUID
+class FSNetCostWriter : public FNetBitWriter
+{
+public:
+
+	FSNetCostWriter()
+		: FNetBitWriter(8 * 1024 * 8)
+	{
+		SetAllowResize(true);
+	}
+
+	using FNetBitWriter::operator<<;
+
+	virtual FArchive& operator<<(UObject*& Object) override
+	{
+		uint32 StandIn = PointerHash(Object);
+		*this << StandIn;
+		return *this;
+	}
+
+	virtual FArchive& operator<<(FWeakObjectPtr& Value) override
+	{
+		UObject* Object = Value.Get();
+		return *this << Object;
+	}
+};
+
+// Inspection only runs on the game thread, one writer is enough
+static FSNetCostWriter& GetNetCostWriter()
+{
+	static FSNetCostWriter Writer;
+	return Writer;
+}
+
+
+// Same bits the engine writes for one value, where a property can't do it alone the value is split up as the rep layout does
+static void SerializeNetValue(FSNetCostWriter& Writer, UProperty* Property, void* Data)
+{
+	if (UStructProperty* StructProperty = Cast<UStructProperty>(Property))
+	{
+		if (StructProperty->Struct->StructFlags & STRUCT_NetSerializeNative)
+		{
+			bool bSuccess = true;
+			StructProperty->Struct->GetCppStructOps()->NetSerialize(Writer, nullptr, bSuccess, Data);
+			return;
+		}
+
+		for (TFieldIterator<UProperty> It(StructProperty->Struct); It; ++It)
+		{
+			if (It->HasAnyPropertyFlags(CPF_RepSkip))
+			{
+				continue;
+			}
+
+			for (int32 Index = 0; Index < It->ArrayDim; Index++)
+			{
+				SerializeNetValue(Writer, *It, It->ContainerPtrToValuePtr<void>(Data, Index));
+			}
+		}
+		return;
+	}
+
+	if (UArrayProperty* ArrayProperty = Cast<UArrayProperty>(Property))
+	{
+		FScriptArrayHelper Helper(ArrayProperty, Data);
+		uint32 Num = Helper.Num();
+		Writer.SerializeIntPacked(Num);
+
+		for (int32 Index = 0; Index < Helper.Num(); Index++)
+		{
+			SerializeNetValue(Writer, ArrayProperty->Inner, Helper.GetRawPtr(Index));
+		}
+		return;
+	}
+
+	if (UObjectPropertyBase* ObjectProperty = Cast<UObjectPropertyBase>(Property))
+	{
+		UObject* Object = ObjectProperty->GetObjectPropertyValue(Data);
+		Writer << Object;
+		return;
+	}
+
+	Property->NetSerializeItem(Writer, nullptr, Data);
+}
+
+
+// Blueprints count as the native class they derive from
+static bool IsCoopGameClass(const UClass* Class)
+{
+	static const FName CoopGamePackageName(TEXT("/Script/CoopGame"));
+
+	while (Class && !Class->HasAnyClassFlags(CLASS_Native))
+	{
+		Class = Class->GetSuperClass();
+	}
+
+	return Class && Class->GetOutermost()->GetFName() == CoopGamePackageName;
+}
+
+
+static FSNetCostChannels GetOpenChannels(const UNetDriver* NetDriver, AActor* Actor)
+{
+	const UNetConnection* OwnerConnection = Actor->GetNetConnection();
+
+	FSNetCostChannels Channels;
+	for (UNetConnection* Connection : NetDriver->ClientConnections)
+	{
+		if (Connection && Connection->FindActorChannelRef(Actor))
+		{
+			if (Connection == OwnerConnection)
+			{
+				Channels.bOwner = true;
+			}
+			else
+			{
+				Channels.NumOthers++;
+			}
+		}
+	}
+
+	return Channels;
+}
+
+
+// Conditions on who gets a property after the initial bunch, the ones that depend on the role go by ownership
+static bool GetNetCostAudience(ELifetimeCondition Condition, ESNetCostAudience& OutAudience)
+{
+	switch (Condition)
+	{
+	case COND_InitialOnly:
+	case COND_ReplayOnly:
+		return false;
+	case COND_OwnerOnly:
+	case COND_AutonomousOnly:
+	case COND_InitialOrOwner:
+	case COND_ReplayOrOwner:
+		OutAudience = ESNetCostAudience::OwnerOnly;
+		return true;
+	case COND_SkipOwner:
+	case COND_SimulatedOnly:
+	case COND_SimulatedOnlyNoReplay:
+	case COND_SimulatedOrPhysics:
+	case COND_SimulatedOrPhysicsNoReplay:
+		OutAudience = ESNetCostAudience::SkipOwner;
+		return true;
+	default:
+		OutAudience = ESNetCostAudience::Everyone;
+		return true;
+	}
+}
+
+
+// Sets default values for this component's properties
+USNetCostComponent::USNetCostComponent()
+{
+	PrimaryComponentTick.bCanEverTick = true;
+	PrimaryComponentTick.bStartWithTickEnabled = false;
+	// Last thing before the net driver replicates, so samples see what it will see
+	PrimaryComponentTick.TickGroup = TG_PostUpdateWork;
+
+	WindowSeconds = 30.0f;
+
+	bInspecting = false;
+	StartTime = 0.0;
+	LastSampleTime = 0.0;
+	CurrentBucket = 0;
+	CurrentBucketStartTime = 0.0;
+}
+
+
+void USNetCostComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	StopInspecting();
+
+	Super::EndPlay(EndPlayReason);
+}
+
+
+void USNetCostComponent::StartInspecting(float InWindowSeconds)
+{
+	UNetDriver* NetDriver = GetWorld()->GetNetDriver();
+	if (NetDriver == nullptr || GetNetMode() == NM_Client)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Net cost inspector needs a server with a net driver"));
+		return;
+	}
+
+	StopInspecting();
+
+	const float Window = InWindowSeconds > 0.0f ? InWindowSeconds : WindowSeconds;
+	Buckets.Reset();
+	Buckets.SetNum(FMath::Max(FMath::CeilToInt(Window / NetCostBucketSeconds), 1));
+	Shadows.Reset();
+	ClassProperties.Reset();
+	ActorStates.Reset();
+
+	const double Now = GetWorld()->TimeSeconds;
+	StartTime = Now;
+	LastSampleTime = Now;
+	CurrentBucket = 0;
+	CurrentBucketStartTime = Now;
+
+	if (NetDriver->SendRPCDel.IsBound())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Net cost inspector: the net driver's RPC hook is taken, RPCs won't be counted"));
+	}
+	else
+	{
+		NetDriver->SendRPCDel.BindUObject(this, &USNetCostComponent::HandleSendRPC);
+	}
+
+	BoundNetDriver = NetDriver;
+	bInspecting = true;
+	SetComponentTickEnabled(true);
+
+	UE_LOG(LogTemp, Log, TEXT("Net cost inspector started, %d second window"), Buckets.Num());
+}
+
+
+void USNetCostComponent::StopInspecting()
+{
+	UNetDriver* NetDriver = BoundNetDriver.Get();
+	if (NetDriver && NetDriver->SendRPCDel.IsBoundToObject(this))
+	{
+		NetDriver->SendRPCDel.Unbind();
+	}
+
+	BoundNetDriver = nullptr;
+	bInspecting = false;
+	SetComponentTickEnabled(false);
+}
+
+
+bool USNetCostComponent::IsInspecting() const
+{
+	return bInspecting;
+}
+
+
+void USNetCostComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	UNetDriver* NetDriver = BoundNetDriver.Get();
+	if (NetDriver == nullptr)
+	{
+		StopInspecting();
+		return;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_NetCostSample);
+
+	const double Now = GetWorld()->TimeSeconds;
+	AdvanceBuckets(Now);
+	LastSampleTime = Now;
+
+	ActorStates.Reset();
+
+	for (const TSharedPtr<FNetworkObjectInfo>& ObjectInfo : NetDriver->GetNetworkObjectList().GetAllObjects())
+	{
+		AActor* Actor = ObjectInfo.IsValid() ? ObjectInfo->Actor : nullptr;
+		if (Actor == nullptr || Actor->IsPendingKill() || !IsCoopGameClass(Actor->GetClass()))
+		{
+			continue;
+		}
+
+		const FName ClassName = Actor->GetClass()->GetFName();
+		const FSNetCostChannels Channels = GetOpenChannels(NetDriver, Actor);
+
+		FSNetCostActorState& State = ActorStates.FindOrAdd(ClassName);
+		State.NumActors++;
+		State.NumChannels += Channels.Num();
+		if (Actor->NetDormancy > DORM_Awake)
+		{
+			State.NumDormant++;
+		}
+
+		// Nothing is sent for actors without a channel, dormant or not relevant to anyone
+		if (Channels.Num() > 0)
+		{
+			SampleActor(Actor, ClassName, Channels, Now);
+		}
+	}
+}
+
+
+void USNetCostComponent::AdvanceBuckets(double Now)
+{
+	int32 NumAdvanced = 0;
+	while (Now - CurrentBucketStartTime >= NetCostBucketSeconds && NumAdvanced < Buckets.Num())
+	{
+		CurrentBucket = (CurrentBucket + 1) % Buckets.Num();
+		Buckets[CurrentBucket].Reset();
+		CurrentBucketStartTime += NetCostBucketSeconds;
+		NumAdvanced++;
+	}
+
+	if (NumAdvanced == 0)
+	{
+		return;
+	}
+
+	// After a hitch longer than the window everything was cleared, start over from now
+	if (NumAdvanced == Buckets.Num())
+	{
+		CurrentBucketStartTime = Now;
+	}
+
+	for (auto It = Shadows.CreateIterator(); It; ++It)
+	{
+		if (!It->Key.IsValid())
+		{
+			It.RemoveCurrent();
+		}
+	}
+}
+
+
+void USNetCostComponent::SampleActor(AActor* Actor, FName ActorClassName, const FSNetCostChannels& Channels, double Now)
+{
+	FSNetCostShadow& ActorShadow = Shadows.FindOrAdd(Actor);
+	if (Now < ActorShadow.NextSampleTime)
+	{
+		return;
+	}
+
+	// As often as the net driver compares the actor
+	ActorShadow.NextSampleTime = Now + 1.0 / FMath::Max(Actor->NetUpdateFrequency, 1.0f);
+
+	FSNetCostCounters ActorCounters;
+	bool bOwnerSent = false;
+	bool bOthersSent = false;
+	CompareObject(Actor, ActorShadow, ActorCounters, Channels, bOwnerSent, bOthersSent);
+
+	for (UActorComponent* Component : Actor->GetReplicatedComponents())
+	{
+		if (Component && Component->GetIsReplicated())
+		{
+			CompareObject(Component, Shadows.FindOrAdd(Component), ActorCounters, Channels, bOwnerSent, bOthersSent);
+		}
+	}
+
+	ActorCounters.Sends += (bOwnerSent && Channels.bOwner ? 1 : 0) + (bOthersSent ? Channels.NumOthers : 0);
+
+	Buckets[CurrentBucket].FindOrAdd(FSNetCostKey{ ESNetCostKind::Actor, ActorClassName, NAME_None }).Add(ActorCounters);
+}
+
+
+void USNetCostComponent::CompareObject(UObject* Object, FSNetCostShadow& Shadow, FSNetCostCounters& ActorCounters, const FSNetCostChannels& Channels, bool& bOutOwnerSent, bool& bOutOthersSent)
+{
+	const TArray<FSNetCostProperty>& Properties = GetReplicatedProperties(Object->GetClass());
+
+	// The initial bunch isn't counted, only changes after it
+	const bool bFirstSample = Shadow.Values.Num() != Properties.Num();
+	if (bFirstSample)
+	{
+		Shadow.Values.Reset();
+		Shadow.Values.SetNum(Properties.Num());
+	}
+
+	FSNetCostWriter& Writer = GetNetCostWriter();
+	TMap<FSNetCostKey, FSNetCostCounters>& Bucket = Buckets[CurrentBucket];
+
+	for (int32 i = 0; i < Properties.Num(); i++)
+	{
+		UProperty* Property = Properties[i].Property;
+		const ESNetCostAudience Audience = Properties[i].Audience;
+
+		const uint64 StartCycles = FPlatformTime::Cycles64();
+
+		Writer.Reset();
+		for (int32 Index = 0; Index < Property->ArrayDim; Index++)
+		{
+			SerializeNetValue(Writer, Property, Property->ContainerPtrToValuePtr<void>(Object, Index));
+		}
+
+		TArray<uint8>& Value = Shadow.Values[i];
+		const int32 NumBytes = (int32)Writer.GetNumBytes();
+		const bool bChanged = !bFirstSample && (Value.Num() != NumBytes || FMemory::Memcmp(Value.GetData(), Writer.GetData(), NumBytes) != 0);
+		if (bChanged || bFirstSample)
+		{
+			Value.SetNumUninitialized(NumBytes);
+			FMemory::Memcpy(Value.GetData(), Writer.GetData(), NumBytes);
+		}
+
+		FSNetCostCounters PropertyCounters;
+		PropertyCounters.CompareCycles = FPlatformTime::Cycles64() - StartCycles;
+		const int32 NumRecipients = Channels.Num(Audience);
+		if (bChanged && NumRecipients > 0)
+		{
+			PropertyCounters.Bits = Writer.GetNumBits() * NumRecipients;
+			PropertyCounters.Sends = NumRecipients;
+			bOutOwnerSent |= Audience != ESNetCostAudience::SkipOwner;
+			bOutOthersSent |= Audience != ESNetCostAudience::OwnerOnly;
+		}
+
+		Bucket.FindOrAdd(FSNetCostKey{ ESNetCostKind::Property, Property->GetOwnerClass()->GetFName(), Property->GetFName() }).Add(PropertyCounters);
+
+		ActorCounters.Bits += PropertyCounters.Bits;
+		ActorCounters.CompareCycles += PropertyCounters.CompareCycles;
+	}
+}
+
+
+const TArray<FSNetCostProperty>& USNetCostComponent::GetReplicatedProperties(const UClass* Class)
+{
+	if (const TArray<FSNetCostProperty>* Found = ClassProperties.Find(Class))
+	{
+		return *Found;
+	}
+
+	// Conditions are only known to the class's own GetLifetimeReplicatedProps, matched up by RepIndex
+	TArray<FLifetimeProperty> LifetimeProps;
+	Class->GetDefaultObject()->GetLifetimeReplicatedProps(LifetimeProps);
+
+	TMap<uint16, ELifetimeCondition> Conditions;
+	for (const FLifetimeProperty& LifetimeProp : LifetimeProps)
+	{
+		Conditions.Add(LifetimeProp.RepIndex, LifetimeProp.Condition);
+	}
+
+	TArray<FSNetCostProperty>& Properties = ClassProperties.Add(Class);
+	for (TFieldIterator<UProperty> It(Class); It; ++It)
+	{
+		if (!It->HasAnyPropertyFlags(CPF_Net))
+		{
+			continue;
+		}
+
+		const ELifetimeCondition* Condition = Conditions.Find(It->RepIndex);
+		ESNetCostAudience Audience;
+		if (GetNetCostAudience(Condition ? *Condition : COND_None, Audience))
+		{
+			Properties.Add(FSNetCostProperty{ *It, Audience });
+		}
+	}
+
+	return Properties;
+}
+
+
+void USNetCostComponent::HandleSendRPC(AActor* Actor, UFunction* Function, void* Parameters, FOutParmRec* OutParms, FFrame* Stack, UObject* SubObject, bool& bBlockSendRPC)
+{
+	UNetDriver* NetDriver = BoundNetDriver.Get();
+	if (!bInspecting || NetDriver == nullptr || Actor == nullptr || Function == nullptr || !IsCoopGameClass(Actor->GetClass()))
+	{
+		return;
+	}
+
+	// Multicasts go out once per client with the actor's channel open
+	const int32 NumRecipients = Function->HasAnyFunctionFlags(FUNC_NetMulticast) ? GetOpenChannels(NetDriver, Actor).Num() : 1;
+	if (NumRecipients == 0)
+	{
+		return;
+	}
+
+	FSNetCostWriter& Writer = GetNetCostWriter();
+	Writer.Reset();
+
+	for (TFieldIterator<UProperty> It(Function); It && (It->PropertyFlags & (CPF_Parm | CPF_ReturnParm)) == CPF_Parm; ++It)
+	{
+		for (int32 Index = 0; Index < It->ArrayDim; Index++)
+		{
+			SerializeNetValue(Writer, *It, It->ContainerPtrToValuePtr<void>(Parameters, Index));
+		}
+	}
+
+	FSNetCostCounters Sent;
+	Sent.Bits = Writer.GetNumBits() * NumRecipients;
+	Sent.Sends = NumRecipients;
+
+	TMap<FSNetCostKey, FSNetCostCounters>& Bucket = Buckets[CurrentBucket];
+	Bucket.FindOrAdd(FSNetCostKey{ ESNetCostKind::RPC, Function->GetOwnerClass()->GetFName(), Function->GetFName() }).Add(Sent);
+	Bucket.FindOrAdd(FSNetCostKey{ ESNetCostKind::Actor, Actor->GetClass()->GetFName(), NAME_None }).Add(Sent);
+}
+
+
+void USNetCostComponent::GatherTotals(TMap<FSNetCostKey, FSNetCostCounters>& OutTotals) const
+{
+	OutTotals.Reset();
+
+	for (const TMap<FSNetCostKey, FSNetCostCounters>& Bucket : Buckets)
+	{
+		for (const TPair<FSNetCostKey, FSNetCostCounters>& Pair : Bucket)
+		{
+			OutTotals.FindOrAdd(Pair.Key).Add(Pair.Value);
+		}
+	}
+}
+
+
+double USNetCostComponent::GetWindowLength() const
+{
+	// Full buckets behind the current one, plus however far the current one has got
+	const double Covered = (Buckets.Num() - 1) * NetCostBucketSeconds + (LastSampleTime - CurrentBucketStartTime);
+	return FMath::Max(FMath::Min(LastSampleTime - StartTime, Covered), 0.001);
+}
+
+
+static const TCHAR* GetNetCostKindName(ESNetCostKind Kind)
+{
+	switch (Kind)
+	{
+	case ESNetCostKind::Actor: return TEXT("Actor");
+	case ESNetCostKind::Property: return TEXT("Property");
+	default: return TEXT("RPC");
+	}
+}
+
+
+// Most bytes first, at equal bytes actor rows lead and then whatever costs most to compare
+static void SortNetCostRows(TArray<TPair<FSNetCostKey, FSNetCostCounters>>& Rows)
+{
+	Rows.Sort([](const TPair<FSNetCostKey, FSNetCostCounters>& A, const TPair<FSNetCostKey, FSNetCostCounters>& B)
+	{
+		if (A.Value.Bits != B.Value.Bits)
+		{
+			return A.Value.Bits > B.Value.Bits;
+		}
+		if (A.Key.Kind != B.Key.Kind)
+		{
+			return A.Key.Kind < B.Key.Kind;
+		}
+		return A.Value.CompareCycles > B.Value.CompareCycles;
+	});
+}
+
+
+void USNetCostComponent::LogReport(int32 MaxRows) const
+{
+	if (Buckets.Num() == 0)
+	{
+		UE_LOG(LogTemp, Log, TEXT("Net cost inspector hasn't run, start it with coop.NetCostStart"));
+		return;
+	}
+
+	TMap<FSNetCostKey, FSNetCostCounters> Totals;
+	GatherTotals(Totals);
+
+	TArray<TPair<FSNetCostKey, FSNetCostCounters>> Rows = Totals.Array();
+	SortNetCostRows(Rows);
+
+	const double Window = GetWindowLength();
+	UE_LOG(LogTemp, Log, TEXT("Net cost over the last %.1f s%s, per second:"), Window, bInspecting ? TEXT("") : TEXT(" (stopped)"));
+
+	for (int32 i = 0; i < Rows.Num() && i < MaxRows; i++)
+	{
+		const FSNetCostKey& Key = Rows[i].Key;
+		const FSNetCostCounters& Counters = Rows[i].Value;
+
+		const double BytesPerSecond = Counters.Bits / 8.0 / Window;
+		const double SendsPerSecond = Counters.Sends / Window;
+		const double CompareMsPerSecond = FPlatformTime::ToMilliseconds64(Counters.CompareCycles) / Window;
+
+		if (Key.Kind == ESNetCostKind::Actor)
+		{
+			const FSNetCostActorState* State = ActorStates.Find(Key.Owner);
+			UE_LOG(LogTemp, Log, TEXT("  %-8s %-48s %9.1f B %7.1f sends %7.3f ms compare  %d actors, %d dormant, %d channels"),
+				GetNetCostKindName(Key.Kind), *Key.Owner.ToString(), BytesPerSecond, SendsPerSecond, CompareMsPerSecond,
+				State ? State->NumActors : 0, State ? State->NumDormant : 0, State ? State->NumChannels : 0);
+		}
+		else
+		{
+			UE_LOG(LogTemp, Log, TEXT("  %-8s %-48s %9.1f B %7.1f sends %7.3f ms compare"),
+				GetNetCostKindName(Key.Kind), *FString::Printf(TEXT("%s.%s"), *Key.Owner.ToString(), *Key.Name.ToString()),
+				BytesPerSecond, SendsPerSecond, CompareMsPerSecond);
+		}
+	}
+}
+
+
+FString USNetCostComponent::DumpToCSV() const
+{
+	if (Buckets.Num() == 0)
+	{
+		return FString();
+	}
+
+	TMap<FSNetCostKey, FSNetCostCounters> Totals;
+	GatherTotals(Totals);
+
+	TArray<TPair<FSNetCostKey, FSNetCostCounters>> Rows = Totals.Array();
+	SortNetCostRows(Rows);
+
+	const double Window = GetWindowLength();
+
+	FString CSV = TEXT("Kind,Class,Name,Bytes,Sends,BytesPerSecond,SendsPerSecond,CompareMs,Actors,Dormant,Channels\n");
+	for (const TPair<FSNetCostKey, FSNetCostCounters>& Row : Rows)
+	{
+		const FSNetCostActorState* State = Row.Key.Kind == ESNetCostKind::Actor ? ActorStates.Find(Row.Key.Owner) : nullptr;
+
+		CSV += FString::Printf(TEXT("%s,%s,%s,%lld,%d,%.1f,%.2f,%.3f,%d,%d,%d\n"),
+			GetNetCostKindName(Row.Key.Kind), *Row.Key.Owner.ToString(), Row.Key.Name.IsNone() ? TEXT("") : *Row.Key.Name.ToString(),
+			Row.Value.Bits / 8, Row.Value.Sends, Row.Value.Bits / 8.0 / Window, Row.Value.Sends / Window,
+			FPlatformTime::ToMilliseconds64(Row.Value.CompareCycles),
+			State ? State->NumActors : 0, State ? State->NumDormant : 0, State ? State->NumChannels : 0);
+	}
+
+	const FString FilePath = FPaths::Combine(FPaths::ProfilingDir(), TEXT("NetCost"),
+		FString::Printf(TEXT("NetCost_%s_%s.csv"), *GetWorld()->GetMapName(), *FDateTime::Now().ToString()));
+
+	return FFileHelper::SaveStringToFile(CSV, *FilePath) ? FilePath : FString();
+}
+
+
+static USNetCostComponent* FindNetCostComp(UWorld* World, const TCHAR* Command)
+{
+	ASGameMode* GM = World ? Cast<ASGameMode>(World->GetAuthGameMode()) : nullptr;
+	if (GM == nullptr || GM->GetNetCostComp() == nullptr)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("%s: only available on the server"), Command);
+		return nullptr;
+	}
+
+	return GM->GetNetCostComp();
+}
+
+static void NetCostStart(const TArray<FString>& Args, UWorld* World)
+{
+	if (USNetCostComponent* NetCostComp = FindNetCostComp(World, TEXT("coop.NetCostStart")))
+	{
+		NetCostComp->StartInspecting(Args.Num() > 0 ? FCString::Atof(*Args[0]) : 0.0f);
+	}
+}
+
+static void NetCostStop(UWorld* World)
+{
+	if (USNetCostComponent* NetCostComp = FindNetCostComp(World, TEXT("coop.NetCostStop")))
+	{
+		NetCostComp->StopInspecting();
+	}
+}
+
+static void NetCostReport(const TArray<FString>& Args, UWorld* World)
+{
+	if (USNetCostComponent* NetCostComp = FindNetCostComp(World, TEXT("coop.NetCostReport")))
+	{
+		NetCostComp->LogReport(Args.Num() > 0 ? FMath::Max(FCString::Atoi(*Args[0]), 1) : 25);
+	}
+}
+
+static void NetCostDump(UWorld* World)
+{
+	if (USNetCostComponent* NetCostComp = FindNetCostComp(World, TEXT("coop.NetCostDump")))
+	{
+		const FString FilePath = NetCostComp->DumpToCSV();
+		if (FilePath.IsEmpty())
+		{
+			UE_LOG(LogTemp, Warning, TEXT("coop.NetCostDump: nothing written, start the inspector with coop.NetCostStart first"));
+		}
+		else
+		{
+			UE_LOG(LogTemp, Log, TEXT("Net cost written to %s"), *FilePath);
+		}
+	}
+}
+
+static FAutoConsoleCommandWithWorldAndArgs NetCostStartCmd(
+	TEXT("coop.NetCostStart"),
+	TEXT("Starts gathering bytes, sends and compare time per CoopGame actor class, replicated property and RPC. Usage: coop.NetCostStart [WindowSeconds]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&NetCostStart));
+
+static FAutoConsoleCommandWithWorld NetCostStopCmd(
+	TEXT("coop.NetCostStop"),
+	TEXT("Stops the net cost inspector, what it gathered can still be reported and dumped"),
+	FConsoleCommandWithWorldDelegate::CreateStatic(NetCostStop));
+
+static FAutoConsoleCommandWithWorldAndArgs NetCostReportCmd(
+	TEXT("coop.NetCostReport"),
+	TEXT("Logs the most expensive net cost rows over the window. Usage: coop.NetCostReport [Rows]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&NetCostReport));
+
+static FAutoConsoleCommandWithWorld NetCostDumpCmd(
+	TEXT("coop.NetCostDump"),
+	TEXT("Writes every net cost row over the window to Saved/Profiling/NetCost as CSV"),
+	FConsoleCommandWithWorldDelegate::CreateStatic(NetCostDump));
@@ -0,0 +1,136 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "SPickupGridComponent.h"
+#include "SPickupActor.h"
+#include "SHealthComponent.h"
+#include "SGameMode.h"
+#include "CoopGame.h"
+#include "GameFramework/PlayerController.h"
+#include "GameFramework/Pawn.h"
+#include "Engine/World.h"
+
+DECLARE_CYCLE_STAT(TEXT("Pickup Grid"), STAT_PickupGrid, STATGROUP_CoopGame);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Pickups Registered"), STAT_PickupsRegistered, STATGROUP_CoopGame);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Pickup Tests"), STAT_PickupTests, STATGROUP_CoopGame);
+
+
+// Sets default values for this component's properties
+USPickupGridComponent::USPickupGridComponent()
+{
+	PrimaryComponentTick.bCanEverTick = true;
+	PrimaryComponentTick.TickInterval = 0.1f;
+
+	CellSize = 500.0f;
+
+	NumPickups = 0;
+}
+
+
+USPickupGridComponent* USPickupGridComponent::Get(const UObject* WorldContextObject)
+{
+	UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	ASGameMode* GM = World ? Cast<ASGameMode>(World->GetAuthGameMode()) : nullptr;
+
+	return GM ? GM->GetPickupGridComp() : nullptr;
+}
+
+
+FIntPoint USPickupGridComponent::GetCell(const FVector& Location) const
+{
+	return FIntPoint(FMath::FloorToInt(Location.X / CellSize), FMath::FloorToInt(Location.Y / CellSize));
+}
+
+
+void USPickupGridComponent::RegisterPickup(ASPickupActor* Pickup)
+{
+	TArray<TWeakObjectPtr<ASPickupActor>>& Cell = Cells.FindOrAdd(GetCell(Pickup->GetActorLocation()));
+	if (!Cell.Contains(Pickup))
+	{
+		Cell.Add(Pickup);
+		NumPickups++;
+	}
+}
+
+
+void USPickupGridComponent::UnregisterPickup(ASPickupActor* Pickup)
+{
+	const FIntPoint CellKey = GetCell(Pickup->GetActorLocation());
+	TArray<TWeakObjectPtr<ASPickupActor>>* Cell = Cells.Find(CellKey);
+	if (Cell && Cell->RemoveSingleSwap(Pickup) > 0)
+	{
+		NumPickups--;
+
+		if (Cell->Num() == 0)
+		{
+			Cells.Remove(CellKey);
+		}
+	}
+}
+
+
+void USPickupGridComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	SCOPE_CYCLE_COUNTER(STAT_PickupGrid);
+	SET_DWORD_STAT(STAT_PickupsRegistered, NumPickups);
+
+	if (Cells.Num() == 0)
+	{
+		return;
+	}
+
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		APlayerController* PC = It->Get();
+		APawn* Pawn = PC ? PC->GetPawn() : nullptr;
+		if (Pawn == nullptr)
+		{
+			continue;
+		}
+
+		USHealthComponent* HealthComp = Cast<USHealthComponent>(Pawn->GetComponentByClass(USHealthComponent::StaticClass()));
+		if (HealthComp == nullptr || HealthComp->GetHealth() <= 0.0f)
+		{
+			continue;
+		}
+
+		float PawnRadius;
+		float PawnHalfHeight;
+		Pawn->GetSimpleCollisionCylinder(PawnRadius, PawnHalfHeight);
+		const FVector PawnLocation = Pawn->GetActorLocation();
+
+		// A pickup in reach is at most one cell away when cells are larger than the reach
+		const FIntPoint PawnCell = GetCell(PawnLocation);
+		for (int32 Y = -1; Y <= 1; Y++)
+		{
+			for (int32 X = -1; X <= 1; X++)
+			{
+				TArray<TWeakObjectPtr<ASPickupActor>>* Cell = Cells.Find(PawnCell + FIntPoint(X, Y));
+				if (Cell == nullptr)
+				{
+					continue;
+				}
+
+				for (const TWeakObjectPtr<ASPickupActor>& PickupPtr : *Cell)
+				{
+					ASPickupActor* Pickup = PickupPtr.Get();
+					if (Pickup == nullptr || !Pickup->HasPowerup())
+					{
+						continue;
+					}
+
+					INC_DWORD_STAT(STAT_PickupTests);
+
+					// Same test the pickup sphere against the capsule used to do
+					const FVector Delta = PawnLocation - Pickup->GetActorLocation();
+					const float Reach = Pickup->GetPickupRadius() + PawnRadius;
+					if (Delta.SizeSquared2D() <= FMath::Square(Reach) && FMath::Abs(Delta.Z) <= Pickup->GetPickupRadius() + PawnHalfHeight)
+					{
+						Pickup->ActivateFor(Pawn);
+					}
+				}
+			}
+		}
+	}
+}
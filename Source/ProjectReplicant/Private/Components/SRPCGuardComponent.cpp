@@ -0,0 +1,178 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "SRPCGuardComponent.h"
+#include "SGameMode.h"
+#include "CoopGame.h"
+#include "Engine/NetConnection.h"
+#include "Engine/World.h"
+#include "GameFramework/GameSession.h"
+#include "GameFramework/PlayerController.h"
+#include "GameFramework/PlayerState.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("RPCs Accepted"), STAT_RPCsAccepted, STATGROUP_CoopGame);
+DECLARE_DWORD_COUNTER_STAT(TEXT("RPCs Dropped"), STAT_RPCsDropped, STATGROUP_CoopGame);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("RPC Flood Kicks"), STAT_RPCFloodKicks, STATGROUP_CoopGame);
+
+
+// Sets default values for this component's properties
+USRPCGuardComponent::USRPCGuardComponent()
+{
+	PrimaryComponentTick.bCanEverTick = true;
+	PrimaryComponentTick.TickInterval = 1.0f;
+
+	MaxRPCsPerFrame = 16;
+	BurstSeconds = 1.0f;
+	MaxDropsPerSecond = 100;
+	bKickFloodingClients = true;
+}
+
+
+bool USRPCGuardComponent::AllowRPC(const UObject* RPCTarget, FName FunctionName, float MaxCallsPerSecond)
+{
+	const UActorComponent* TargetComp = Cast<UActorComponent>(RPCTarget);
+	const AActor* TargetActor = TargetComp ? TargetComp->GetOwner() : Cast<AActor>(RPCTarget);
+	UNetConnection* Connection = TargetActor ? TargetActor->GetNetConnection() : nullptr;
+	if (Connection == nullptr)
+	{
+		// Local player on a listen server
+		return true;
+	}
+
+	UWorld* World = TargetActor->GetWorld();
+	ASGameMode* GM = World ? Cast<ASGameMode>(World->GetAuthGameMode()) : nullptr;
+	USRPCGuardComponent* Guard = GM ? GM->GetRPCGuardComp() : nullptr;
+
+	return Guard == nullptr || Guard->ConsumeBudget(Connection, FunctionName, MaxCallsPerSecond);
+}
+
+
+bool USRPCGuardComponent::ConsumeBudget(UNetConnection* Connection, FName FunctionName, float MaxCallsPerSecond)
+{
+	FSConnectionRPCState& State = Connections.FindOrAdd(Connection);
+
+	bool bAllowed = true;
+
+	if (State.LastFrame != GFrameCounter)
+	{
+		State.LastFrame = GFrameCounter;
+		State.CallsThisFrame = 0;
+	}
+
+	if (++State.CallsThisFrame > MaxRPCsPerFrame)
+	{
+		bAllowed = false;
+	}
+	else
+	{
+		const float Now = GetWorld()->RealTimeSeconds;
+		const float MaxTokens = FMath::Max(MaxCallsPerSecond * BurstSeconds, 1.0f);
+
+		FSRPCBucket& Bucket = State.Buckets.FindOrAdd(FunctionName);
+		if (Bucket.LastRefillTime < 0.0f)
+		{
+			Bucket.Tokens = MaxTokens;
+		}
+		else
+		{
+			Bucket.Tokens = FMath::Min(Bucket.Tokens + (Now - Bucket.LastRefillTime) * MaxCallsPerSecond, MaxTokens);
+		}
+		Bucket.LastRefillTime = Now;
+
+		if (Bucket.Tokens >= 1.0f)
+		{
+			Bucket.Tokens -= 1.0f;
+		}
+		else
+		{
+			bAllowed = false;
+		}
+	}
+
+	if (bAllowed)
+	{
+		State.TotalAccepted++;
+		INC_DWORD_STAT(STAT_RPCsAccepted);
+		return true;
+	}
+
+	State.TotalDropped++;
+	State.RecentDrops++;
+	INC_DWORD_STAT(STAT_RPCsDropped);
+
+	if (bKickFloodingClients && State.RecentDrops > MaxDropsPerSecond)
+	{
+		KickConnection(Connection);
+	}
+
+	return false;
+}
+
+
+void USRPCGuardComponent::KickConnection(UNetConnection* Connection)
+{
+	APlayerController* PC = Connection->PlayerController;
+	AGameModeBase* GM = Cast<AGameModeBase>(GetOwner());
+	if (PC == nullptr || GM == nullptr || GM->GameSession == nullptr || PC->IsPendingKillPending())
+	{
+		return;
+	}
+
+	UE_LOG(LogTemp, Warning, TEXT("Kicking %s for flooding server RPCs"), PC->PlayerState ? *PC->PlayerState->GetPlayerName() : *PC->GetName());
+	INC_DWORD_STAT(STAT_RPCFloodKicks);
+
+	Connections.Remove(Connection);
+
+	GM->GameSession->KickPlayer(PC, NSLOCTEXT("CoopGame", "RPCFloodKick", "Kicked for sending too many requests"));
+}
+
+
+void USRPCGuardComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	for (auto It = Connections.CreateIterator(); It; ++It)
+	{
+		if (!It.Key().IsValid())
+		{
+			It.RemoveCurrent();
+			continue;
+		}
+
+		It.Value().RecentDrops = 0;
+	}
+}
+
+
+void USRPCGuardComponent::LogReport() const
+{
+	for (const auto& Pair : Connections)
+	{
+		UNetConnection* Connection = Pair.Key.Get();
+		APlayerController* PC = Connection ? Connection->PlayerController : nullptr;
+		if (PC == nullptr)
+		{
+			continue;
+		}
+
+		UE_LOG(LogTemp, Log, TEXT("%s: %d RPCs accepted, %d dropped"), PC->PlayerState ? *PC->PlayerState->GetPlayerName() : *PC->GetName(),
+			Pair.Value.TotalAccepted, Pair.Value.TotalDropped);
+	}
+}
+
+
+static void RPCGuardReport(UWorld* World)
+{
+	ASGameMode* GM = World ? Cast<ASGameMode>(World->GetAuthGameMode()) : nullptr;
+	if (GM == nullptr || GM->GetRPCGuardComp() == nullptr)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("coop.RPCGuardReport: only available on the server"));
+		return;
+	}
+
+	GM->GetRPCGuardComp()->LogReport();
+}
+
+static FAutoConsoleCommandWithWorld RPCGuardReportCmd(
+	TEXT("coop.RPCGuardReport"),
+	TEXT("Logs accepted and dropped server RPCs per connected player"),
+	FConsoleCommandWithWorldDelegate::CreateStatic(RPCGuardReport));
@@ -0,0 +1,455 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "SSoakTestComponent.h"
+#include "SGameMode.h"
+#include "SGameState.h"
+#include "SCharacter.h"
+#include "SFlowFieldComponent.h"
+#include "SGameplaySchedulerComponent.h"
+#include "CoopGame.h"
+#include "EngineUtils.h"
+#include "Engine/World.h"
+#include "GameFramework/Controller.h"
+#include "GameFramework/PlayerStart.h"
+#include "HAL/PlatformMemory.h"
+#include "Misc/App.h"
+#include "Misc/CommandLine.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "UObject/UObjectArray.h"
+
+// Seconds between defender aim and target updates
+static const float SoakDefenderUpdateInterval = 0.1f;
+
+
+static float GetFrameTimePercentile(const TArray<float>& SortedFrameTimes, float Fraction)
+{
+	return SortedFrameTimes.Num() > 0 ? SortedFrameTimes[FMath::Min(FMath::FloorToInt(Fraction * SortedFrameTimes.Num()), SortedFrameTimes.Num() - 1)] : 0.0f;
+}
+
+
+// Everything of a sample that is checked for growth, actor counts per class included
+static void GatherSoakMetrics(const FSSoakSample& Sample, float MemoryToleranceMB, float FrameTimeToleranceMs, TArray<FSSoakMetric>& OutMetrics)
+{
+	OutMetrics.Reset();
+	OutMetrics.Add({ TEXT("Actors"), (double)Sample.NumActors, 0.0 });
+	OutMetrics.Add({ TEXT("Objects"), (double)Sample.NumObjects, 0.0 });
+	OutMetrics.Add({ TEXT("ScheduledTimers"), (double)Sample.NumScheduledTimers, 0.0 });
+	OutMetrics.Add({ TEXT("UsedPhysicalMB"), Sample.UsedPhysicalMB, MemoryToleranceMB });
+	OutMetrics.Add({ TEXT("UsedVirtualMB"), Sample.UsedVirtualMB, MemoryToleranceMB });
+	OutMetrics.Add({ TEXT("AvgFrameMs"), (double)Sample.AvgFrameMs, FrameTimeToleranceMs });
+
+	for (const TPair<FName, int32>& Pair : Sample.ActorsPerClass)
+	{
+		OutMetrics.Add({ FString::Printf(TEXT("Actors.%s"), *Pair.Key.ToString()), (double)Pair.Value, 0.0 });
+	}
+}
+
+
+// Sets default values for this component's properties
+USSoakTestComponent::USSoakTestComponent()
+{
+	PrimaryComponentTick.bCanEverTick = true;
+
+	NumWaves = 300;
+	BotSpawnsPerWave = 6;
+	NumDefenders = 4;
+	DefenderRange = 3000.0f;
+	DefenderRespawnDelay = 5.0f;
+	SoakTickRate = 30.0f;
+	WarmupWaves = 10;
+	GrowthWaves = 20;
+	MemoryToleranceMB = 2.0f;
+	FrameTimeToleranceMs = 0.25f;
+
+	bSoaking = false;
+	WavesToRun = 0;
+	LastFrameRealTime = 0.0;
+	TimeToDefenderUpdate = 0.0f;
+}
+
+
+void USSoakTestComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	int32 SoakWaves = 0;
+	if (FParse::Value(FCommandLine::Get(), TEXT("CoopSoak="), SoakWaves) || FParse::Param(FCommandLine::Get(), TEXT("CoopSoak")))
+	{
+		StartSoak(SoakWaves > 0 ? SoakWaves : NumWaves);
+	}
+
+	if (!bSoaking)
+	{
+		SetComponentTickEnabled(false);
+	}
+}
+
+
+bool USSoakTestComponent::IsSoaking() const
+{
+	return bSoaking;
+}
+
+
+int32 USSoakTestComponent::GetBotSpawnsPerWave() const
+{
+	return BotSpawnsPerWave;
+}
+
+
+bool USSoakTestComponent::IsDefender(const APawn* Pawn) const
+{
+	for (const FSSoakDefender& Defender : Defenders)
+	{
+		if (Pawn && Defender.Character.Get() == Pawn)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+
+void USSoakTestComponent::StartSoak(int32 InNumWaves)
+{
+	ASGameMode* GM = Cast<ASGameMode>(GetOwner());
+	if (GM == nullptr || GM->DefaultPawnClass == nullptr || !GM->DefaultPawnClass->IsChildOf(ASCharacter::StaticClass()))
+	{
+		UE_LOG(LogTemp, Error, TEXT("Soak test needs SGameMode with an SCharacter default pawn for its defenders"));
+		return;
+	}
+
+	TArray<FTransform> StartTransforms;
+	for (TActorIterator<APlayerStart> It(GetWorld()); It; ++It)
+	{
+		StartTransforms.Add(It->GetActorTransform());
+	}
+
+	if (StartTransforms.Num() == 0)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Soak test needs a player start to spawn defenders at"));
+		return;
+	}
+
+	// Fixed steps so a long soak runs faster than real time and every run simulates the same
+	FApp::SetUseFixedTimeStep(true);
+	FApp::SetFixedDeltaTime(1.0 / SoakTickRate);
+
+	WavesToRun = InNumWaves;
+	bSoaking = true;
+
+	Defenders.SetNum(NumDefenders);
+	for (int32 i = 0; i < Defenders.Num(); i++)
+	{
+		Defenders[i].SpawnTransform = StartTransforms[i % StartTransforms.Num()];
+		SpawnDefender(Defenders[i]);
+	}
+
+	FString MapName = GetWorld()->GetMapName();
+	MapName.RemoveFromStart(GetWorld()->StreamingLevelsPrefix);
+
+	CSVPath = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("Soak"), FString::Printf(TEXT("Soak_%s_%s.csv"), *MapName, *FDateTime::Now().ToString()));
+	FFileHelper::SaveStringToFile(TEXT("Wave,GameTime,Metric,Value\n"), *CSVPath);
+
+	LastFrameRealTime = 0.0;
+
+	UE_LOG(LogTemp, Log, TEXT("Soak test on %s: %d waves of %d bot spawns against %d defenders at %.0f Hz, samples in %s"),
+		*MapName, WavesToRun, BotSpawnsPerWave, Defenders.Num(), SoakTickRate, *CSVPath);
+}
+
+
+void USSoakTestComponent::SpawnDefender(FSSoakDefender& Defender)
+{
+	ASGameMode* GM = Cast<ASGameMode>(GetOwner());
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
+
+	ASCharacter* Character = GetWorld()->SpawnActor<ASCharacter>(GM->DefaultPawnClass, Defender.SpawnTransform, SpawnParams);
+	if (Character == nullptr)
+	{
+		return;
+	}
+
+	Character->SpawnDefaultController();
+
+	// Bots chase defenders the way they chase players
+	USFlowFieldComponent* FlowField = GM->GetFlowFieldComp();
+	if (FlowField)
+	{
+		FlowField->AddExtraTarget(Character);
+	}
+
+	Defender.Character = Character;
+	Defender.RespawnTime = -1.0f;
+	Defender.bFiring = false;
+}
+
+
+void USSoakTestComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	// Real time, the game time step is fixed
+	const double Now = FPlatformTime::Seconds();
+	if (LastFrameRealTime > 0.0)
+	{
+		FrameTimes.Add((float)((Now - LastFrameRealTime) * 1000.0));
+	}
+	LastFrameRealTime = Now;
+
+	TimeToDefenderUpdate -= DeltaTime;
+	if (TimeToDefenderUpdate <= 0.0f)
+	{
+		TimeToDefenderUpdate = SoakDefenderUpdateInterval;
+		UpdateDefenders();
+	}
+}
+
+
+void USSoakTestComponent::UpdateDefenders()
+{
+	const float Now = GetWorld()->TimeSeconds;
+
+	for (FSSoakDefender& Defender : Defenders)
+	{
+		ASCharacter* Character = Defender.Character.Get();
+		if (Character == nullptr || Character->IsDead())
+		{
+			if (Defender.RespawnTime < 0.0f)
+			{
+				Defender.RespawnTime = Now + DefenderRespawnDelay;
+			}
+			else if (Now >= Defender.RespawnTime)
+			{
+				SpawnDefender(Defender);
+			}
+			continue;
+		}
+
+		ASCharacter* Target = FindDefenderTarget(Character);
+		if (Target && Character->GetController())
+		{
+			const FRotator AimRotation = (Target->GetActorLocation() - Character->GetPawnViewLocation()).Rotation();
+			Character->GetController()->SetControlRotation(AimRotation);
+			Character->SetActorRotation(FRotator(0.0f, AimRotation.Yaw, 0.0f));
+		}
+
+		const bool bWantsToFire = Target != nullptr;
+		if (bWantsToFire != Defender.bFiring)
+		{
+			Defender.bFiring = bWantsToFire;
+			if (bWantsToFire)
+			{
+				Character->StartFire();
+			}
+			else
+			{
+				Character->StopFire();
+			}
+		}
+	}
+}
+
+
+ASCharacter* USSoakTestComponent::FindDefenderTarget(ASCharacter* Defender) const
+{
+	const FVector DefenderLocation = Defender->GetActorLocation();
+
+	ASCharacter* NearestEnemy = nullptr;
+	float NearestDistSquared = FMath::Square(DefenderRange);
+
+	for (TActorIterator<ASCharacter> It(GetWorld()); It; ++It)
+	{
+		ASCharacter* Other = *It;
+		if (Other->IsDead() || Other->IsPooled() || Other->TeamNum == Defender->TeamNum)
+		{
+			continue;
+		}
+
+		const float DistSquared = FVector::DistSquared(DefenderLocation, Other->GetActorLocation());
+		if (DistSquared < NearestDistSquared)
+		{
+			NearestDistSquared = DistSquared;
+			NearestEnemy = Other;
+		}
+	}
+
+	// Only the nearest is traced, a defender without a clear shot waits for the bots to come round
+	if (NearestEnemy == nullptr || !Defender->GetController() || !Defender->GetController()->LineOfSightTo(NearestEnemy))
+	{
+		return nullptr;
+	}
+
+	return NearestEnemy;
+}
+
+
+void USSoakTestComponent::HandleWaveState(EWaveState NewState)
+{
+	if (!bSoaking || NewState != EWaveState::WaveComplete)
+	{
+		return;
+	}
+
+	TakeSample();
+	CheckGrowth();
+
+	if (Samples.Num() >= WavesToRun)
+	{
+		FinishSoak();
+	}
+}
+
+
+void USSoakTestComponent::TakeSample()
+{
+	FSSoakSample& Sample = Samples.AddDefaulted_GetRef();
+	Sample.Wave = Samples.Num();
+	Sample.GameTime = GetWorld()->TimeSeconds;
+
+	for (TActorIterator<AActor> It(GetWorld()); It; ++It)
+	{
+		Sample.NumActors++;
+		Sample.ActorsPerClass.FindOrAdd(It->GetClass()->GetFName())++;
+	}
+
+	Sample.NumObjects = GUObjectArray.GetObjectArrayNumMinusAvailable();
+
+	USGameplaySchedulerComponent* Scheduler = USGameplaySchedulerComponent::Get(this);
+	Sample.NumScheduledTimers = Scheduler ? Scheduler->GetNumScheduled() : 0;
+
+	const FPlatformMemoryStats MemoryStats = FPlatformMemory::GetStats();
+	Sample.UsedPhysicalMB = MemoryStats.UsedPhysical / (1024.0 * 1024.0);
+	Sample.UsedVirtualMB = MemoryStats.UsedVirtual / (1024.0 * 1024.0);
+
+	if (FrameTimes.Num() > 0)
+	{
+		float TotalFrameTime = 0.0f;
+		for (float FrameTime : FrameTimes)
+		{
+			TotalFrameTime += FrameTime;
+		}
+
+		FrameTimes.Sort();
+		Sample.AvgFrameMs = TotalFrameTime / FrameTimes.Num();
+		Sample.P95FrameMs = GetFrameTimePercentile(FrameTimes, 0.95f);
+		Sample.MaxFrameMs = GetFrameTimePercentile(FrameTimes, 1.0f);
+		FrameTimes.Reset();
+	}
+
+	UE_LOG(LogTemp, Log, TEXT("Soak wave %d/%d: %d actors, %d objects, %d timers, %.1f MB physical, %.1f MB virtual, frame ms avg %.2f p95 %.2f max %.2f"),
+		Sample.Wave, WavesToRun, Sample.NumActors, Sample.NumObjects, Sample.NumScheduledTimers, Sample.UsedPhysicalMB, Sample.UsedVirtualMB,
+		Sample.AvgFrameMs, Sample.P95FrameMs, Sample.MaxFrameMs);
+
+	AppendToCSV(Sample);
+}
+
+
+void USSoakTestComponent::CheckGrowth()
+{
+	const int32 FirstWave = Samples.Num() - GrowthWaves;
+	if (FirstWave < WarmupWaves)
+	{
+		return;
+	}
+
+	// Metrics of every sample in the window, a class missing from a sample had no actors
+	TArray<TMap<FString, double>> Window;
+	TArray<FSSoakMetric> Metrics;
+	for (int32 i = FirstWave; i < Samples.Num(); i++)
+	{
+		GatherSoakMetrics(Samples[i], MemoryToleranceMB, FrameTimeToleranceMs, Metrics);
+
+		TMap<FString, double>& Values = Window.AddDefaulted_GetRef();
+		for (const FSSoakMetric& Metric : Metrics)
+		{
+			Values.Add(Metric.Name, Metric.Value);
+		}
+	}
+
+	// Metrics now holds the latest sample's
+	for (const FSSoakMetric& Metric : Metrics)
+	{
+		if (GrowingMetrics.Contains(Metric.Name))
+		{
+			continue;
+		}
+
+		const double FirstValue = Window[0].FindRef(Metric.Name);
+		double Previous = FirstValue;
+		bool bNeverDropped = true;
+
+		for (int32 i = 1; i < Window.Num() && bNeverDropped; i++)
+		{
+			const double Value = Window[i].FindRef(Metric.Name);
+			bNeverDropped = Value >= Previous - Metric.Tolerance;
+			Previous = Value;
+		}
+
+		if (bNeverDropped && Metric.Value > FirstValue + Metric.Tolerance)
+		{
+			GrowingMetrics.Add(Metric.Name);
+			UE_LOG(LogTemp, Warning, TEXT("Soak: %s grew over the last %d waves without dropping, %.1f -> %.1f"), *Metric.Name, GrowthWaves, FirstValue, Metric.Value);
+		}
+	}
+}
+
+
+void USSoakTestComponent::AppendToCSV(const FSSoakSample& Sample) const
+{
+	TArray<FSSoakMetric> Metrics;
+	GatherSoakMetrics(Sample, 0.0f, 0.0f, Metrics);
+	Metrics.Add({ TEXT("P95FrameMs"), (double)Sample.P95FrameMs, 0.0 });
+	Metrics.Add({ TEXT("MaxFrameMs"), (double)Sample.MaxFrameMs, 0.0 });
+
+	FString Rows;
+	for (const FSSoakMetric& Metric : Metrics)
+	{
+		Rows += FString::Printf(TEXT("%d,%.1f,%s,%.2f\n"), Sample.Wave, Sample.GameTime, *Metric.Name, Metric.Value);
+	}
+
+	// Appended every wave so a soak that crashes still leaves its samples
+	FFileHelper::SaveStringToFile(Rows, *CSVPath, FFileHelper::EEncodingOptions::AutoDetect, &IFileManager::Get(), FILEWRITE_Append);
+}
+
+
+void USSoakTestComponent::FinishSoak()
+{
+	bSoaking = false;
+	SetComponentTickEnabled(false);
+
+	const FSSoakSample& First = Samples[FMath::Min(WarmupWaves, Samples.Num() - 1)];
+	const FSSoakSample& Last = Samples.Last();
+
+	FString Report = FString::Printf(
+		TEXT("Soak of %d waves, %.0f s of game time\n")
+		TEXT("After wave %d: %d actors, %d objects, %d timers, %.1f MB physical, %.1f MB virtual, frame ms avg %.2f\n")
+		TEXT("After wave %d: %d actors, %d objects, %d timers, %.1f MB physical, %.1f MB virtual, frame ms avg %.2f\n"),
+		Samples.Num(), Last.GameTime,
+		First.Wave, First.NumActors, First.NumObjects, First.NumScheduledTimers, First.UsedPhysicalMB, First.UsedVirtualMB, First.AvgFrameMs,
+		Last.Wave, Last.NumActors, Last.NumObjects, Last.NumScheduledTimers, Last.UsedPhysicalMB, Last.UsedVirtualMB, Last.AvgFrameMs);
+
+	if (GrowingMetrics.Num() == 0)
+	{
+		Report += TEXT("Nothing kept growing\n");
+	}
+	else
+	{
+		Report += FString::Printf(TEXT("Kept growing over %d waves:\n"), GrowthWaves);
+		for (const FString& MetricName : GrowingMetrics)
+		{
+			Report += FString::Printf(TEXT("  %s\n"), *MetricName);
+		}
+	}
+
+	UE_LOG(LogTemp, Log, TEXT("%s"), *Report);
+
+	const FString ReportPath = FPaths::ChangeExtension(CSVPath, TEXT("report.txt"));
+	FFileHelper::SaveStringToFile(Report, *ReportPath);
+
+	// Soaks are run from scripts, hand control back once done
+	FPlatformMisc::RequestExit(false);
+}
@@ -0,0 +1,223 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "STickRateComponent.h"
+#include "SGameMode.h"
+#include "SGameState.h"
+#include "SDamageQueueComponent.h"
+#include "CoopGame.h"
+#include "Engine/NetDriver.h"
+#include "Engine/World.h"
+#include "Misc/App.h"
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Server Tick Rate"), STAT_ServerTickRate, STATGROUP_CoopGame);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Server Tick Rate Reason"), STAT_ServerTickRateReason, STATGROUP_CoopGame);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Affordable Tick Rate"), STAT_AffordableTickRate, STATGROUP_CoopGame);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Game Thread Work (ms)"), STAT_GameThreadWork, STATGROUP_CoopGame);
+
+// Seconds between decisions
+static const float TickRateEvaluateInterval = 0.5f;
+
+
+// Sets default values for this component's properties
+USTickRateComponent::USTickRateComponent()
+{
+	PrimaryComponentTick.bCanEverTick = true;
+
+	IdleTickRate = 10;
+	CalmTickRate = 30;
+	CombatTickRate = 60;
+	MinTickRate = 15;
+	CombatHitsPerSecond = 20.0f;
+	CpuBudget = 0.6f;
+	RateDecreaseDelay = 3.0f;
+	WaveGameModeTickInterval = 0.5f;
+	IdleGameModeTickInterval = 2.0f;
+
+	CurrentTickRate = 0;
+	CurrentReason = ESTickRateReason::NoPlayers;
+	AverageWorkSeconds = 0.0f;
+	HitsPerSecond = 0.0f;
+	LastHitsResolved = 0;
+	TimeToEvaluate = 0.0f;
+	LowerRateWantedSince = -1.0f;
+}
+
+
+int32 USTickRateComponent::GetServerTickRate(const UObject* WorldContextObject)
+{
+	UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	ASGameMode* GM = World ? Cast<ASGameMode>(World->GetAuthGameMode()) : nullptr;
+	USTickRateComponent* TickRateComp = GM ? GM->GetTickRateComp() : nullptr;
+
+	// Only a dedicated server applies the rate, see ApplyTickRate
+	return TickRateComp && IsRunningDedicatedServer() ? TickRateComp->GetCurrentTickRate() : 0;
+}
+
+
+void USTickRateComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// Start from what the net driver was configured with
+	UNetDriver* NetDriver = GetWorld()->GetNetDriver();
+	CurrentTickRate = NetDriver ? NetDriver->NetServerMaxTickRate : CalmTickRate;
+	SET_DWORD_STAT(STAT_ServerTickRate, CurrentTickRate);
+}
+
+
+void USTickRateComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	// Frame time less the time spent waiting for the next tick
+	const float WorkSeconds = FMath::Max((float)(FApp::GetDeltaTime() - FApp::GetIdleTime()), 0.0f);
+	AverageWorkSeconds = AverageWorkSeconds > 0.0f ? FMath::Lerp(AverageWorkSeconds, WorkSeconds, 0.05f) : WorkSeconds;
+
+	TimeToEvaluate -= DeltaTime;
+	if (TimeToEvaluate > 0.0f)
+	{
+		return;
+	}
+
+	Evaluate(TickRateEvaluateInterval - TimeToEvaluate);
+	TimeToEvaluate = TickRateEvaluateInterval;
+}
+
+
+void USTickRateComponent::Evaluate(float ElapsedSeconds)
+{
+	ASGameMode* GM = Cast<ASGameMode>(GetOwner());
+	ASGameState* GS = GetWorld()->GetGameState<ASGameState>();
+	USDamageQueueComponent* DamageQueue = GM ? GM->GetDamageQueueComp() : nullptr;
+
+	if (DamageQueue)
+	{
+		const int32 HitsResolved = DamageQueue->GetNumHitsResolved();
+		const float RecentHitsPerSecond = (HitsResolved - LastHitsResolved) / FMath::Max(ElapsedSeconds, KINDA_SMALL_NUMBER);
+		HitsPerSecond = FMath::Lerp(HitsPerSecond, RecentHitsPerSecond, 0.5f);
+		LastHitsResolved = HitsResolved;
+	}
+
+	const EWaveState WaveState = GS ? GS->GetWaveState() : EWaveState::WaitingToStart;
+	const bool bInWave = WaveState == EWaveState::WaveInProgress || WaveState == EWaveState::WaitingToComplete;
+
+	float WantedRate;
+	ESTickRateReason WantedReason;
+	if (GM == nullptr || GM->GetNumPlayers() == 0)
+	{
+		WantedRate = IdleTickRate;
+		WantedReason = ESTickRateReason::NoPlayers;
+	}
+	else if (!bInWave)
+	{
+		WantedRate = IdleTickRate;
+		WantedReason = ESTickRateReason::BetweenWaves;
+	}
+	else
+	{
+		const float Intensity = FMath::Clamp(HitsPerSecond / CombatHitsPerSecond, 0.0f, 1.0f);
+		WantedRate = FMath::Lerp((float)CalmTickRate, (float)CombatTickRate, Intensity);
+		WantedReason = Intensity > 0.1f ? ESTickRateReason::Combat : ESTickRateReason::Calm;
+	}
+
+	// Frame cost hardly depends on the rate, so the budget buys a number of frames per second
+	const float AffordableRate = AverageWorkSeconds > 0.0f ? CpuBudget / AverageWorkSeconds : (float)CombatTickRate;
+	const float BudgetRate = FMath::Max(AffordableRate, (float)MinTickRate);
+	if (WantedRate > BudgetRate)
+	{
+		// Only ever lowers the rate, an idle rate under MinTickRate is kept
+		WantedRate = BudgetRate;
+		WantedReason = ESTickRateReason::CpuBudget;
+	}
+
+	SET_DWORD_STAT(STAT_AffordableTickRate, FMath::RoundToInt(AffordableRate));
+	SET_FLOAT_STAT(STAT_GameThreadWork, AverageWorkSeconds * 1000.0f);
+
+	if (GM)
+	{
+		GM->SetActorTickInterval(bInWave ? WaveGameModeTickInterval : IdleGameModeTickInterval);
+	}
+
+	const int32 NewTickRate = FMath::Max(FMath::RoundToInt(WantedRate), 1);
+	const float Now = GetWorld()->TimeSeconds;
+
+	if (NewTickRate >= CurrentTickRate)
+	{
+		LowerRateWantedSince = -1.0f;
+		ApplyTickRate(NewTickRate, WantedReason);
+		return;
+	}
+
+	// Hold a higher rate a little so short lulls in a fight don't make it flap
+	if (LowerRateWantedSince < 0.0f)
+	{
+		LowerRateWantedSince = Now;
+	}
+
+	if (Now - LowerRateWantedSince >= RateDecreaseDelay || WantedReason == ESTickRateReason::CpuBudget)
+	{
+		LowerRateWantedSince = -1.0f;
+		ApplyTickRate(NewTickRate, WantedReason);
+	}
+}
+
+
+void USTickRateComponent::ApplyTickRate(int32 NewTickRate, ESTickRateReason NewReason)
+{
+	SET_DWORD_STAT(STAT_ServerTickRate, NewTickRate);
+	SET_DWORD_STAT(STAT_ServerTickRateReason, (uint32)NewReason);
+
+	if (NewTickRate == CurrentTickRate && NewReason == CurrentReason)
+	{
+		return;
+	}
+
+	UE_LOG(LogTemp, Log, TEXT("Server tick rate %d -> %d (%s)"), CurrentTickRate, NewTickRate, *UEnum::GetValueAsString(NewReason));
+
+	CurrentTickRate = NewTickRate;
+	CurrentReason = NewReason;
+
+	// A listen server's rate is set by the host's own frame rate
+	UNetDriver* NetDriver = GetWorld()->GetNetDriver();
+	if (NetDriver && IsRunningDedicatedServer())
+	{
+		NetDriver->NetServerMaxTickRate = NewTickRate;
+	}
+}
+
+
+int32 USTickRateComponent::GetCurrentTickRate() const
+{
+	return CurrentTickRate;
+}
+
+
+ESTickRateReason USTickRateComponent::GetCurrentReason() const
+{
+	return CurrentReason;
+}
+
+
+void USTickRateComponent::LogReport() const
+{
+	UE_LOG(LogTemp, Log, TEXT("Server tick rate %d (%s), game thread %.2f ms per frame, %.1f damage hits per second"),
+		CurrentTickRate, *UEnum::GetValueAsString(CurrentReason), AverageWorkSeconds * 1000.0f, HitsPerSecond);
+}
+
+
+static void TickRateReport(UWorld* World)
+{
+	ASGameMode* GM = World ? Cast<ASGameMode>(World->GetAuthGameMode()) : nullptr;
+	if (GM == nullptr || GM->GetTickRateComp() == nullptr)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("coop.TickRateReport: only available on the server"));
+		return;
+	}
+
+	GM->GetTickRateComp()->LogReport();
+}
+
+static FAutoConsoleCommandWithWorld TickRateReportCmd(
+	TEXT("coop.TickRateReport"),
+	TEXT("Logs the server tick rate, why it was chosen and the load it was chosen for"),
+	FConsoleCommandWithWorldDelegate::CreateStatic(TickRateReport));
@@ -0,0 +1,325 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "SWeaponComponent.h"
+#include "SCharacter.h"
+#include "SRPCGuardComponent.h"
+#include "SGameplaySchedulerComponent.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "Engine/World.h"
+#include "GameFramework/GameStateBase.h"
+#include "Net/UnrealNetwork.h"
+
+
+// Sets default values for this component's properties
+USWeaponComponent::USWeaponComponent()
+{
+	SetIsReplicated(true);
+
+	Weapon = nullptr;
+
+	MaxAimUpdateRate = 20.0f;
+	MaxAimLocationError = 150.0f;
+	SentAimLocation = FVector::ZeroVector;
+	SentAimRotation = FRotator::ZeroRotator;
+	SentAimTime = -BIG_NUMBER;
+	ClientAimTime = -BIG_NUMBER;
+	TriggerDownTime = 0.0f;
+	TriggerArrivalTime = 0.0f;
+}
+
+
+void USWeaponComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (Weapon)
+	{
+		Weapon->Destroy();
+		Weapon = nullptr;
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+
+void USWeaponComponent::EquipWeapon(TSubclassOf<ASWeapon> NewWeaponClass)
+{
+	WeaponClass = NewWeaponClass;
+
+	SpawnWeapon();
+}
+
+
+void USWeaponComponent::OnRep_WeaponClass()
+{
+	SpawnWeapon();
+}
+
+
+void USWeaponComponent::SpawnWeapon()
+{
+	ASCharacter* MyCharacter = Cast<ASCharacter>(GetOwner());
+	if (MyCharacter == nullptr)
+	{
+		return;
+	}
+
+	if (Weapon)
+	{
+		Weapon->Destroy();
+		Weapon = nullptr;
+	}
+
+	if (WeaponClass)
+	{
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.Owner = MyCharacter;
+		SpawnParams.Instigator = MyCharacter;
+		SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+		Weapon = GetWorld()->SpawnActor<ASWeapon>(WeaponClass, FVector::ZeroVector, FRotator::ZeroRotator, SpawnParams);
+		if (Weapon)
+		{
+			Weapon->AttachToComponent(MyCharacter->GetMesh(), FAttachmentTransformRules::SnapToTargetNotIncludingScale, Weapon->ReturnWeaponSocketName(Weapon));
+		}
+	}
+
+	MyCharacter->SetCurrentWeapon(Weapon);
+}
+
+
+ASWeapon* USWeaponComponent::GetWeapon() const
+{
+	return Weapon;
+}
+
+
+void USWeaponComponent::SetHitScanTrace(const FVector& TraceTo, EPhysicalSurface SurfaceType)
+{
+	HitScanTrace.TraceTo = TraceTo;
+	HitScanTrace.SurfaceType = SurfaceType;
+	HitScanTrace.ShotCounter++;
+}
+
+
+void USWeaponComponent::SetMeleeSwing(int32 ComboStep)
+{
+	MeleeSwing.ComboStep = (uint8)ComboStep;
+	MeleeSwing.SwingCounter++;
+}
+
+
+void USWeaponComponent::OnRep_HitScanTrace()
+{
+	if (Weapon)
+	{
+		Weapon->OnRemoteHitScanShot(HitScanTrace);
+	}
+}
+
+
+void USWeaponComponent::OnRep_MeleeSwing()
+{
+	if (Weapon)
+	{
+		Weapon->OnRemoteMeleeSwing(MeleeSwing.ComboStep);
+	}
+}
+
+
+float USWeaponComponent::GetServerTime() const
+{
+	AGameStateBase* GS = GetWorld()->GetGameState();
+	return GS ? GS->GetServerWorldTimeSeconds() : GetWorld()->TimeSeconds;
+}
+
+
+void USWeaponComponent::SendTriggerPressed(const FVector& EyeLocation, const FRotator& EyeRotation)
+{
+	SentAimLocation = EyeLocation;
+	SentAimRotation = EyeRotation;
+	SentAimTime = GetWorld()->TimeSeconds;
+
+	ServerPressTrigger(GetServerTime(), EyeLocation, FRotator::CompressAxisToShort(EyeRotation.Pitch), FRotator::CompressAxisToShort(EyeRotation.Yaw));
+}
+
+
+void USWeaponComponent::SendTriggerReleased()
+{
+	ServerReleaseTrigger(GetServerTime());
+}
+
+
+void USWeaponComponent::SendShotAim(const FVector& EyeLocation, const FRotator& EyeRotation)
+{
+	const float Now = GetWorld()->TimeSeconds;
+	if (Now - SentAimTime < 1.0f / MaxAimUpdateRate)
+	{
+		return;
+	}
+
+	// Holding still costs nothing
+	if (EyeLocation.Equals(SentAimLocation, 1.0f) && EyeRotation.Equals(SentAimRotation, 0.1f))
+	{
+		return;
+	}
+
+	SentAimLocation = EyeLocation;
+	SentAimRotation = EyeRotation;
+	SentAimTime = Now;
+
+	ServerShotAim(EyeLocation, FRotator::CompressAxisToShort(EyeRotation.Pitch), FRotator::CompressAxisToShort(EyeRotation.Yaw));
+}
+
+
+bool USWeaponComponent::GetClientAim(FVector& OutEyeLocation, FRotator& OutEyeRotation) const
+{
+	// Stale aim from an earlier burst is worse than the pawn's current view
+	if (GetWorld()->TimeSeconds - ClientAimTime > 0.25f)
+	{
+		return false;
+	}
+
+	OutEyeLocation = ClientAimLocation;
+	OutEyeRotation = ClientAimRotation;
+	return true;
+}
+
+
+void USWeaponComponent::SetClientAim(const FVector_NetQuantize& EyeLocation, uint16 Pitch, uint16 Yaw)
+{
+	AActor* MyOwner = GetOwner();
+	if (MyOwner == nullptr)
+	{
+		return;
+	}
+
+	// The eye location is the trace origin, a client must not be able to shoot from somewhere its pawn isn't
+	FVector ServerEyeLocation;
+	FRotator ServerEyeRotation;
+	MyOwner->GetActorEyesViewPoint(ServerEyeLocation, ServerEyeRotation);
+
+	const FVector Offset = EyeLocation - ServerEyeLocation;
+	if (Offset.SizeSquared() > FMath::Square(MaxAimLocationError))
+	{
+		UE_LOG(LogTemp, Verbose, TEXT("%s sent an eye location %.0f units from its pawn, clamped"), *MyOwner->GetName(), Offset.Size());
+	}
+
+	ClientAimLocation = ServerEyeLocation + Offset.GetClampedToMaxSize(MaxAimLocationError);
+	ClientAimRotation = FRotator(FRotator::DecompressAxisFromShort(Pitch), FRotator::DecompressAxisFromShort(Yaw), 0.0f);
+	ClientAimTime = GetWorld()->TimeSeconds;
+}
+
+
+void USWeaponComponent::ServerPressTrigger_Implementation(float PressTime, FVector_NetQuantize EyeLocation, uint16 Pitch, uint16 Yaw)
+{
+	// Pressing can't fire faster than the weapon does, one press per shot is already more than a player manages
+	const float MaxPressesPerSecond = Weapon ? FMath::Max(1.0f / Weapon->GetTimeBetweenShots(), 2.0f) : 2.0f;
+	if (!USRPCGuardComponent::AllowRPC(this, GET_FUNCTION_NAME_CHECKED(USWeaponComponent, ServerPressTrigger), MaxPressesPerSecond))
+	{
+		return;
+	}
+
+	USGameplaySchedulerComponent* Scheduler = USGameplaySchedulerComponent::Get(this);
+	if (Scheduler)
+	{
+		Scheduler->Cancel(TimerHandle_TriggerRelease);
+	}
+
+	TriggerDownTime = PressTime;
+	TriggerArrivalTime = GetWorld()->TimeSeconds;
+
+	SetClientAim(EyeLocation, Pitch, Yaw);
+
+	if (Weapon)
+	{
+		Weapon->StartFire();
+	}
+}
+
+
+bool USWeaponComponent::ServerPressTrigger_Validate(float PressTime, FVector_NetQuantize EyeLocation, uint16 Pitch, uint16 Yaw)
+{
+	return FMath::IsFinite(PressTime);
+}
+
+
+void USWeaponComponent::ServerReleaseTrigger_Implementation(float ReleaseTime)
+{
+	// Never dropped, a lost release leaves the trigger held and the weapon firing. Over budget it is only charged, a flood still gets kicked
+	const float MaxReleasesPerSecond = Weapon ? FMath::Max(1.0f / Weapon->GetTimeBetweenShots(), 2.0f) : 2.0f;
+	const bool bWithinBudget = USRPCGuardComponent::AllowRPC(this, GET_FUNCTION_NAME_CHECKED(USWeaponComponent, ServerReleaseTrigger), MaxReleasesPerSecond);
+
+	// Hold the trigger on the server as long as the player held it, so both sides fire the same number of shots
+	const float HeldFor = FMath::Clamp(ReleaseTime - TriggerDownTime, 0.0f, 10.0f);
+	const float Remaining = TriggerArrivalTime + HeldFor - GetWorld()->TimeSeconds;
+
+	USGameplaySchedulerComponent* Scheduler = USGameplaySchedulerComponent::Get(this);
+	if (!bWithinBudget || Remaining <= 0.0f || Scheduler == nullptr)
+	{
+		ReleaseTrigger();
+	}
+	else
+	{
+		Scheduler->Schedule(TimerHandle_TriggerRelease, ESScheduleGroup::Weapon, Remaining, FSimpleDelegate::CreateUObject(this, &USWeaponComponent::ReleaseTrigger));
+	}
+}
+
+
+bool USWeaponComponent::ServerReleaseTrigger_Validate(float ReleaseTime)
+{
+	return FMath::IsFinite(ReleaseTime);
+}
+
+
+void USWeaponComponent::ReleaseTrigger()
+{
+	if (Weapon)
+	{
+		Weapon->StopFire();
+	}
+}
+
+
+void USWeaponComponent::ServerShotAim_Implementation(FVector_NetQuantize EyeLocation, uint16 Pitch, uint16 Yaw)
+{
+	// Some slack over the client's own throttle for packets that bunch up
+	if (!USRPCGuardComponent::AllowRPC(this, GET_FUNCTION_NAME_CHECKED(USWeaponComponent, ServerShotAim), MaxAimUpdateRate * 1.5f))
+	{
+		return;
+	}
+
+	SetClientAim(EyeLocation, Pitch, Yaw);
+}
+
+
+bool USWeaponComponent::ServerShotAim_Validate(FVector_NetQuantize EyeLocation, uint16 Pitch, uint16 Yaw)
+{
+	return true;
+}
+
+
+void USWeaponComponent::MultiCastProjectileSpawned_Implementation(const FSProjectileSpawn& SpawnInfo)
+{
+	if (Weapon)
+	{
+		Weapon->OnRemoteProjectileSpawned(SpawnInfo);
+	}
+}
+
+
+void USWeaponComponent::MultiCastProjectileImpact_Implementation(uint16 ProjectileId, FVector_NetQuantize ImpactPoint, uint8 SurfaceType)
+{
+	if (Weapon)
+	{
+		Weapon->OnRemoteProjectileImpact(ProjectileId, ImpactPoint, (EPhysicalSurface)SurfaceType);
+	}
+}
+
+
+void USWeaponComponent::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME(USWeaponComponent, WeaponClass);
+	DOREPLIFETIME_CONDITION(USWeaponComponent, HitScanTrace, COND_SkipOwner);
+	DOREPLIFETIME_CONDITION(USWeaponComponent, MeleeSwing, COND_SkipOwner);
+}
@@ -4,11 +4,20 @@
 #include "Camera/CameraComponent.h"
 #include "GameFramework/SpringArmComponent.h"
 #include "GameFramework/PawnMovementComponent.h"
+#include "GameFramework/CharacterMovementComponent.h"
 #include "Components/CapsuleComponent.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "PhysicalMaterials/PhysicalMaterial.h"
 #include "CoopGame.h"
 #include "SHealthComponent.h"
 #include "SWeapon.h"
+#include "SWeaponComponent.h"
+#include "SCompactMovementComponent.h"
+#include "SHitboxRigComponent.h"
+#include "SRPCGuardComponent.h"
 #include "Net/UnrealNetwork.h"
+#include "AIController.h"
+#include "BrainComponent.h"
 
 
 
@@ -24,15 +33,43 @@ ASCharacter::ASCharacter()
 
 	GetMovementComponent()->GetNavAgentPropertiesRef().bCanCrouch = true;
 
-	GetCapsuleComponent()->SetCollisionResponseToChannel(COLLISION_WEAPON, ECR_Ignore);
+	// Hitscan traces stop on the capsule first and are then refined against the mesh bodies
+	GetCapsuleComponent()->SetCollisionResponseToChannel(COLLISION_WEAPON, ECR_Block);
+	GetMesh()->SetCollisionResponseToChannel(COLLISION_WEAPON, ECR_Ignore);
+
+	// Pickups are found by the pickup grid, melee overlaps only need the capsule
+	GetMesh()->SetGenerateOverlapEvents(false);
+
+	HitZoneBones.Add("head", ESHitZone::Head);
+	HitZoneBones.Add("neck_01", ESHitZone::Head);
+	HitZoneBones.Add("upperarm_l", ESHitZone::Limb);
+	HitZoneBones.Add("lowerarm_l", ESHitZone::Limb);
+	HitZoneBones.Add("hand_l", ESHitZone::Limb);
+	HitZoneBones.Add("upperarm_r", ESHitZone::Limb);
+	HitZoneBones.Add("lowerarm_r", ESHitZone::Limb);
+	HitZoneBones.Add("hand_r", ESHitZone::Limb);
+	HitZoneBones.Add("thigh_l", ESHitZone::Limb);
+	HitZoneBones.Add("calf_l", ESHitZone::Limb);
+	HitZoneBones.Add("foot_l", ESHitZone::Limb);
+	HitZoneBones.Add("thigh_r", ESHitZone::Limb);
+	HitZoneBones.Add("calf_r", ESHitZone::Limb);
+	HitZoneBones.Add("foot_r", ESHitZone::Limb);
 
 	HealthComp = CreateDefaultSubobject<USHealthComponent>(TEXT("HealthComp"));
 
+	WeaponComp = CreateDefaultSubobject<USWeaponComponent>(TEXT("WeaponComp"));
+
+	CompactMovementComp = CreateDefaultSubobject<USCompactMovementComponent>(TEXT("CompactMovementComp"));
+
+	HitboxRigComp = CreateDefaultSubobject<USHitboxRigComponent>(TEXT("HitboxRigComp"));
+
 	CameraComp = CreateDefaultSubobject<UCameraComponent>(TEXT("CameraComp"));
 	CameraComp->SetupAttachment(SpringArmComp);
 
 	ZoomedFOV = 65.0f;
 	ZoomInterpSpeed = 20;
+
+	bPooled = false;
 }
 
 // Called when the game starts or when spawned
@@ -46,16 +83,14 @@ void ASCharacter::BeginPlay()
 
 	if (GetLocalRole() == ROLE_Authority)
 	{
-		// Spawn a default weapon
-		FActorSpawnParameters SpawnParams;
-		SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+		// Spawn a default weapon, clients spawn their own copy when the class replicates
+		WeaponComp->EquipWeapon(StarterWeaponClass);
 
-		CurrentWeapon = GetWorld()->SpawnActor<ASWeapon>(StarterWeaponClass, FVector::ZeroVector, FRotator::ZeroRotator, SpawnParams);
-		if (CurrentWeapon)
+		// Weapon traces hit the rig, so a dedicated server only needs montages to advance, not the pose
+		HitboxRigComp->BuildFromMesh(GetMesh(), HitZoneBones);
+		if (IsRunningDedicatedServer() && HitboxRigComp->HasHitboxes())
 		{
-			FName wepSocketName = CurrentWeapon->ReturnWeaponSocketName(CurrentWeapon);
-			CurrentWeapon->SetOwner(this);
-			CurrentWeapon->AttachToComponent(GetMesh(), FAttachmentTransformRules::SnapToTargetNotIncludingScale, wepSocketName);
+			GetMesh()->VisibilityBasedAnimTickOption = EVisibilityBasedAnimTickOption::OnlyTickMontagesWhenNotRendered;
 		}
 	}
 }
@@ -86,6 +121,11 @@ void ASCharacter::EndCrouch()
 
 void ASCharacter::ServerBeginZoom_Implementation()
 {
+	if (!USRPCGuardComponent::AllowRPC(this, GET_FUNCTION_NAME_CHECKED(ASCharacter, ServerBeginZoom), 10.0f))
+	{
+		return;
+	}
+
 	BeginZoom();
 }
 
@@ -96,6 +136,9 @@ bool ASCharacter::ServerBeginZoom_Validate()
 
 void ASCharacter::ServerEndZoom_Implementation()
 {
+	// Never dropped, a lost end leaves the server zoomed in. Over budget it is only charged, a flood still gets kicked
+	USRPCGuardComponent::AllowRPC(this, GET_FUNCTION_NAME_CHECKED(ASCharacter, ServerEndZoom), 10.0f);
+
 	EndZoom();
 }
 
@@ -160,13 +203,16 @@ void ASCharacter::OnHealthChanged(USHealthComponent* OwningHealthComp, float Hea
 
 		GetMovementComponent()->StopMovementImmediately();
 		GetCapsuleComponent()->SetCollisionEnabled(ECollisionEnabled::NoCollision);
-		CurrentWeapon->SetActorEnableCollision(false);
-		CurrentWeapon->StopFire();
+		if (CurrentWeapon)
+		{
+			CurrentWeapon->SetActorEnableCollision(false);
+			CurrentWeapon->StopFire();
+		}
 
 		DetachFromControllerPendingDestroy();
 
+		// WeaponComp destroys the weapon along with the character
 		SetLifeSpan(10.0f);
-		CurrentWeapon->SetLifeSpan(10.0f);		
 	}
 }
 
@@ -218,11 +264,16 @@ FVector ASCharacter::GetPawnViewLocation() const
 }
 
 
+float ASCharacter::GetNetPriority(const FVector& ViewPos, const FVector& ViewDir, AActor* Viewer, AActor* ViewTarget, UActorChannel* InChannel, float Time, bool bLowBandwidth)
+{
+	return Super::GetNetPriority(ViewPos, ViewDir, Viewer, ViewTarget, InChannel, Time, bLowBandwidth) * CompactMovementComp->GetNetPriorityScale(ViewPos);
+}
+
+
 void ASCharacter::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
 {
 	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
 
-	DOREPLIFETIME(ASCharacter, CurrentWeapon);
 	DOREPLIFETIME(ASCharacter, bDied);
 	DOREPLIFETIME(ASCharacter, bAttacked);
 	DOREPLIFETIME(ASCharacter, bWantsToZoom);
@@ -231,4 +282,98 @@ void ASCharacter::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifet
 ASWeapon* ASCharacter::GetCurrentWeapon()
 {
 	return this->CurrentWeapon;
+}
+
+void ASCharacter::SetCurrentWeapon(ASWeapon* NewWeapon)
+{
+	CurrentWeapon = NewWeapon;
+}
+
+USHealthComponent* ASCharacter::GetHealthComp() const
+{
+	return HealthComp;
+}
+
+bool ASCharacter::IsDead() const
+{
+	return bDied;
+}
+
+void ASCharacter::SetPooled(bool bNewPooled)
+{
+	if (bPooled == bNewPooled)
+	{
+		return;
+	}
+
+	bPooled = bNewPooled;
+
+	if (bPooled)
+	{
+		StopFire();
+		GetCharacterMovement()->StopMovementImmediately();
+	}
+
+	// Hidden with collision off makes the actor irrelevant, clients close its channel
+	SetActorHiddenInGame(bPooled);
+	SetActorEnableCollision(!bPooled);
+	SetActorTickEnabled(!bPooled);
+	GetCharacterMovement()->SetComponentTickEnabled(!bPooled);
+	GetMesh()->SetComponentTickEnabled(!bPooled);
+
+	if (CurrentWeapon)
+	{
+		CurrentWeapon->SetActorHiddenInGame(bPooled);
+		CurrentWeapon->SetActorEnableCollision(!bPooled);
+	}
+
+	AAIController* AIC = Cast<AAIController>(GetController());
+	UBrainComponent* Brain = AIC ? AIC->GetBrainComponent() : nullptr;
+	if (Brain)
+	{
+		if (bPooled)
+		{
+			AIC->StopMovement();
+			Brain->StopLogic(TEXT("Pooled"));
+		}
+		else
+		{
+			Brain->RestartLogic();
+		}
+	}
+}
+
+bool ASCharacter::IsPooled() const
+{
+	return bPooled;
+}
+
+bool ASCharacter::TraceHitZone(const FVector& TraceStart, const FVector& TraceEnd, FHitResult& OutHit, ESHitZone& OutZone) const
+{
+	if (HitboxRigComp->HasHitboxes())
+	{
+		return HitboxRigComp->LineTrace(TraceStart, TraceEnd, OutHit, OutZone);
+	}
+
+	FCollisionQueryParams QueryParams;
+	QueryParams.bTraceComplex = false;
+	QueryParams.bReturnPhysicalMaterial = true;
+
+	// Only this mesh's bodies are tested, the rest of the level is already resolved by the capsule trace
+	if (!GetMesh()->LineTraceComponent(OutHit, TraceStart, TraceEnd, QueryParams))
+	{
+		return false;
+	}
+
+	const ESHitZone* BoneZone = HitZoneBones.Find(OutHit.BoneName);
+	if (BoneZone)
+	{
+		OutZone = *BoneZone;
+	}
+	else
+	{
+		OutZone = UPhysicalMaterial::DetermineSurfaceType(OutHit.PhysMaterial.Get()) == SURFACE_FLESHVULNERABLE ? ESHitZone::Head : ESHitZone::Body;
+	}
+
+	return true;
 }
\ No newline at end of file
@@ -4,16 +4,53 @@
 #include "SHealthComponent.h"
 #include "SGameState.h"
 #include "SPlayerState.h"
-#include "TimerManager.h"
+#include "SFlowFieldComponent.h"
+#include "SDamageQueueComponent.h"
+#include "SMatchRecorderComponent.h"
+#include "SHordeComponent.h"
+#include "SRPCGuardComponent.h"
+#include "SPickupGridComponent.h"
+#include "STickRateComponent.h"
+#include "SNetCostComponent.h"
+#include "SSoakTestComponent.h"
+#include "SGameplaySchedulerComponent.h"
+#include "SCharacter.h"
+#include "SLevelBakeData.h"
+#include "SLevelStreamerComponent.h"
+#include "EngineUtils.h"
+#include "HAL/PlatformMemory.h"
 
 
 ASGameMode::ASGameMode()
 {
 	TimeBetweenWaves = 2.0f;
+	MinBotSpawnDistance = 1500.0f;
+	HordeGroupSize = 8;
+
+	StartPlayTime = 0.0;
+	bFirstWaveStarted = false;
 
 	GameStateClass = ASGameState::StaticClass();
 	PlayerStateClass = ASPlayerState::StaticClass();
 
+	FlowFieldComp = CreateDefaultSubobject<USFlowFieldComponent>(TEXT("FlowFieldComp"));
+
+	DamageQueueComp = CreateDefaultSubobject<USDamageQueueComponent>(TEXT("DamageQueueComp"));
+
+	MatchRecorderComp = CreateDefaultSubobject<USMatchRecorderComponent>(TEXT("MatchRecorderComp"));
+
+	HordeComp = CreateDefaultSubobject<USHordeComponent>(TEXT("HordeComp"));
+
+	RPCGuardComp = CreateDefaultSubobject<USRPCGuardComponent>(TEXT("RPCGuardComp"));
+
+	PickupGridComp = CreateDefaultSubobject<USPickupGridComponent>(TEXT("PickupGridComp"));
+
+	TickRateComp = CreateDefaultSubobject<USTickRateComponent>(TEXT("TickRateComp"));
+
+	NetCostComp = CreateDefaultSubobject<USNetCostComponent>(TEXT("NetCostComp"));
+
+	SoakTestComp = CreateDefaultSubobject<USSoakTestComponent>(TEXT("SoakTestComp"));
+
 	PrimaryActorTick.bCanEverTick = true;
 	PrimaryActorTick.TickInterval = 1.0f;
 }
@@ -21,11 +58,34 @@ ASGameMode::ASGameMode()
 
 void ASGameMode::StartWave()
 {
+	// Server relevant sublevels carry gameplay collision, don't spawn bots into a map that is still streaming
+	ASGameState* GS = GetGameState<ASGameState>();
+	USLevelStreamerComponent* LevelStreamer = GS ? GS->GetLevelStreamer() : nullptr;
+	USGameplaySchedulerComponent* Scheduler = USGameplaySchedulerComponent::Get(this);
+	if (LevelStreamer && !LevelStreamer->IsStreamingComplete() && Scheduler)
+	{
+		Scheduler->Schedule(TimerHandle_NextWaveStart, ESScheduleGroup::Wave, 0.5f, FSimpleDelegate::CreateUObject(this, &ASGameMode::StartWave));
+		return;
+	}
+
+	if (!bFirstWaveStarted)
+	{
+		bFirstWaveStarted = true;
+
+		const FPlatformMemoryStats MemoryStats = FPlatformMemory::GetStats();
+		UE_LOG(LogTemp, Log, TEXT("First wave after %.2fs from launch, %.2fs from StartPlay, peak memory %.1f MB"),
+			FPlatformTime::Seconds() - GStartTime, FPlatformTime::Seconds() - StartPlayTime, MemoryStats.PeakUsedPhysical / (1024.0 * 1024.0));
+	}
+
 	WaveCount++;
 
-	NrOfBotsToSpawn = 2 * WaveCount;
+	// Soak waves stay the same size so growth points at leaks
+	NrOfBotsToSpawn = SoakTestComp->IsSoaking() ? SoakTestComp->GetBotSpawnsPerWave() : 2 * WaveCount;
 
-	GetWorldTimerManager().SetTimer(TimerHandle_BotSpawner, this, &ASGameMode::SpawnBotTimerElapsed, 1.0f, true, 0.0f);
+	if (ensureAlways(Scheduler))
+	{
+		Scheduler->Schedule(TimerHandle_BotSpawner, ESScheduleGroup::Wave, 0.0f, FSimpleDelegate::CreateUObject(this, &ASGameMode::SpawnBotTimerElapsed), 1.0f);
+	}
 
 	SetWaveState(EWaveState::WaveInProgress);
 }
@@ -33,7 +93,11 @@ void ASGameMode::StartWave()
 
 void ASGameMode::EndWave()
 {
-	GetWorldTimerManager().ClearTimer(TimerHandle_BotSpawner);
+	USGameplaySchedulerComponent* Scheduler = USGameplaySchedulerComponent::Get(this);
+	if (Scheduler)
+	{
+		Scheduler->Cancel(TimerHandle_BotSpawner);
+	}
 
 	SetWaveState(EWaveState::WaitingToComplete);
 }
@@ -41,7 +105,11 @@ void ASGameMode::EndWave()
 
 void ASGameMode::PrepareForNextWave()
 {
-	GetWorldTimerManager().SetTimer(TimerHandle_NextWaveStart, this, &ASGameMode::StartWave, TimeBetweenWaves, false);
+	USGameplaySchedulerComponent* Scheduler = USGameplaySchedulerComponent::Get(this);
+	if (ensureAlways(Scheduler))
+	{
+		Scheduler->Schedule(TimerHandle_NextWaveStart, ESScheduleGroup::Wave, TimeBetweenWaves, FSimpleDelegate::CreateUObject(this, &ASGameMode::StartWave));
+	}
 
 	SetWaveState(EWaveState::WaitingToStart);
 
@@ -51,19 +119,27 @@ void ASGameMode::PrepareForNextWave()
 
 void ASGameMode::CheckWaveState()
 {
-	bool bIsPreparingForWave = GetWorldTimerManager().IsTimerActive(TimerHandle_NextWaveStart);
+	USGameplaySchedulerComponent* Scheduler = USGameplaySchedulerComponent::Get(this);
+	bool bIsPreparingForWave = Scheduler && Scheduler->IsScheduled(TimerHandle_NextWaveStart);
 
 	if (NrOfBotsToSpawn > 0 || bIsPreparingForWave)
 	{
 		return;
 	}
 
-	bool bIsAnyBotAlive = false;
+	bool bIsAnyBotAlive = HordeComp->GetNumAgents() > 0;
 
 	for (FConstPawnIterator It = GetWorld()->GetPawnIterator(); It; ++It)
 	{
 		APawn* TestPawn = It->Get();
-		if (TestPawn == nullptr || TestPawn->IsPlayerControlled())
+		if (TestPawn == nullptr || TestPawn->IsPlayerControlled() || SoakTestComp->IsDefender(TestPawn))
+		{
+			continue;
+		}
+
+		// Pooled horde characters are parked, not alive
+		ASCharacter* TestCharacter = Cast<ASCharacter>(TestPawn);
+		if (TestCharacter && TestCharacter->IsPooled())
 		{
 			continue;
 		}
@@ -121,6 +197,9 @@ void ASGameMode::GameOver()
 
 void ASGameMode::SetWaveState(EWaveState NewState)
 {
+	MatchRecorderComp->RecordWaveState(NewState);
+	SoakTestComp->HandleWaveState(NewState);
+
 	ASGameState* GS = GetGameState<ASGameState>();
 	if (ensureAlways(GS))
 	{
@@ -146,6 +225,20 @@ void ASGameMode::StartPlay()
 {
 	Super::StartPlay();
 
+	StartPlayTime = FPlatformTime::Seconds();
+
+	for (TActorIterator<ASLevelBakeData> It(GetWorld()); It; ++It)
+	{
+		LevelBakeData = *It;
+		break;
+	}
+
+	// A replay drives the waves from its log
+	if (MatchRecorderComp->IsReplaying())
+	{
+		return;
+	}
+
 	PrepareForNextWave();
 }
 
@@ -154,13 +247,85 @@ void ASGameMode::Tick(float DeltaSeconds)
 {
 	Super::Tick(DeltaSeconds);
 
+	if (MatchRecorderComp->IsReplaying())
+	{
+		return;
+	}
+
 	CheckWaveState();
-	CheckAnyPlayerAlive();
+
+	// Soak defenders are respawned rather than ending the match
+	if (!SoakTestComp->IsSoaking())
+	{
+		CheckAnyPlayerAlive();
+	}
+}
+
+bool ASGameMode::GetBakedBotSpawnPoint(FVector& OutLocation) const
+{
+	return LevelBakeData.IsValid() && LevelBakeData->GetBotSpawnPoint(MinBotSpawnDistance, OutLocation);
+}
+
+USFlowFieldComponent* ASGameMode::GetFlowFieldComp() const
+{
+	return FlowFieldComp;
+}
+
+USDamageQueueComponent* ASGameMode::GetDamageQueueComp() const
+{
+	return DamageQueueComp;
+}
+
+USMatchRecorderComponent* ASGameMode::GetMatchRecorderComp() const
+{
+	return MatchRecorderComp;
+}
+
+USHordeComponent* ASGameMode::GetHordeComp() const
+{
+	return HordeComp;
+}
+
+USRPCGuardComponent* ASGameMode::GetRPCGuardComp() const
+{
+	return RPCGuardComp;
+}
+
+USPickupGridComponent* ASGameMode::GetPickupGridComp() const
+{
+	return PickupGridComp;
+}
+
+USTickRateComponent* ASGameMode::GetTickRateComp() const
+{
+	return TickRateComp;
+}
+
+USNetCostComponent* ASGameMode::GetNetCostComp() const
+{
+	return NetCostComp;
+}
+
+USSoakTestComponent* ASGameMode::GetSoakTestComp() const
+{
+	return SoakTestComp;
+}
+
+void ASGameMode::ReplayBotSpawn()
+{
+	SpawnBotGroup();
+}
+
+void ASGameMode::ReplayWaveState(EWaveState NewState)
+{
+	SetWaveState(NewState);
 }
 
 void ASGameMode::SpawnBotTimerElapsed()
 {
-	SpawnNewBot();
+	MatchRecorderComp->RecordBotSpawn();
+
+	SpawnBotGroup();
 
 	NrOfBotsToSpawn--;
 
@@ -169,3 +334,16 @@ void ASGameMode::SpawnBotTimerElapsed()
 		EndWave();
 	}
 }
+
+
+void ASGameMode::SpawnBotGroup()
+{
+	FVector SpawnLocation;
+	if (HordeComp->IsHordeEnabled() && GetBakedBotSpawnPoint(SpawnLocation))
+	{
+		HordeComp->SpawnAgents(SpawnLocation, HordeGroupSize);
+		return;
+	}
+
+	SpawnNewBot();
+}
@@ -1,9 +1,106 @@
 // Fill out your copyright notice in the Description page of Project Settings.
 
 #include "SGameState.h"
+#include "SFXManagerComponent.h"
+#include "SFireSchedulerComponent.h"
+#include "SLevelStreamerComponent.h"
+#include "SGameplaySchedulerComponent.h"
+#include "SGameMode.h"
+#include "GameFramework/Pawn.h"
+#include "GameFramework/PlayerState.h"
+#include "GameFramework/Controller.h"
 #include "Net/UnrealNetwork.h"
 
+ASGameState::ASGameState()
+{
+	FXManagerComp = CreateDefaultSubobject<USFXManagerComponent>(TEXT("FXManagerComp"));
+
+	FireSchedulerComp = CreateDefaultSubobject<USFireSchedulerComponent>(TEXT("FireSchedulerComp"));
+
+	LevelStreamerComp = CreateDefaultSubobject<USLevelStreamerComponent>(TEXT("LevelStreamerComp"));
+
+	GameplaySchedulerComp = CreateDefaultSubobject<USGameplaySchedulerComponent>(TEXT("GameplaySchedulerComp"));
+}
+
+
+void ASGameState::PostInitializeComponents()
+{
+	Super::PostInitializeComponents();
+
+	// Not in the constructor, spawning copies the Blueprint archetype's scoreboard over it
+	Scoreboard.OwnerGameState = this;
+}
+
+
+void ASGameState::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (GetLocalRole() == ROLE_Authority)
+	{
+		ASGameMode* GM = GetWorld()->GetAuthGameMode<ASGameMode>();
+		if (GM)
+		{
+			GM->OnActorKilled.AddDynamic(this, &ASGameState::HandleActorKilled);
+		}
+	}
+}
+
+
+void ASGameState::HandleActorKilled(AActor* VictimActor, AActor* KillerActor, AController* KillerController)
+{
+	APawn* VictimPawn = Cast<APawn>(VictimActor);
+	APlayerState* VictimPS = VictimPawn ? VictimPawn->GetPlayerState() : nullptr;
+	APlayerState* KillerPS = KillerController ? KillerController->PlayerState : nullptr;
+
+	// Bots have no player state and don't get a row
+	Scoreboard.AddDeath(VictimPS);
+
+	if (KillerPS != VictimPS)
+	{
+		Scoreboard.AddKill(KillerPS);
+	}
+}
+
+
+void ASGameState::AddPlayerState(APlayerState* PlayerState)
+{
+	Super::AddPlayerState(PlayerState);
+
+	if (GetLocalRole() == ROLE_Authority && PlayerState && !PlayerState->IsInactive())
+	{
+		Scoreboard.AddPlayer(PlayerState);
+	}
+}
+
 
+void ASGameState::RemovePlayerState(APlayerState* PlayerState)
+{
+	if (GetLocalRole() == ROLE_Authority)
+	{
+		Scoreboard.RemovePlayer(PlayerState);
+	}
+
+	Super::RemovePlayerState(PlayerState);
+}
+
+
+const FSScoreboard& ASGameState::GetScoreboard() const
+{
+	return Scoreboard;
+}
+
+
+void ASGameState::RecordScore(APlayerState* PlayerState, float ScoreDelta)
+{
+	Scoreboard.AddScore(PlayerState, ScoreDelta);
+}
+
+
+void ASGameState::RecordDamage(AController* InstigatedBy, float Damage)
+{
+	Scoreboard.AddDamage(InstigatedBy ? InstigatedBy->PlayerState : nullptr, Damage);
+}
 
 
 void ASGameState::OnRep_WaveState(EWaveState OldState)
@@ -24,9 +121,36 @@ void ASGameState::SetWaveState(EWaveState NewState)
 	}
 }
 
+EWaveState ASGameState::GetWaveState() const
+{
+	return WaveState;
+}
+
+USFXManagerComponent* ASGameState::GetFXManager() const
+{
+	return FXManagerComp;
+}
+
+USFireSchedulerComponent* ASGameState::GetFireScheduler() const
+{
+	return FireSchedulerComp;
+}
+
+USGameplaySchedulerComponent* ASGameState::GetGameplayScheduler() const
+{
+	return GameplaySchedulerComp;
+}
+
+
+USLevelStreamerComponent* ASGameState::GetLevelStreamer() const
+{
+	return LevelStreamerComp;
+}
+
 void ASGameState::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
 {
 	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
 
 	DOREPLIFETIME(ASGameState, WaveState);
+	DOREPLIFETIME(ASGameState, Scoreboard);
 }
\ No newline at end of file
@@ -0,0 +1,130 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "SLevelBakeData.h"
+#include "NavigationSystem.h"
+#include "Components/SceneComponent.h"
+#include "GameFramework/PlayerController.h"
+#include "Engine/World.h"
+
+
+// Sets default values
+ASLevelBakeData::ASLevelBakeData()
+{
+	RootComponent = CreateDefaultSubobject<USceneComponent>(TEXT("RootComp"));
+
+	SpawnPointRadius = 10000.0f;
+	NumSpawnPoints = 64;
+	MinSpawnPointSpacing = 300.0f;
+	FlowFieldCellSize = 100.0f;
+	FlowFieldMaxCellsPerAxis = 256;
+	FlowFieldMaxStepHeight = 60.0f;
+	bBakeOnSave = true;
+
+	// Only the server spawns bots and builds flow fields
+	bNetLoadOnClient = false;
+}
+
+
+#if WITH_EDITOR
+void ASLevelBakeData::PreSave(const class ITargetPlatform* TargetPlatform)
+{
+	Super::PreSave(TargetPlatform);
+
+	if (bBakeOnSave)
+	{
+		Bake();
+	}
+}
+#endif
+
+
+void ASLevelBakeData::Bake()
+{
+	UWorld* World = GetWorld();
+	UNavigationSystemV1* NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(World);
+	if (NavSys == nullptr)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("%s: no navigation system, keeping the previous bake"), *GetName());
+		return;
+	}
+
+	FSFlowFieldGrid NewGrid;
+	if (!USFlowFieldComponent::BuildGridData(World, FlowFieldCellSize, FlowFieldMaxCellsPerAxis, FlowFieldMaxStepHeight, NewGrid))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("%s: no navmesh, keeping the previous bake"), *GetName());
+		return;
+	}
+
+	TArray<FVector> NewSpawnPoints;
+	const int32 MaxAttempts = NumSpawnPoints * 8;
+	for (int32 Attempt = 0; Attempt < MaxAttempts && NewSpawnPoints.Num() < NumSpawnPoints; Attempt++)
+	{
+		FNavLocation NavLocation;
+		if (!NavSys->GetRandomReachablePointInRadius(GetActorLocation(), SpawnPointRadius, NavLocation))
+		{
+			continue;
+		}
+
+		const bool bTooClose = NewSpawnPoints.ContainsByPredicate([&](const FVector& Point)
+		{
+			return FVector::DistSquared(Point, NavLocation.Location) < FMath::Square(MinSpawnPointSpacing);
+		});
+
+		if (!bTooClose)
+		{
+			NewSpawnPoints.Add(NavLocation.Location);
+		}
+	}
+
+	FlowFieldGrid = MoveTemp(NewGrid);
+	BotSpawnPoints = MoveTemp(NewSpawnPoints);
+
+	UE_LOG(LogTemp, Log, TEXT("%s baked %d bot spawn points and a %dx%d flow field grid"), *GetName(), BotSpawnPoints.Num(), FlowFieldGrid.NumCellsX, FlowFieldGrid.NumCellsY);
+}
+
+
+const FSFlowFieldGrid& ASLevelBakeData::GetFlowFieldGrid() const
+{
+	return FlowFieldGrid;
+}
+
+
+bool ASLevelBakeData::GetBotSpawnPoint(float MinDistanceToPlayers, FVector& OutLocation) const
+{
+	if (BotSpawnPoints.Num() == 0)
+	{
+		return false;
+	}
+
+	TArray<FVector, TInlineAllocator<8>> PlayerLocations;
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		APlayerController* PC = It->Get();
+		if (PC && PC->GetPawn())
+		{
+			PlayerLocations.Add(PC->GetPawn()->GetActorLocation());
+		}
+	}
+
+	// Walk the points from a random start so bots don't always pick the same one
+	const int32 StartIndex = FMath::RandHelper(BotSpawnPoints.Num());
+	for (int32 i = 0; i < BotSpawnPoints.Num(); i++)
+	{
+		const FVector& Point = BotSpawnPoints[(StartIndex + i) % BotSpawnPoints.Num()];
+
+		const bool bNearPlayer = PlayerLocations.ContainsByPredicate([&](const FVector& PlayerLocation)
+		{
+			return FVector::DistSquared(Point, PlayerLocation) < FMath::Square(MinDistanceToPlayers);
+		});
+
+		if (!bNearPlayer)
+		{
+			OutLocation = Point;
+			return true;
+		}
+	}
+
+	// Everything is near a player, better to spawn close than not at all
+	OutLocation = BotSpawnPoints[StartIndex];
+	return true;
+}
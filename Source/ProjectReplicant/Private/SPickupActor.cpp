@@ -4,7 +4,8 @@
 #include "Components/SphereComponent.h"
 #include "Components/DecalComponent.h"
 #include "SPowerupActor.h"
-#include "TimerManager.h"
+#include "SPickupGridComponent.h"
+#include "SGameplaySchedulerComponent.h"
 
 
 // Sets default values
@@ -12,6 +13,9 @@ ASPickupActor::ASPickupActor()
 {
 	SphereComp = CreateDefaultSubobject<USphereComponent>(TEXT("SphereComp"));
 	SphereComp->SetSphereRadius(75.0f);
+	// Reach is tested by the pickup grid, the sphere only marks the radius
+	SphereComp->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	SphereComp->SetGenerateOverlapEvents(false);
 	RootComponent = SphereComp;
 
 	DecalComp = CreateDefaultSubobject<UDecalComponent>(TEXT("DecalComp"));
@@ -32,7 +36,38 @@ void ASPickupActor::BeginPlay()
 	if (Role == ROLE_Authority)
 	{
 		Respawn();
+
+		USPickupGridComponent* PickupGrid = USPickupGridComponent::Get(this);
+		if (PickupGrid)
+		{
+			PickupGrid->RegisterPickup(this);
+		}
+	}
+}
+
+
+void ASPickupActor::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	USPickupGridComponent* PickupGrid = USPickupGridComponent::Get(this);
+	if (PickupGrid)
+	{
+		PickupGrid->UnregisterPickup(this);
+	}
+
+	USGameplaySchedulerComponent* Scheduler = USGameplaySchedulerComponent::Get(this);
+	if (Scheduler)
+	{
+		Scheduler->Cancel(TimerHandle_RespawnTimer);
+	}
+
+	// An unclaimed powerup has nobody else to clean it up
+	if (PowerUpInstance && EndPlayReason == EEndPlayReason::Destroyed)
+	{
+		PowerUpInstance->Destroy();
+		PowerUpInstance = nullptr;
 	}
+
+	Super::EndPlay(EndPlayReason);
 }
 
 
@@ -51,16 +86,30 @@ void ASPickupActor::Respawn()
 }
 
 
-void ASPickupActor::NotifyActorBeginOverlap(AActor* OtherActor)
+void ASPickupActor::ActivateFor(AActor* OtherActor)
 {
-	Super::NotifyActorBeginOverlap(OtherActor);
-
 	if (Role == ROLE_Authority && PowerUpInstance)
 	{
 		PowerUpInstance->ActivatePowerup(OtherActor);
 		PowerUpInstance = nullptr;
 
 		// Set Timer to respawn powerup
-		GetWorldTimerManager().SetTimer(TimerHandle_RespawnTimer, this, &ASPickupActor::Respawn, CooldownDuration);
+		USGameplaySchedulerComponent* Scheduler = USGameplaySchedulerComponent::Get(this);
+		if (Scheduler)
+		{
+			Scheduler->Schedule(TimerHandle_RespawnTimer, ESScheduleGroup::Pickup, CooldownDuration, FSimpleDelegate::CreateUObject(this, &ASPickupActor::Respawn));
+		}
 	}
 }
+
+
+bool ASPickupActor::HasPowerup() const
+{
+	return PowerUpInstance != nullptr;
+}
+
+
+float ASPickupActor::GetPickupRadius() const
+{
+	return SphereComp->GetScaledSphereRadius();
+}
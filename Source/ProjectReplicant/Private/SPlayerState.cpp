@@ -1,6 +1,8 @@
 // Fill out your copyright notice in the Description page of Project Settings.
 
 #include "SPlayerState.h"
+#include "SGameState.h"
+#include "Engine/World.h"
 
 
 
@@ -8,4 +10,10 @@
 void ASPlayerState::AddScore(float ScoreDelta)
 {
 	Score += ScoreDelta;
+
+	ASGameState* GS = GetWorld()->GetGameState<ASGameState>();
+	if (GS && GetLocalRole() == ROLE_Authority)
+	{
+		GS->RecordScore(this, ScoreDelta);
+	}
 }
@@ -1,6 +1,7 @@
 // Fill out your copyright notice in the Description page of Project Settings.
 
 #include "SPowerupActor.h"
+#include "SGameplaySchedulerComponent.h"
 #include "Net/UnrealNetwork.h"
 
 
@@ -30,7 +31,14 @@ void ASPowerupActor::OnTickPowerup()
 		OnRep_PowerupActive();
 
 		// Delete timer
-		GetWorldTimerManager().ClearTimer(TimerHandle_PowerupTick);
+		USGameplaySchedulerComponent* Scheduler = USGameplaySchedulerComponent::Get(this);
+		if (Scheduler)
+		{
+			Scheduler->Cancel(TimerHandle_PowerupTick);
+		}
+
+		// The pickup spawns a new one, give the inactive state time to replicate before going away
+		SetLifeSpan(2.0f);
 	}
 }
 
@@ -50,7 +58,12 @@ void ASPowerupActor::ActivatePowerup(AActor* ActiveFor)
 
 	if (PowerupInterval > 0.0f)
 	{
-		GetWorldTimerManager().SetTimer(TimerHandle_PowerupTick, this, &ASPowerupActor::OnTickPowerup, PowerupInterval, true);
+		// Ticking right away would expire an interval powerup on pickup
+		USGameplaySchedulerComponent* Scheduler = USGameplaySchedulerComponent::Get(this);
+		if (ensureAlways(Scheduler))
+		{
+			Scheduler->Schedule(TimerHandle_PowerupTick, ESScheduleGroup::Powerup, PowerupInterval, FSimpleDelegate::CreateUObject(this, &ASPowerupActor::OnTickPowerup), PowerupInterval);
+		}
 	}
 	else
 	{
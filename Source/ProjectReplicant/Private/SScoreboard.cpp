@@ -0,0 +1,143 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "SScoreboard.h"
+#include "SGameState.h"
+#include "GameFramework/PlayerState.h"
+
+
+void FSScoreboardEntry::PreReplicatedRemove(const FSScoreboard& InArraySerializer)
+{
+	InArraySerializer.NotifyChanged();
+}
+
+
+void FSScoreboardEntry::PostReplicatedAdd(const FSScoreboard& InArraySerializer)
+{
+	InArraySerializer.NotifyChanged();
+}
+
+
+void FSScoreboardEntry::PostReplicatedChange(const FSScoreboard& InArraySerializer)
+{
+	InArraySerializer.NotifyChanged();
+}
+
+
+const FSScoreboardEntry* FSScoreboard::FindEntry(const APlayerState* PlayerState) const
+{
+	// Clients don't maintain the index
+	return Entries.FindByPredicate([PlayerState](const FSScoreboardEntry& Entry) { return Entry.PlayerState == PlayerState; });
+}
+
+
+FSScoreboardEntry* FSScoreboard::FindOrAddEntry(APlayerState* PlayerState)
+{
+	if (PlayerState == nullptr)
+	{
+		return nullptr;
+	}
+
+	const int32* Index = EntryIndices.Find(PlayerState);
+	if (Index)
+	{
+		return &Entries[*Index];
+	}
+
+	const int32 NewIndex = Entries.AddDefaulted();
+	EntryIndices.Add(PlayerState, NewIndex);
+
+	FSScoreboardEntry& Entry = Entries[NewIndex];
+	Entry.PlayerState = PlayerState;
+	MarkItemDirty(Entry);
+
+	return &Entry;
+}
+
+
+void FSScoreboard::AddPlayer(APlayerState* PlayerState)
+{
+	if (FindOrAddEntry(PlayerState))
+	{
+		NotifyChanged();
+	}
+}
+
+
+void FSScoreboard::RemovePlayer(APlayerState* PlayerState)
+{
+	int32 Index;
+	if (!EntryIndices.RemoveAndCopyValue(PlayerState, Index))
+	{
+		return;
+	}
+
+	Entries.RemoveAt(Index);
+	MarkArrayDirty();
+
+	EntryIndices.Reset();
+	for (int32 i = 0; i < Entries.Num(); i++)
+	{
+		EntryIndices.Add(Entries[i].PlayerState, i);
+	}
+
+	NotifyChanged();
+}
+
+
+void FSScoreboard::AddScore(APlayerState* PlayerState, float ScoreDelta)
+{
+	FSScoreboardEntry* Entry = FindOrAddEntry(PlayerState);
+	if (Entry)
+	{
+		Entry->Score += FMath::RoundToInt(ScoreDelta);
+		MarkItemDirty(*Entry);
+		NotifyChanged();
+	}
+}
+
+
+void FSScoreboard::AddKill(APlayerState* PlayerState)
+{
+	FSScoreboardEntry* Entry = FindOrAddEntry(PlayerState);
+	if (Entry)
+	{
+		Entry->Kills++;
+		MarkItemDirty(*Entry);
+		NotifyChanged();
+	}
+}
+
+
+void FSScoreboard::AddDeath(APlayerState* PlayerState)
+{
+	FSScoreboardEntry* Entry = FindOrAddEntry(PlayerState);
+	if (Entry)
+	{
+		Entry->Deaths++;
+		MarkItemDirty(*Entry);
+		NotifyChanged();
+	}
+}
+
+
+void FSScoreboard::AddDamage(APlayerState* PlayerState, float Damage)
+{
+	const int32 WholeDamage = FMath::RoundToInt(Damage);
+
+	FSScoreboardEntry* Entry = WholeDamage > 0 ? FindOrAddEntry(PlayerState) : nullptr;
+	if (Entry)
+	{
+		Entry->DamageDealt += WholeDamage;
+		MarkItemDirty(*Entry);
+		NotifyChanged();
+	}
+}
+
+
+void FSScoreboard::NotifyChanged() const
+{
+	if (OwnerGameState)
+	{
+		OwnerGameState->OnScoreboardChanged.Broadcast();
+	}
+}
@@ -8,12 +8,22 @@
 #include "Particles/ParticleSystemComponent.h"
 #include "PhysicalMaterials/PhysicalMaterial.h"
 #include "CoopGame.h"
-#include "TimerManager.h"
-#include "Net/UnrealNetwork.h"
 #include "AProjectile.h"
 #include <ProjectReplicant\Public\SCharacter.h>
 #include "Animation/AnimInstance.h"
 #include "Components/BoxComponent.h"
+#include "SWeaponData.h"
+#include "Engine/AssetManager.h"
+#include "Camera/CameraShake.h"
+#include "SFXManagerComponent.h"
+#include "SFireSchedulerComponent.h"
+#include "SGameplaySchedulerComponent.h"
+#include "SDamageQueueComponent.h"
+#include "SMatchRecorderComponent.h"
+#include "SWeaponComponent.h"
+#include "EngineUtils.h"
+
+DECLARE_CYCLE_STAT(TEXT("Weapon Cosmetics"), STAT_WeaponCosmetics, STATGROUP_CoopGame);
 
 // Sets default values
 ASWeapon::ASWeapon()
@@ -41,13 +51,17 @@ ASWeapon::ASWeapon()
 	CollisionComp->bReturnMaterialOnMove;
 
 	BaseDamage = 20.0f;
+	HitZoneDamageMultipliers.Add(ESHitZone::Head, 4.0f);
+	bTraceComplexForImpactEffects = true;
 	BulletSpread = 2.0f;
 	RateOfFire = 600;
+	TimeBetweenShots = 60 / RateOfFire;
+	NextProjectileId = 0;
+	LastFireTime = -BIG_NUMBER;
+	CachedEyeTime = -1.0f;
 
-	SetReplicates(true);
-
-	NetUpdateFrequency = 66.0f;
-	MinNetUpdateFrequency = 33.0f;
+	// Spawned locally on every machine, USWeaponComponent replicates for it
+	SetReplicates(false);
 }
 
 
@@ -56,18 +70,78 @@ void ASWeapon::BeginPlay()
 	Super::BeginPlay();
 
 	TimeBetweenShots = 60 / RateOfFire;
+
+	LoadWeaponData();
 }
 
 
-void ASWeapon::Fire()
+void ASWeapon::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
+	StopFire();
+
+	if (WeaponDataHandle.IsValid())
+	{
+		WeaponDataHandle->CancelHandle();
+		WeaponDataHandle.Reset();
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+
+void ASWeapon::LoadWeaponData()
+{
+	if (WeaponData == nullptr)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("WeaponData is nullptr in %s, using its legacy asset properties. Please update your Blueprint"), *GetName());
+		return;
+	}
+
+	// Dedicated servers never need effects, sounds or camera shakes
+	TArray<FName> Bundles;
+	Bundles.Add(USWeaponData::GameplayBundle);
+	if (!IsNetMode(NM_DedicatedServer))
+	{
+		Bundles.Add(USWeaponData::CosmeticBundle);
+	}
+
+	WeaponDataHandle = UAssetManager::Get().LoadPrimaryAsset(WeaponData->GetPrimaryAssetId(), Bundles, FStreamableDelegate::CreateUObject(this, &ASWeapon::OnWeaponDataLoaded));
+}
+
+
+void ASWeapon::OnWeaponDataLoaded()
+{
+	UE_LOG(LogTemp, Log, TEXT("Weapon data %s loaded for %s"), *WeaponData->GetName(), *GetName());
+}
+
+
+void ASWeapon::Fire(float ShotTime)
+{
+	USMatchRecorderComponent* Recorder = USMatchRecorderComponent::Get(this);
+	if (Recorder)
+	{
+		Recorder->RecordShot(Cast<APawn>(GetOwner()), ShotTime);
+	}
+
+	// The server runs its own cadence from the trigger state, clients only tell it where they were aiming
+	USWeaponComponent* WeaponComp = GetWeaponComp();
+	if (WeaponComp && !HasOwnerAuthority())
+	{
+		FVector EyeLocation;
+		FRotator EyeRotation;
+		GetShotViewPoint(ShotTime, EyeLocation, EyeRotation);
+
+		WeaponComp->SendShotAim(EyeLocation, EyeRotation);
+	}
+
 	if (TypeOfWeapon == WeaponType::Hitscan)
 	{
-		ASWeapon::OnHitScanFire();
+		ASWeapon::OnHitScanFire(ShotTime);
 	}
 	if (TypeOfWeapon == WeaponType::Projectile)
 	{
 		ASWeapon::OnProjectileFire();
+		LastFireTime = ShotTime;
 	}
 	if (TypeOfWeapon == WeaponType::Melee)
 	{
@@ -75,21 +149,16 @@ void ASWeapon::Fire()
 	}
 }
 
-void ASWeapon::OnHitScanFire()
+void ASWeapon::OnHitScanFire(float ShotTime)
 {
 	// Trace the world, from pawn eyes to crosshair location
 
-	if (GetLocalRole() < ROLE_Authority)
-	{
-		ServerFire();
-	}
-
 	AActor* MyOwner = GetOwner();
 	if (MyOwner)
 	{
 		FVector EyeLocation;
 		FRotator EyeRotation;
-		MyOwner->GetActorEyesViewPoint(EyeLocation, EyeRotation);
+		GetShotViewPoint(ShotTime, EyeLocation, EyeRotation);
 
 		FVector ShotDirection = EyeRotation.Vector();
 
@@ -102,7 +171,7 @@ void ASWeapon::OnHitScanFire()
 		FCollisionQueryParams QueryParams;
 		QueryParams.AddIgnoredActor(MyOwner);
 		QueryParams.AddIgnoredActor(this);
-		QueryParams.bTraceComplex = true;
+		QueryParams.bTraceComplex = false;
 		QueryParams.bReturnPhysicalMaterial = true;
 
 		// Particle "Target" parameter
@@ -111,20 +180,35 @@ void ASWeapon::OnHitScanFire()
 		EPhysicalSurface SurfaceType = SurfaceType_Default;
 
 		FHitResult Hit;
-		if (GetWorld()->LineTraceSingleByChannel(Hit, EyeLocation, TraceEnd, COLLISION_WEAPON, QueryParams))
+		ESHitZone HitZone;
+		if (TraceHitScanShot(EyeLocation, TraceEnd, QueryParams, Hit, HitZone))
 		{
 			// Blocking hit! Process damage
 			AActor* HitActor = Hit.GetActor();
 
-			SurfaceType = UPhysicalMaterial::DetermineSurfaceType(Hit.PhysMaterial.Get());
-
-			float ActualDamage = BaseDamage;
-			if (SurfaceType == SURFACE_FLESHVULNERABLE)
+			if (Cast<ASCharacter>(HitActor))
 			{
-				ActualDamage *= 4.0f;
+				SurfaceType = HitZone == ESHitZone::Head ? SURFACE_FLESHVULNERABLE : SURFACE_FLESHDEFAULT;
 			}
+			else
+			{
+				SurfaceType = UPhysicalMaterial::DetermineSurfaceType(Hit.PhysMaterial.Get());
 
-			UGameplayStatics::ApplyPointDamage(HitActor, ActualDamage, ShotDirection, Hit, MyOwner->GetInstigatorController(), MyOwner, DamageType);
+				// Other actors' vulnerable surfaces still take head damage
+				if (SurfaceType == SURFACE_FLESHVULNERABLE)
+				{
+					HitZone = ESHitZone::Head;
+				}
+			}
+
+			const float* ZoneMultiplier = HitZoneDamageMultipliers.Find(HitZone);
+			float ActualDamage = BaseDamage * (ZoneMultiplier ? *ZoneMultiplier : 1.0f);
+
+			USDamageQueueComponent* DamageQueue = USDamageQueueComponent::Get(this);
+			if (DamageQueue)
+			{
+				DamageQueue->QueuePointDamage(HitActor, ActualDamage, ShotDirection, Hit, DamageType, MyOwner->GetInstigatorController(), MyOwner);
+			}
 
 			PlayImpactEffects(SurfaceType, Hit.ImpactPoint);
 
@@ -133,288 +217,393 @@ void ASWeapon::OnHitScanFire()
 		}
 
 		PlayFireEffects(TracerEndPoint);
+		PlaySoundEffect();
 
-		if (GetLocalRole() == ROLE_Authority)
+		USWeaponComponent* WeaponComp = GetWeaponComp();
+		if (WeaponComp && HasOwnerAuthority())
 		{
-			HitScanTrace.TraceTo = TracerEndPoint;
-			HitScanTrace.SurfaceType = SurfaceType;
-			ServerPlaySoundEffect();
+			WeaponComp->SetHitScanTrace(TracerEndPoint, SurfaceType);
 		}
 
-		LastFireTime = GetWorld()->TimeSeconds;
+		LastFireTime = ShotTime;
 	}
 }
 
-void ASWeapon::OnProjectileFire()
+void ASWeapon::GetShotViewPoint(float ShotTime, FVector& OutEyeLocation, FRotator& OutEyeRotation) const
 {
-	if (GetLocalRole() < ROLE_Authority)
+	// Remote players' own aim beats the server's view of their pawn
+	USWeaponComponent* WeaponComp = GetWeaponComp();
+	if (WeaponComp && WeaponComp->GetClientAim(OutEyeLocation, OutEyeRotation))
 	{
-		ServerFire();
-		ServerPlayParticleEffect();
-		ServerPlaySoundEffect();
+		return;
 	}
-	else
+
+	GetOwner()->GetActorEyesViewPoint(OutEyeLocation, OutEyeRotation);
+
+	// Shots that fell between the last frame and this one aim where the owner was looking at that moment
+	const float Now = GetWorld()->TimeSeconds;
+	if (CachedEyeTime >= 0.0f && ShotTime < Now && Now > CachedEyeTime)
 	{
-		MultiCastPlayParticleEffect();
-		MultiCastPlaySoundEffect();
-		MultiCastSpawnProjectile();
+		const float Alpha = FMath::Clamp((ShotTime - CachedEyeTime) / (Now - CachedEyeTime), 0.0f, 1.0f);
+
+		OutEyeLocation = FMath::Lerp(CachedEyeLocation, OutEyeLocation, Alpha);
+		OutEyeRotation = FQuat::Slerp(CachedEyeRotation.Quaternion(), OutEyeRotation.Quaternion(), Alpha).Rotator();
 	}
 }
 
-void ASWeapon::OnMeleeFire()
+void ASWeapon::CacheShotViewPoint()
 {
-	if (GetLocalRole() < ROLE_Authority)
+	AActor* MyOwner = GetOwner();
+	if (MyOwner)
 	{
-		ServerFire();
+		MyOwner->GetActorEyesViewPoint(CachedEyeLocation, CachedEyeRotation);
+		CachedEyeTime = GetWorld()->TimeSeconds;
 	}
-	MultiCastAnimation();
+}
 
-	APawn* MyOwner = Cast<APawn>(GetOwner());
-	if (MyOwner)
+bool ASWeapon::TraceHitScanShot(const FVector& TraceStart, const FVector& TraceEnd, FCollisionQueryParams& QueryParams, FHitResult& OutHit, ESHitZone& OutZone) const
+{
+	// Phase one runs against simple world collision and character capsules, phase two against the hit character's bodies only.
+	// A shot that enters a capsule but passes between the limbs carries on past that character.
+	const int32 MaxCapsulesPierced = 4;
+
+	FVector SegmentStart = TraceStart;
+	for (int32 i = 0; i <= MaxCapsulesPierced; i++)
 	{
+		if (!GetWorld()->LineTraceSingleByChannel(OutHit, SegmentStart, TraceEnd, COLLISION_WEAPON, QueryParams))
+		{
+			return false;
+		}
+
+		OutZone = ESHitZone::Body;
+
+		ASCharacter* HitChar = Cast<ASCharacter>(OutHit.GetActor());
+		if (HitChar == nullptr)
+		{
+			return true;
+		}
+
+		FHitResult ZoneHit;
+		if (HitChar->TraceHitZone(TraceStart, TraceEnd, ZoneHit, OutZone))
+		{
+			OutHit = ZoneHit;
+			return true;
+		}
 
+		QueryParams.AddIgnoredActor(HitChar);
+		SegmentStart = OutHit.ImpactPoint;
 	}
-}
 
-void ASWeapon::MultiCastAnimation_Implementation()
-{
-	PlayAnimation();
+	return false;
 }
 
-bool ASWeapon::MultiCastAnimation_Validate()
+void ASWeapon::OnProjectileFire()
 {
-	return true;
+	// The server's spawn multicast plays the fire effects everywhere
+	if (HasOwnerAuthority())
+	{
+		SpawnProjectile();
+	}
 }
 
-void ASWeapon::MultiCastPlayParticleEffect_Implementation()
+void ASWeapon::OnMeleeFire()
 {
-	FVector v;
-	PlayFireEffects(v);
-}
+	const int32 ComboStep = PlayAnimation();
 
-bool ASWeapon::MultiCastPlayParticleEffect_Validate()
-{
-	return true;
+	USWeaponComponent* WeaponComp = GetWeaponComp();
+	if (WeaponComp && ComboStep > 0 && HasOwnerAuthority())
+	{
+		WeaponComp->SetMeleeSwing(ComboStep);
+	}
 }
 
-void ASWeapon::MultiCastPlaySoundEffect_Implementation()
+USWeaponComponent* ASWeapon::GetWeaponComp() const
 {
-	PlaySoundEffect();
+	AActor* MyOwner = GetOwner();
+	return MyOwner ? MyOwner->FindComponentByClass<USWeaponComponent>() : nullptr;
 }
 
-bool ASWeapon::MultiCastPlaySoundEffect_Validate()
+bool ASWeapon::HasOwnerAuthority() const
 {
-	return true;
+	AActor* MyOwner = GetOwner();
+	return MyOwner && MyOwner->GetLocalRole() == ROLE_Authority;
 }
 
-void ASWeapon::MultiCastSpawnProjectile_Implementation()
+void ASWeapon::OnRemoteProjectileSpawned(const FSProjectileSpawn& SpawnInfo)
 {
-	SpawnProjectile();
-}
+	FVector v;
+	PlayFireEffects(v);
+	PlaySoundEffect();
 
-bool ASWeapon::MultiCastSpawnProjectile_Validate()
-{
-	return true;
-}
+	// The server already has the real projectile
+	if (HasOwnerAuthority())
+	{
+		return;
+	}
 
-void ASWeapon::PlayAnimation()
-{
-	AActor* MyOwner = GetOwner();
-	if (MyOwner)
+	// Drop simulations that already ended on their own
+	for (auto It = SimulatedProjectiles.CreateIterator(); It; ++It)
 	{
-		USkeletalMeshComponent* skelemesh = MyOwner->FindComponentByClass<USkeletalMeshComponent>();
-		UAnimInstance* animInstance = (skelemesh) ? skelemesh->GetAnimInstance() : nullptr;
-		if (animInstance)
+		if (!It.Value().IsValid())
 		{
-			GetWorld()->GetTimerManager().ClearTimer(MeleeTimerHandle);
-			GetWorld()->GetTimerManager().ClearTimer(ComboResetTimerHandle);
-			if (CollisionComp->IsCollisionEnabled())
-			{
-				ToggleCollisionCompOff();
-			}
-
-			//TODO: Find a way to replace FireDelay with a UAnimNotifyState notify
-			if (ComboCounter <= 1)
-			{
-				float duration = animInstance->Montage_Play(ComboMontage1);
-				if (duration > 0.f)
-				{
-					ComboCounter++;
-					ToggleCollisionCompOn();
-					LastFireTime = GetWorld()->TimeSeconds;
-					float FireDelay = FMath::Max(LastFireTime + TimeBetweenShots - GetWorld()->TimeSeconds, 0.0f);
-					GetWorld()->GetTimerManager().SetTimer(MeleeTimerHandle, this, &ASWeapon::ToggleCollisionCompOff, FireDelay, false);
-					GetWorld()->GetTimerManager().SetTimer(ComboResetTimerHandle, this, &ASWeapon::ResetComboCounter, duration, false);
-				}
-			}
-			else if (ComboCounter == 2)
-			{
-				float duration = animInstance->Montage_Play(ComboMontage2);
-				if (duration > 0.f)
-				{
-					ComboCounter++;
-					ToggleCollisionCompOn();
-					LastFireTime = GetWorld()->TimeSeconds;
-					float FireDelay = FMath::Max(LastFireTime + TimeBetweenShots - GetWorld()->TimeSeconds, 0.0f);
-					GetWorld()->GetTimerManager().SetTimer(MeleeTimerHandle, this, &ASWeapon::ToggleCollisionCompOff, FireDelay, false);
-					GetWorld()->GetTimerManager().SetTimer(ComboResetTimerHandle, this, &ASWeapon::ResetComboCounter, duration, false);
-				}
-			}
-			else if (ComboCounter >= 3)
-			{
-				float duration = animInstance->Montage_Play(ComboMontage3);
-				ComboCounter = 1;
-				ToggleCollisionCompOn();
-				LastFireTime = GetWorld()->TimeSeconds;
-				float FireDelay = FMath::Max(LastFireTime + TimeBetweenShots - GetWorld()->TimeSeconds, 0.0f);
-				GetWorld()->GetTimerManager().SetTimer(MeleeTimerHandle, this, &ASWeapon::ToggleCollisionCompOff, FireDelay, false);
-				GetWorld()->GetTimerManager().SetTimer(ComboResetTimerHandle, this, &ASWeapon::ResetComboCounter, duration, false);
-			}
+			It.RemoveCurrent();
 		}
 	}
-}
 
-
-void ASWeapon::OnRep_HitScanTrace()
-{
-	// Play cosmetic FX
-	PlayFireEffects(HitScanTrace.TraceTo);
-	PlayImpactEffects(HitScanTrace.SurfaceType, HitScanTrace.TraceTo);
+	AProjectile* Projectile = SpawnLocalProjectile(SpawnInfo, true);
+	if (Projectile)
+	{
+		SimulatedProjectiles.Add(SpawnInfo.ProjectileId, Projectile);
+	}
 }
 
-
-void ASWeapon::ServerFire_Implementation()
+void ASWeapon::OnRemoteProjectileImpact(uint16 ProjectileId, const FVector& ImpactPoint, EPhysicalSurface SurfaceType)
 {
-	Fire();
-}
+	if (HasOwnerAuthority())
+	{
+		return;
+	}
 
+	TWeakObjectPtr<AProjectile> Projectile;
+	if (SimulatedProjectiles.RemoveAndCopyValue(ProjectileId, Projectile) && Projectile.IsValid())
+	{
+		Projectile->TerminateAt(ImpactPoint, SurfaceType);
+	}
+}
 
-bool ASWeapon::ServerFire_Validate()
+void ASWeapon::OnProjectileImpact(uint16 ProjectileId, const FVector& ImpactPoint, EPhysicalSurface SurfaceType)
 {
-	return true;
+	USWeaponComponent* WeaponComp = GetWeaponComp();
+	if (WeaponComp)
+	{
+		WeaponComp->MultiCastProjectileImpact(ProjectileId, ImpactPoint, (uint8)SurfaceType);
+	}
 }
 
-void ASWeapon::ServerAnimation_Implementation()
+int32 ASWeapon::PlayAnimation()
 {
-	PlayAnimation();
-}
+	AActor* MyOwner = GetOwner();
+	USkeletalMeshComponent* skelemesh = MyOwner ? MyOwner->FindComponentByClass<USkeletalMeshComponent>() : nullptr;
+	UAnimInstance* animInstance = (skelemesh) ? skelemesh->GetAnimInstance() : nullptr;
+	if (animInstance == nullptr)
+	{
+		return 0;
+	}
 
+	// Without it the hitbox would be turned on and never off again
+	USGameplaySchedulerComponent* Scheduler = USGameplaySchedulerComponent::Get(this);
+	if (!ensureAlways(Scheduler))
+	{
+		return 0;
+	}
 
-bool ASWeapon::ServerAnimation_Validate()
-{
-	return true;
-}
+	if (CollisionComp->IsCollisionEnabled())
+	{
+		ToggleCollisionCompOff();
+	}
 
+	//TODO: Find a way to replace FireDelay with a UAnimNotifyState notify
+	const int32 ComboStep = FMath::Clamp(ComboCounter, 1, 3);
+	float duration = animInstance->Montage_Play(GetComboMontage(ComboStep));
 
-void ASWeapon::ServerPlayParticleEffect_Implementation()
-{
-	FVector v;
-	PlayFireEffects(v);
-}
+	// The last step of the combo always wraps around, earlier ones only advance when a montage played
+	if (duration <= 0.f && ComboStep < 3)
+	{
+		Scheduler->Cancel(MeleeTimerHandle);
+		Scheduler->Cancel(ComboResetTimerHandle);
+		return 0;
+	}
 
+	ComboCounter = ComboStep < 3 ? ComboStep + 1 : 1;
+	ToggleCollisionCompOn();
+	LastFireTime = GetWorld()->TimeSeconds;
+	float FireDelay = FMath::Max(LastFireTime + TimeBetweenShots - GetWorld()->TimeSeconds, 0.0f);
+	// Every swing moves both timers, scheduling over a pending handle reuses its slot
+	Scheduler->Schedule(MeleeTimerHandle, ESScheduleGroup::Weapon, FireDelay, FSimpleDelegate::CreateUObject(this, &ASWeapon::ToggleCollisionCompOff));
+	Scheduler->Schedule(ComboResetTimerHandle, ESScheduleGroup::Weapon, duration, FSimpleDelegate::CreateUObject(this, &ASWeapon::ResetComboCounter));
 
-bool ASWeapon::ServerPlayParticleEffect_Validate()
-{
-	return true;
+	return ComboStep;
 }
 
-void ASWeapon::ServerPlaySoundEffect_Implementation()
+
+void ASWeapon::OnRemoteHitScanShot(const FHitScanTrace& Trace)
 {
+	// Play cosmetic FX
+	PlayFireEffects(Trace.TraceTo);
 	PlaySoundEffect();
+	PlayImpactEffects(Trace.SurfaceType, Trace.TraceTo);
 }
 
 
-bool ASWeapon::ServerPlaySoundEffect_Validate()
+void ASWeapon::OnRemoteMeleeSwing(int32 ComboStep)
 {
-	return true;
-}
-
-void ASWeapon::ServerSpawnProjectile_Implementation()
-{
-	SpawnProjectile();
+	AActor* MyOwner = GetOwner();
+	USkeletalMeshComponent* skelemesh = MyOwner ? MyOwner->FindComponentByClass<USkeletalMeshComponent>() : nullptr;
+	UAnimInstance* animInstance = (skelemesh) ? skelemesh->GetAnimInstance() : nullptr;
+	if (animInstance)
+	{
+		animInstance->Montage_Play(GetComboMontage(ComboStep));
+	}
 }
 
 
-bool ASWeapon::ServerSpawnProjectile_Validate()
+void ASWeapon::StartFire()
 {
-	return true;
-}
+	USFireSchedulerComponent* FireScheduler = USFireSchedulerComponent::Get(this);
+	if (FireScheduler == nullptr)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("No fire scheduler for %s, the game state must be an ASGameState"), *GetName());
+		return;
+	}
 
+	CacheShotViewPoint();
 
-void ASWeapon::StartFire()
-{
-	float FirstDelay = FMath::Max(LastFireTime + TimeBetweenShots - GetWorld()->TimeSeconds, 0.0f);
+	// Remote players only send trigger changes, the server fires on its own schedule
+	USWeaponComponent* WeaponComp = GetWeaponComp();
+	if (WeaponComp && !HasOwnerAuthority() && !FireScheduler->IsFiring(this))
+	{
+		WeaponComp->SendTriggerPressed(CachedEyeLocation, CachedEyeRotation);
+	}
 
-	GetWorldTimerManager().SetTimer(TimerHandle_TimeBetweenShots, this, &ASWeapon::Fire, TimeBetweenShots, true, FirstDelay);
+	// Re-pressing the trigger can't beat the weapon's fire rate
+	FireScheduler->StartFiring(this, LastFireTime + TimeBetweenShots, TimeBetweenShots);
 }
 
 
 void ASWeapon::StopFire()
 {
-	GetWorldTimerManager().ClearTimer(TimerHandle_TimeBetweenShots);
+	USFireSchedulerComponent* FireScheduler = USFireSchedulerComponent::Get(this);
+	if (FireScheduler == nullptr || !FireScheduler->IsFiring(this))
+	{
+		return;
+	}
+
+	USWeaponComponent* WeaponComp = GetWeaponComp();
+	if (WeaponComp && !HasOwnerAuthority())
+	{
+		WeaponComp->SendTriggerReleased();
+	}
+
+	FireScheduler->StopFiring(this);
 }
 
 
 void ASWeapon::PlayFireEffects(FVector TraceEnd)
 {
-	if (MuzzleEffect)
+#if WITH_COOP_COSMETICS
+	SCOPE_CYCLE_COUNTER(STAT_WeaponCosmetics);
+
+	if (!USFXManagerComponent::ShouldPlayCosmetics(this))
 	{
-		UGameplayStatics::SpawnEmitterAttached(MuzzleEffect, MeshComp, MuzzleSocketName);
+		return;
 	}
 
-	if (TracerEffect && TypeOfWeapon == WeaponType::Hitscan)
+	APawn* MyOwner = Cast<APawn>(GetOwner());
+
+	USFXManagerComponent* FXManager = USFXManagerComponent::Get(this);
+	if (FXManager)
 	{
-		FVector MuzzleLocation = MeshComp->GetSocketLocation(MuzzleSocketName);
+		const bool bLocallyOwned = MyOwner && MyOwner->IsLocallyControlled();
 
-		UParticleSystemComponent* TracerComp = UGameplayStatics::SpawnEmitterAtLocation(GetWorld(), TracerEffect, MuzzleLocation);
-		if (TracerComp)
+		// Soft references resolve to null until the cosmetic bundle has streamed in
+		FXManager->SpawnEmitterAttached(ESFXKind::Muzzle, GetMuzzleEffect(), MeshComp, MuzzleSocketName, bLocallyOwned);
+
+		UParticleSystem* Tracer = GetTracerEffect();
+		if (Tracer && TypeOfWeapon == WeaponType::Hitscan)
 		{
-			TracerComp->SetVectorParameter(TracerTargetName, TraceEnd);
+			FVector MuzzleLocation = MeshComp->GetSocketLocation(MuzzleSocketName);
+
+			UParticleSystemComponent* TracerComp = FXManager->SpawnEmitterAtLocation(ESFXKind::Tracer, Tracer, MuzzleLocation);
+			if (TracerComp)
+			{
+				TracerComp->SetVectorParameter(TracerTargetName, TraceEnd);
+			}
 		}
 	}
 
-	APawn* MyOwner = Cast<APawn>(GetOwner());
-	if (MyOwner)
+	TSubclassOf<UCameraShake> CamShake = GetFireCamShake();
+	if (MyOwner && CamShake)
 	{
 		APlayerController* PC = Cast<APlayerController>(MyOwner->GetController());
 		if (PC)
 		{
-			PC->ClientPlayCameraShake(FireCamShake);
+			PC->ClientPlayCameraShake(CamShake);
 		}
 	}
+#endif
 }
 
 void ASWeapon::PlaySoundEffect()
 {
-	FVector MuzzleLocation = MeshComp->GetSocketLocation(MuzzleSocketName);
-	if (FireSound)
+#if WITH_COOP_COSMETICS
+	SCOPE_CYCLE_COUNTER(STAT_WeaponCosmetics);
+
+	USFXManagerComponent* FXManager = USFXManagerComponent::Get(this);
+	USoundBase* Sound = GetFireSound();
+	if (FXManager && Sound)
 	{
-		UGameplayStatics::PlaySoundAtLocation(GetWorld(), FireSound, MuzzleLocation);
+		FVector MuzzleLocation = MeshComp->GetSocketLocation(MuzzleSocketName);
+
+		FXManager->PlaySoundAtLocation(Sound, MuzzleLocation);
 	}
+#endif
 }
 
 void ASWeapon::SpawnProjectile()
 {
 	APawn* MyOwner = Cast<APawn>(GetOwner());
-	if (MyOwner)
+	UClass* SpawnClass = GetProjectileClass();
+	if (MyOwner && SpawnClass)
 	{
 		FVector EyeLocation;
 		FRotator EyeRotation;
 
-		//TODO: Figure out why client is not receiving EyeRotations Pitch
-		MyOwner->GetActorEyesViewPoint(EyeLocation, EyeRotation);
+		GetShotViewPoint(GetWorld()->TimeSeconds, EyeLocation, EyeRotation);
 
-		//Set Spawn Collision Handling Override
-		FActorSpawnParameters ActorSpawnParams;
-		ActorSpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButDontSpawnIfColliding;
-		ActorSpawnParams.Owner = MyOwner;
-		FVector MuzzleLocation = MeshComp->GetSocketLocation("MuzzleSocket");
+		const AProjectile* ProjectileCDO = SpawnClass->GetDefaultObject<AProjectile>();
 
 		// spawn the projectile at the muzzle toward the center of the screen
-		GetWorld()->SpawnActor<AProjectile>(ASWeapon::ProjectileClass, MuzzleLocation, EyeRotation, ActorSpawnParams);
+		FSProjectileSpawn SpawnInfo;
+		SpawnInfo.Origin = MeshComp->GetSocketLocation(MuzzleSocketName);
+		SpawnInfo.Direction = EyeRotation.Vector();
+		SpawnInfo.Speed = (uint16)FMath::Clamp(ProjectileCDO->GetProjectileMovement()->InitialSpeed, 0.0f, (float)MAX_uint16);
+		SpawnInfo.ProjectileId = NextProjectileId++;
+
+		USWeaponComponent* WeaponComp = GetWeaponComp();
+		if (SpawnLocalProjectile(SpawnInfo, false) && WeaponComp)
+		{
+			WeaponComp->MultiCastProjectileSpawned(SpawnInfo);
+		}
 	}
 }
 
+AProjectile* ASWeapon::SpawnLocalProjectile(const FSProjectileSpawn& SpawnInfo, bool bSimulated)
+{
+	APawn* MyOwner = Cast<APawn>(GetOwner());
+	UClass* SpawnClass = GetProjectileClass();
+	if (MyOwner == nullptr || SpawnClass == nullptr)
+	{
+		return nullptr;
+	}
+
+	//Set Spawn Collision Handling Override
+	FActorSpawnParameters ActorSpawnParams;
+	ActorSpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButDontSpawnIfColliding;
+	ActorSpawnParams.Owner = MyOwner;
+	ActorSpawnParams.bDeferConstruction = true;
+
+	const FTransform SpawnTransform(SpawnInfo.Direction.Rotation(), SpawnInfo.Origin);
+
+	AProjectile* Projectile = GetWorld()->SpawnActor<AProjectile>(SpawnClass, SpawnTransform, ActorSpawnParams);
+	if (Projectile)
+	{
+		Projectile->InitProjectile(this, SpawnInfo.ProjectileId, SpawnInfo.Speed, bSimulated);
+		Projectile->FinishSpawning(SpawnTransform);
+	}
+
+	return Projectile;
+}
+
 FName ASWeapon::ReturnWeaponSocketName(ASWeapon* weapon)
 {
 	return weapon->WeaponAttachSocketName;
@@ -427,15 +616,24 @@ WeaponType ASWeapon::ReturnWeaponType(ASWeapon* weapon)
 
 void ASWeapon::PlayImpactEffects(EPhysicalSurface SurfaceType, FVector ImpactPoint)
 {
+#if WITH_COOP_COSMETICS
+	SCOPE_CYCLE_COUNTER(STAT_WeaponCosmetics);
+
+	USFXManagerComponent* FXManager = USFXManagerComponent::Get(this);
+	if (FXManager == nullptr)
+	{
+		return;
+	}
+
 	UParticleSystem* SelectedEffect = nullptr;
 	switch (SurfaceType)
 	{
 	case SURFACE_FLESHDEFAULT:
 	case SURFACE_FLESHVULNERABLE:
-		SelectedEffect = FleshImpactEffect;
+		SelectedEffect = GetFleshImpactEffect();
 		break;
 	default:
-		SelectedEffect = DefaultImpactEffect;
+		SelectedEffect = GetDefaultImpactEffect();
 		break;
 	}
 
@@ -446,8 +644,24 @@ void ASWeapon::PlayImpactEffects(EPhysicalSurface SurfaceType, FVector ImpactPoi
 		FVector ShotDirection = ImpactPoint - MuzzleLocation;
 		ShotDirection.Normalize();
 
-		UGameplayStatics::SpawnEmitterAtLocation(GetWorld(), SelectedEffect, ImpactPoint, ShotDirection.Rotation());
+		// Gameplay traces only see simple collision, find the visible surface with a short complex trace around the impact
+		if (bTraceComplexForImpactEffects && SelectedEffect == GetDefaultImpactEffect())
+		{
+			FCollisionQueryParams QueryParams;
+			QueryParams.AddIgnoredActor(GetOwner());
+			QueryParams.AddIgnoredActor(this);
+			QueryParams.bTraceComplex = true;
+
+			FHitResult Hit;
+			if (GetWorld()->LineTraceSingleByChannel(Hit, ImpactPoint - ShotDirection * 50.0f, ImpactPoint + ShotDirection * 50.0f, COLLISION_WEAPON, QueryParams))
+			{
+				ImpactPoint = Hit.ImpactPoint;
+			}
+		}
+
+		FXManager->SpawnEmitterAtLocation(ESFXKind::Impact, SelectedEffect, ImpactPoint, ShotDirection.Rotation());
 	}
+#endif
 }
 
 USkeletalMeshComponent* ASWeapon::GetWepMesh()
@@ -460,29 +674,68 @@ float ASWeapon::GetBaseDamage()
 	return this->BaseDamage;
 }
 
+float ASWeapon::GetTimeBetweenShots() const
+{
+	return TimeBetweenShots;
+}
+
 TSubclassOf<UDamageType> ASWeapon::GetDamageType()
 {
 	return this->DamageType;
 }
 
+// Weapons without a data asset fall back to their legacy properties
 UParticleSystem* ASWeapon::GetDefaultImpactEffect()
 {
-	return this->DefaultImpactEffect;
+	return WeaponData ? WeaponData->DefaultImpactEffect.Get() : DefaultImpactEffect;
 }
 
 UParticleSystem* ASWeapon::GetFleshImpactEffect()
 {
-	return this->FleshImpactEffect;
+	return WeaponData ? WeaponData->FleshImpactEffect.Get() : FleshImpactEffect;
 }
 
 USoundBase* ASWeapon::GetFireSound()
 {
-	return this->FireSound;
+	return WeaponData ? WeaponData->FireSound.Get() : FireSound;
 }
 
 USoundBase* ASWeapon::GetImpactSound()
 {
-	return this->ImpactSound;
+	return WeaponData ? WeaponData->ImpactSound.Get() : ImpactSound;
+}
+
+UClass* ASWeapon::GetProjectileClass() const
+{
+	return WeaponData ? WeaponData->ProjectileClass.Get() : ProjectileClass.Get();
+}
+
+UParticleSystem* ASWeapon::GetMuzzleEffect() const
+{
+	return WeaponData ? WeaponData->MuzzleEffect.Get() : MuzzleEffect;
+}
+
+UParticleSystem* ASWeapon::GetTracerEffect() const
+{
+	return WeaponData ? WeaponData->TracerEffect.Get() : TracerEffect;
+}
+
+TSubclassOf<UCameraShake> ASWeapon::GetFireCamShake() const
+{
+	return WeaponData ? TSubclassOf<UCameraShake>(WeaponData->FireCamShake.Get()) : FireCamShake;
+}
+
+UAnimMontage* ASWeapon::GetComboMontage(int32 ComboStep) const
+{
+	switch (ComboStep)
+	{
+	case 1:
+		return WeaponData ? WeaponData->ComboMontage1.Get() : ComboMontage1;
+	case 2:
+		return WeaponData ? WeaponData->ComboMontage2.Get() : ComboMontage2;
+	default:
+		return WeaponData ? WeaponData->ComboMontage3.Get() : ComboMontage3;
+	}
 }
 
 void ASWeapon::ToggleCollisionCompOn()
@@ -513,13 +766,6 @@ void ASWeapon::ResetComboCounter()
 	ComboCounter = 1;
 }
 
-void ASWeapon::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
-{
-	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
-
-	DOREPLIFETIME_CONDITION(ASWeapon, HitScanTrace, COND_SkipOwner);
-}
-
 void ASWeapon::OnWeaponOverlap(UPrimitiveComponent* HitComp, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult)
 {
 	AActor* MeleeOwner = this->GetOwner();
@@ -530,20 +776,21 @@ void ASWeapon::OnWeaponOverlap(UPrimitiveComponent* HitComp, AActor* OtherActor,
 		ASCharacter* hitChar = Cast<ASCharacter>(HitActor);
 		if (hitChar && SCharacter->TeamNum != hitChar->TeamNum && !RecentlyHit.Contains(hitChar))
 		{
-			EPhysicalSurface SurfaceType = SurfaceType_Default;
-			SurfaceType = UPhysicalMaterial::DetermineSurfaceType(SweepResult.PhysMaterial.Get());
-			UGameplayStatics::ApplyDamage(HitActor, BaseDamage, MeleeOwner->GetInstigatorController(), MeleeOwner, DamageType);
-			//TODO: Figure out how to get the impact point so that the effect plays
-			//PlayImpactEffects(SurfaceType, SweepResult.ImpactPoint);
-			UParticleSystem* SelectedEffect = DefaultImpactEffect;
-			if (SelectedEffect)
+			USDamageQueueComponent* DamageQueue = USDamageQueueComponent::Get(this);
+			if (DamageQueue)
 			{
-				UGameplayStatics::SpawnEmitterAtLocation(GetWorld(), SelectedEffect, OtherActor->GetActorLocation());
+				DamageQueue->QueueDamage(HitActor, BaseDamage, DamageType, MeleeOwner->GetInstigatorController(), MeleeOwner);
 			}
-			if (ImpactSound)
+			//TODO: Figure out how to get the impact point so that the effect plays
+			//PlayImpactEffects(SurfaceType, SweepResult.ImpactPoint);
+#if WITH_COOP_COSMETICS
+			USFXManagerComponent* FXManager = USFXManagerComponent::Get(this);
+			if (FXManager)
 			{
-				UGameplayStatics::PlaySoundAtLocation(GetWorld(), ImpactSound, SweepResult.ImpactNormal);
+				FXManager->SpawnEmitterAtLocation(ESFXKind::Impact, GetDefaultImpactEffect(), OtherActor->GetActorLocation());
+				FXManager->PlaySoundAtLocation(GetImpactSound(), OtherActor->GetActorLocation());
 			}
+#endif
 			RecentlyHit.Add(hitChar);
 		}
 	}
@@ -561,10 +808,91 @@ void ASWeapon::OnWeaponHit(UPrimitiveComponent* HitComponent, AActor* OtherActor
 		{
 			EPhysicalSurface SurfaceType = SurfaceType_Default;
 			SurfaceType = UPhysicalMaterial::DetermineSurfaceType(Hit.PhysMaterial.Get());
-			UGameplayStatics::ApplyDamage(HitActor, BaseDamage, MeleeOwner->GetInstigatorController(), MeleeOwner, DamageType);
+			USDamageQueueComponent* DamageQueue = USDamageQueueComponent::Get(this);
+			if (DamageQueue)
+			{
+				DamageQueue->QueueDamage(HitActor, BaseDamage, DamageType, MeleeOwner->GetInstigatorController(), MeleeOwner);
+			}
 			//TODO: Figure out how to get the impact point so that the effect plays
 			PlayImpactEffects(SurfaceType, Hit.ImpactPoint);
 			RecentlyHit.Add(hitChar);
 		}
 	}
-}
\ No newline at end of file
+}
+
+double ASWeapon::MeasureShotCosmeticsCost(int32 NumShots)
+{
+	USFXManagerComponent* FXManager = USFXManagerComponent::Get(this);
+	if (FXManager == nullptr)
+	{
+		return -1.0;
+	}
+
+	const FVector TraceEnd = GetActorLocation() + GetActorForwardVector() * 1000.0f;
+
+	// One shot at a time, otherwise the spawn budget and pool caps cull nearly all of them
+	uint64 Cycles = 0;
+	for (int32 i = 0; i < NumShots; i++)
+	{
+		FXManager->ResetForBenchmark();
+
+		const uint64 StartCycles = FPlatformTime::Cycles64();
+		PlayFireEffects(TraceEnd);
+		PlaySoundEffect();
+		PlayImpactEffects(SurfaceType_Default, TraceEnd);
+		Cycles += FPlatformTime::Cycles64() - StartCycles;
+	}
+
+	FXManager->ResetForBenchmark();
+
+	return FPlatformTime::ToSeconds64(Cycles) / FMath::Max(NumShots, 1);
+}
+
+static void BenchmarkShotCosmetics(const TArray<FString>& Args, UWorld* World)
+{
+	const int32 NumShots = Args.Num() > 0 ? FMath::Max(FCString::Atoi(*Args[0]), 1) : 1000;
+
+#if WITH_COOP_COSMETICS
+	// Dedicated servers never load the cosmetic bundle and don't tick the FX manager, there is nothing real to measure
+	if (World->GetNetMode() == NM_DedicatedServer)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("coop.BenchmarkShotCosmetics: run it on a listen server or client, dedicated servers don't play cosmetics"));
+		return;
+	}
+
+	// A weapon whose cosmetic assets have streamed in
+	ASWeapon* Weapon = nullptr;
+	for (TActorIterator<ASWeapon> It(World); It; ++It)
+	{
+		if (It->GetFireSound() || It->GetDefaultImpactEffect())
+		{
+			Weapon = *It;
+			break;
+		}
+	}
+
+	if (Weapon == nullptr)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("coop.BenchmarkShotCosmetics: no weapon with loaded effects or sounds in the world"));
+		return;
+	}
+
+	const double Cost = Weapon->MeasureShotCosmeticsCost(NumShots);
+	if (Cost < 0.0)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("coop.BenchmarkShotCosmetics: no FX manager, cosmetics are off in this world"));
+		return;
+	}
+
+	// The stripped path is a compiled out or early-out branch, what a shot costs here is what a dedicated server saves
+	UE_LOG(LogTemp, Log, TEXT("Shot cosmetics of %s over %d shots: %.2f us/shot, saved per shot on dedicated servers"),
+		*Weapon->GetName(), NumShots, Cost * 1000000.0);
+#else
+	UE_LOG(LogTemp, Warning, TEXT("coop.BenchmarkShotCosmetics: cosmetics are compiled out of server targets"));
+#endif
+}
+
+static FAutoConsoleCommandWithWorldAndArgs BenchmarkShotCosmeticsCmd(
+	TEXT("coop.BenchmarkShotCosmetics"),
+	TEXT("Listen server or client only. Measures the per-shot cost of weapon effects, sounds and impacts, which dedicated servers strip. Usage: coop.BenchmarkShotCosmetics [Shots]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&BenchmarkShotCosmetics));
\ No newline at end of file
@@ -0,0 +1,15 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "SWeaponData.h"
+
+const FPrimaryAssetType USWeaponData::PrimaryAssetType = TEXT("SWeaponData");
+
+const FName USWeaponData::GameplayBundle = TEXT("Gameplay");
+
+const FName USWeaponData::CosmeticBundle = TEXT("Cosmetic");
+
+
+FPrimaryAssetId USWeaponData::GetPrimaryAssetId() const
+{
+	return FPrimaryAssetId(PrimaryAssetType, GetFName());
+}
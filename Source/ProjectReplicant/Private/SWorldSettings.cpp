@@ -0,0 +1,9 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "SWorldSettings.h"
+
+
+const TArray<FSStreamedLevel>& ASWorldSettings::GetDeferredLevels() const
+{
+	return DeferredLevels;
+}
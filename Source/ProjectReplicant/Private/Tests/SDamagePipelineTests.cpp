@@ -0,0 +1,414 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "SDamageTestListener.h"
+#include "SHealthComponent.h"
+#include "SDamageQueueComponent.h"
+#include "SGameMode.h"
+#include "SGameState.h"
+#include "SCharacter.h"
+#include "AProjectile.h"
+#include "Engine/Engine.h"
+#include "Engine/GameInstance.h"
+#include "Engine/World.h"
+#include "AIController.h"
+#include "GameFramework/PlayerState.h"
+#include "GameFramework/WorldSettings.h"
+#include "Kismet/GameplayStatics.h"
+
+
+namespace SDamagePipelineTests
+{
+	const int32 TestFlags = EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter;
+
+	/* Standalone game world running ASGameMode, no map or player needed so it runs under -nullrhi on a headless machine */
+	class FTestWorld
+	{
+	public:
+
+		FTestWorld()
+		{
+			GameInstance = NewObject<UGameInstance>(GEngine);
+			GameInstance->AddToRoot();
+			GameInstance->InitializeStandalone();
+
+			World = GameInstance->GetWorld();
+			World->GetWorldSettings()->DefaultGameMode = ASGameMode::StaticClass();
+			World->SetGameMode(FURL());
+			World->InitializeActorsForPlay(FURL());
+			World->BeginPlay();
+		}
+
+		~FTestWorld()
+		{
+			GEngine->DestroyWorldContext(World);
+			World->DestroyWorld(false);
+			GameInstance->RemoveFromRoot();
+		}
+
+		ASGameMode* GetGameMode() const
+		{
+			return Cast<ASGameMode>(World->GetAuthGameMode());
+		}
+
+		/* Bare actor with a health component, all the damage pipeline looks at */
+		AActor* SpawnCombatant(uint8 TeamNum)
+		{
+			AActor* Actor = World->SpawnActor<AActor>();
+
+			USHealthComponent* HealthComp = NewObject<USHealthComponent>(Actor);
+			HealthComp->TeamNum = TeamNum;
+			HealthComp->RegisterComponent();
+
+			return Actor;
+		}
+
+		ASCharacter* SpawnCharacter(uint8 TeamNum)
+		{
+			ASCharacter* Character = World->SpawnActorDeferred<ASCharacter>(ASCharacter::StaticClass(), FTransform::Identity, nullptr, nullptr, ESpawnActorCollisionHandlingMethod::AlwaysSpawn);
+			Character->GetHealthComp()->TeamNum = TeamNum;
+			Character->FinishSpawning(FTransform::Identity);
+
+			return Character;
+		}
+
+		/* Character possessed by a controller with a player state, the way players are */
+		ASCharacter* SpawnPossessedCharacter(uint8 TeamNum)
+		{
+			ASCharacter* Character = SpawnCharacter(TeamNum);
+
+			AAIController* Controller = World->SpawnActor<AAIController>();
+			Controller->InitPlayerState();
+			Controller->Possess(Character);
+
+			return Character;
+		}
+
+		AProjectile* SpawnProjectile(AActor* Owner)
+		{
+			AProjectile* Projectile = World->SpawnActorDeferred<AProjectile>(AProjectile::StaticClass(), FTransform::Identity, Owner, nullptr, ESpawnActorCollisionHandlingMethod::AlwaysSpawn);
+			Projectile->InitProjectile(nullptr, 0, 1000.0f, false);
+			Projectile->FinishSpawning(FTransform::Identity);
+
+			return Projectile;
+		}
+
+		UWorld* World;
+
+		UGameInstance* GameInstance;
+	};
+
+	USHealthComponent* GetHealthComp(AActor* Actor)
+	{
+		return Cast<USHealthComponent>(Actor->GetComponentByClass(USHealthComponent::StaticClass()));
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSDamageIsFriendlyTest, "CoopGame.Damage.IsFriendly", SDamagePipelineTests::TestFlags)
+
+bool FSDamageIsFriendlyTest::RunTest(const FString& Parameters)
+{
+	SDamagePipelineTests::FTestWorld TestWorld;
+
+	AActor* RedA = TestWorld.SpawnCombatant(1);
+	AActor* RedB = TestWorld.SpawnCombatant(1);
+	AActor* Blue = TestWorld.SpawnCombatant(2);
+	AActor* NoHealth = TestWorld.World->SpawnActor<AActor>();
+
+	TestTrue(TEXT("Same team is friendly"), USHealthComponent::IsFriendly(RedA, RedB));
+	TestFalse(TEXT("Different teams are hostile"), USHealthComponent::IsFriendly(RedA, Blue));
+	TestTrue(TEXT("Null actor is friendly"), USHealthComponent::IsFriendly(RedA, nullptr));
+	TestTrue(TEXT("Actor without health is friendly"), USHealthComponent::IsFriendly(RedA, NoHealth));
+
+	// Projectiles carry their shooter's team after they leave the gun
+	ASCharacter* RedShooter = TestWorld.SpawnCharacter(1);
+	AProjectile* RedProjectile = TestWorld.SpawnProjectile(RedShooter);
+
+	TestEqual(TEXT("Projectile takes its owner's team"), (int32)RedProjectile->GetTeamNum(), 1);
+	TestTrue(TEXT("Projectile is friendly to its team"), USHealthComponent::IsFriendly(RedA, RedProjectile));
+	TestFalse(TEXT("Projectile is hostile to other teams"), USHealthComponent::IsFriendly(RedProjectile, Blue));
+	TestTrue(TEXT("Projectile against actor without health is friendly"), USHealthComponent::IsFriendly(RedProjectile, NoHealth));
+
+	AProjectile* OrphanProjectile = TestWorld.SpawnProjectile(nullptr);
+	TestEqual(TEXT("Projectile without a shooter has no team"), (int32)OrphanProjectile->GetTeamNum(), 255);
+
+	return true;
+}
+
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSDamageTeamFilterTest, "CoopGame.Damage.TeamFilter", SDamagePipelineTests::TestFlags)
+
+bool FSDamageTeamFilterTest::RunTest(const FString& Parameters)
+{
+	SDamagePipelineTests::FTestWorld TestWorld;
+
+	AActor* Victim = TestWorld.SpawnCombatant(1);
+	AActor* Teammate = TestWorld.SpawnCombatant(1);
+	AActor* Enemy = TestWorld.SpawnCombatant(2);
+	USHealthComponent* HealthComp = SDamagePipelineTests::GetHealthComp(Victim);
+
+	USDamageTestListener* Listener = NewObject<USDamageTestListener>();
+	HealthComp->OnHealthChanged.AddDynamic(Listener, &USDamageTestListener::HandleHealthChanged);
+
+	UGameplayStatics::ApplyDamage(Victim, 30.0f, nullptr, Teammate, nullptr);
+	TestEqual(TEXT("Friendly fire does no damage"), HealthComp->GetHealth(), 100.0f);
+	TestEqual(TEXT("Friendly fire does not broadcast"), Listener->NumHealthChanges, 0);
+
+	UGameplayStatics::ApplyDamage(Victim, 30.0f, nullptr, Enemy, nullptr);
+	TestEqual(TEXT("Enemy damage is applied"), HealthComp->GetHealth(), 70.0f);
+	TestEqual(TEXT("Enemy damage broadcasts once"), Listener->NumHealthChanges, 1);
+	TestEqual(TEXT("Broadcast carries the damage"), Listener->LastHealthDelta, 30.0f);
+
+	UGameplayStatics::ApplyDamage(Victim, 10.0f, nullptr, Victim, nullptr);
+	TestEqual(TEXT("Self damage is applied"), HealthComp->GetHealth(), 60.0f);
+
+	// A batch mixing both keeps only the hostile hits
+	FSDamageRecord Hits[3];
+	Hits[0].Damage = 5.0f;
+	Hits[0].DamageCauser = Teammate;
+	Hits[1].Damage = 15.0f;
+	Hits[1].DamageCauser = Enemy;
+	Hits[2].Damage = 0.0f;
+	Hits[2].DamageCauser = Enemy;
+	const int32 NumChangesBeforeBatch = Listener->NumHealthChanges;
+	HealthComp->ApplyDamageBatch(TArrayView<const FSDamageRecord>(Hits, 3));
+
+	TestEqual(TEXT("Batch skips friendly and empty hits"), HealthComp->GetHealth(), 45.0f);
+	TestEqual(TEXT("Batch broadcasts one change"), Listener->NumHealthChanges - NumChangesBeforeBatch, 1);
+	TestEqual(TEXT("Batch broadcasts its total"), Listener->LastHealthDelta, 15.0f);
+
+	return true;
+}
+
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSDamageDeathBroadcastTest, "CoopGame.Damage.DeathBroadcast", SDamagePipelineTests::TestFlags)
+
+bool FSDamageDeathBroadcastTest::RunTest(const FString& Parameters)
+{
+	SDamagePipelineTests::FTestWorld TestWorld;
+
+	ASGameMode* GM = TestWorld.GetGameMode();
+	if (!TestNotNull(TEXT("Test world runs ASGameMode"), GM))
+	{
+		return false;
+	}
+
+	USDamageTestListener* Listener = NewObject<USDamageTestListener>();
+	GM->OnActorKilled.AddDynamic(Listener, &USDamageTestListener::HandleActorKilled);
+
+	AActor* Victim = TestWorld.SpawnCombatant(1);
+	AActor* Enemy = TestWorld.SpawnCombatant(2);
+	AActor* Finisher = TestWorld.SpawnCombatant(2);
+
+	UGameplayStatics::ApplyDamage(Victim, 60.0f, nullptr, Enemy, nullptr);
+	TestEqual(TEXT("No kill while alive"), Listener->NumKills, 0);
+
+	UGameplayStatics::ApplyDamage(Victim, 60.0f, nullptr, Finisher, nullptr);
+	TestEqual(TEXT("Kill is broadcast once"), Listener->NumKills, 1);
+	TestTrue(TEXT("Kill names the victim"), Listener->LastVictim.Get() == Victim);
+	TestTrue(TEXT("Kill credits the finishing hit"), Listener->LastKiller.Get() == Finisher);
+
+	UGameplayStatics::ApplyDamage(Victim, 60.0f, nullptr, Enemy, nullptr);
+	TestEqual(TEXT("The dead are not killed again"), Listener->NumKills, 1);
+
+	// In a batch the hit that crosses zero gets the kill, not the last one
+	AActor* BatchVictim = TestWorld.SpawnCombatant(1);
+	FSDamageRecord Hits[3];
+	Hits[0].Damage = 50.0f;
+	Hits[0].DamageCauser = Enemy;
+	Hits[1].Damage = 50.0f;
+	Hits[1].DamageCauser = Finisher;
+	Hits[2].Damage = 50.0f;
+	Hits[2].DamageCauser = Enemy;
+	SDamagePipelineTests::GetHealthComp(BatchVictim)->ApplyDamageBatch(TArrayView<const FSDamageRecord>(Hits, 3));
+
+	TestEqual(TEXT("Batch kill is broadcast once"), Listener->NumKills, 2);
+	TestTrue(TEXT("Batch kill credits the hit that crossed zero"), Listener->LastKiller.Get() == Finisher);
+
+	// Dying detaches the victim from its controller, the scoreboard must still find its player state
+	ASGameState* GS = TestWorld.World->GetGameState<ASGameState>();
+	ASCharacter* Player = TestWorld.SpawnPossessedCharacter(1);
+	ASCharacter* Killer = TestWorld.SpawnPossessedCharacter(2);
+	APlayerState* PlayerPS = Player->GetPlayerState();
+	APlayerState* KillerPS = Killer->GetPlayerState();
+	if (!TestNotNull(TEXT("Test world runs ASGameState"), GS) || !TestNotNull(TEXT("Possessed victim has a player state"), PlayerPS) || !TestNotNull(TEXT("Possessed killer has a player state"), KillerPS))
+	{
+		return false;
+	}
+
+	UGameplayStatics::ApplyDamage(Player, 1000.0f, Killer->GetController(), Killer, nullptr);
+
+	TestEqual(TEXT("Player kill is broadcast"), Listener->NumKills, 3);
+	TestNull(TEXT("Dead player is detached from its controller"), Player->GetController());
+
+	const FSScoreboardEntry* PlayerEntry = GS->GetScoreboard().FindEntry(PlayerPS);
+	const FSScoreboardEntry* KillerEntry = GS->GetScoreboard().FindEntry(KillerPS);
+	if (TestNotNull(TEXT("Victim has a scoreboard row"), PlayerEntry) && TestNotNull(TEXT("Killer has a scoreboard row"), KillerEntry))
+	{
+		TestEqual(TEXT("Player death is recorded"), PlayerEntry->Deaths, 1);
+		TestEqual(TEXT("Kill is credited to the killer"), KillerEntry->Kills, 1);
+	}
+
+	return true;
+}
+
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSDamageQueueEventsTest, "CoopGame.Damage.QueueEvents", SDamagePipelineTests::TestFlags)
+
+bool FSDamageQueueEventsTest::RunTest(const FString& Parameters)
+{
+	SDamagePipelineTests::FTestWorld TestWorld;
+
+	ASGameMode* GM = TestWorld.GetGameMode();
+	USDamageQueueComponent* DamageQueue = GM ? GM->GetDamageQueueComp() : nullptr;
+	if (!TestNotNull(TEXT("Test world has a damage queue"), DamageQueue))
+	{
+		return false;
+	}
+
+	AActor* Victim = TestWorld.SpawnCombatant(1);
+	AActor* Enemy = TestWorld.SpawnCombatant(2);
+	AActor* NoHealth = TestWorld.World->SpawnActor<AActor>();
+
+	USDamageTestListener* Listener = NewObject<USDamageTestListener>();
+	SDamagePipelineTests::GetHealthComp(Victim)->OnHealthChanged.AddDynamic(Listener, &USDamageTestListener::HandleHealthChanged);
+	Victim->OnTakePointDamage.AddDynamic(Listener, &USDamageTestListener::HandlePointDamage);
+	NoHealth->OnTakePointDamage.AddDynamic(Listener, &USDamageTestListener::HandlePointDamage);
+
+	// Queued hits still reach the victim's own damage events one by one, health changes once
+	const FVector ShotDirection(1.0f, 0.0f, 0.0f);
+	DamageQueue->QueuePointDamage(Victim, 20.0f, ShotDirection, FHitResult(), nullptr, nullptr, Enemy);
+	DamageQueue->QueuePointDamage(Victim, 20.0f, ShotDirection, FHitResult(), nullptr, nullptr, Enemy);
+	DamageQueue->QueuePointDamage(NoHealth, 20.0f, ShotDirection, FHitResult(), nullptr, nullptr, Enemy);
+	DamageQueue->TickComponent(0.0f, LEVELTICK_All, nullptr);
+
+	TestEqual(TEXT("Every queued hit is a point damage event"), Listener->NumPointDamage, 3);
+	TestEqual(TEXT("Point damage keeps the shot direction"), Listener->LastShotDirection, ShotDirection);
+	TestEqual(TEXT("Both hits are applied"), SDamagePipelineTests::GetHealthComp(Victim)->GetHealth(), 60.0f);
+	TestEqual(TEXT("The victim's hits broadcast one change"), Listener->NumHealthChanges, 1);
+
+	// Actors that can't be damaged get no events and no damage
+	Victim->SetCanBeDamaged(false);
+	DamageQueue->QueuePointDamage(Victim, 20.0f, ShotDirection, FHitResult(), nullptr, nullptr, Enemy);
+	DamageQueue->TickComponent(0.0f, LEVELTICK_All, nullptr);
+
+	TestEqual(TEXT("Undamageable victim gets no damage event"), Listener->NumPointDamage, 3);
+	TestEqual(TEXT("Undamageable victim keeps its health"), SDamagePipelineTests::GetHealthComp(Victim)->GetHealth(), 60.0f);
+
+	return true;
+}
+
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSDamageClampTest, "CoopGame.Damage.Clamp", SDamagePipelineTests::TestFlags)
+
+bool FSDamageClampTest::RunTest(const FString& Parameters)
+{
+	SDamagePipelineTests::FTestWorld TestWorld;
+
+	AActor* Victim = TestWorld.SpawnCombatant(1);
+	AActor* Enemy = TestWorld.SpawnCombatant(2);
+	USHealthComponent* HealthComp = SDamagePipelineTests::GetHealthComp(Victim);
+
+	UGameplayStatics::ApplyDamage(Victim, 40.0f, nullptr, Enemy, nullptr);
+
+	HealthComp->Heal(1000.0f);
+	TestEqual(TEXT("Heal clamps to default health"), HealthComp->GetHealth(), HealthComp->GetDefaultHealth());
+
+	HealthComp->Heal(-50.0f);
+	TestEqual(TEXT("Negative heal is ignored"), HealthComp->GetHealth(), HealthComp->GetDefaultHealth());
+
+	UGameplayStatics::ApplyDamage(Victim, 1000.0f, nullptr, Enemy, nullptr);
+	TestEqual(TEXT("Overkill clamps to zero"), HealthComp->GetHealth(), 0.0f);
+
+	HealthComp->Heal(50.0f);
+	TestEqual(TEXT("The dead cannot be healed"), HealthComp->GetHealth(), 0.0f);
+
+	HealthComp->SetHealth(1000.0f);
+	TestEqual(TEXT("SetHealth clamps to default health"), HealthComp->GetHealth(), HealthComp->GetDefaultHealth());
+
+	return true;
+}
+
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSDamageBenchmarkTest, "CoopGame.Damage.Benchmark", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FSDamageBenchmarkTest::RunTest(const FString& Parameters)
+{
+	const int32 CombatantCounts[] = { 10, 100, 1000 };
+	const int32 NumEvents = 100000;
+	const int32 HitsPerBatch = 8;
+	// Small enough that nobody dies before the run ends
+	const float DamagePerEvent = 0.0001f;
+
+	// The health log line would dominate the timing
+	const ELogVerbosity::Type OldVerbosity = LogTemp.GetVerbosity();
+	LogTemp.SetVerbosity(ELogVerbosity::Warning);
+
+	for (int32 NumCombatants : CombatantCounts)
+	{
+		SDamagePipelineTests::FTestWorld TestWorld;
+
+		// Alternating teams, so every combatant's neighbour is an enemy
+		TArray<AActor*> Combatants;
+		TArray<USHealthComponent*> HealthComps;
+		for (int32 i = 0; i < NumCombatants; i++)
+		{
+			AActor* Combatant = TestWorld.SpawnCombatant(i % 2);
+			Combatants.Add(Combatant);
+			HealthComps.Add(SDamagePipelineTests::GetHealthComp(Combatant));
+		}
+
+		// One event per damage call, the path Blueprints and world damage take
+		const double SingleStart = FPlatformTime::Seconds();
+		for (int32 i = 0; i < NumEvents; i++)
+		{
+			UGameplayStatics::ApplyDamage(Combatants[i % NumCombatants], DamagePerEvent, nullptr, Combatants[(i + 1) % NumCombatants], nullptr);
+		}
+		const double SingleSeconds = FPlatformTime::Seconds() - SingleStart;
+
+		for (USHealthComponent* HealthComp : HealthComps)
+		{
+			HealthComp->SetHealth(HealthComp->GetDefaultHealth());
+		}
+
+		// The damage queue's path, one batch of hits per victim
+		TArray<FSDamageRecord> Hits;
+		Hits.SetNum(HitsPerBatch);
+		for (FSDamageRecord& Hit : Hits)
+		{
+			Hit.Damage = DamagePerEvent;
+		}
+
+		const int32 NumBatches = NumEvents / HitsPerBatch;
+		const double BatchedStart = FPlatformTime::Seconds();
+		for (int32 i = 0; i < NumBatches; i++)
+		{
+			const int32 VictimIndex = i % NumCombatants;
+			for (FSDamageRecord& Hit : Hits)
+			{
+				Hit.Victim = Combatants[VictimIndex];
+				Hit.DamageCauser = Combatants[(VictimIndex + 1) % NumCombatants];
+			}
+			HealthComps[VictimIndex]->ApplyDamageBatch(Hits);
+		}
+		const double BatchedSeconds = FPlatformTime::Seconds() - BatchedStart;
+
+		for (USHealthComponent* HealthComp : HealthComps)
+		{
+			TestTrue(TEXT("Benchmark combatants stay alive"), HealthComp->GetHealth() > 0.0f);
+		}
+
+		AddInfo(FString::Printf(TEXT("%d combatants: %.1f ns/event single, %.1f ns/event batched"),
+			NumCombatants, SingleSeconds * 1.0e9 / NumEvents, BatchedSeconds * 1.0e9 / (NumBatches * HitsPerBatch)));
+	}
+
+	LogTemp.SetVerbosity(OldVerbosity);
+
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,58 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Object.h"
+#include "SDamageTestListener.generated.h"
+
+class USHealthComponent;
+class UDamageType;
+class UPrimitiveComponent;
+
+/**
+ * Records the damage pipeline's events for the automation tests, dynamic delegates need a UFUNCTION to bind to
+ */
+UCLASS(Transient)
+class USDamageTestListener : public UObject
+{
+	GENERATED_BODY()
+
+public:
+
+	int32 NumKills = 0;
+
+	TWeakObjectPtr<AActor> LastVictim;
+
+	TWeakObjectPtr<AActor> LastKiller;
+
+	int32 NumHealthChanges = 0;
+
+	float LastHealthDelta = 0.0f;
+
+	int32 NumPointDamage = 0;
+
+	FVector LastShotDirection = FVector::ZeroVector;
+
+	UFUNCTION()
+	void HandleActorKilled(AActor* VictimActor, AActor* KillerActor, AController* KillerController)
+	{
+		NumKills++;
+		LastVictim = VictimActor;
+		LastKiller = KillerActor;
+	}
+
+	UFUNCTION()
+	void HandleHealthChanged(USHealthComponent* OwningHealthComp, float Health, float HealthDelta, const UDamageType* DamageType, AController* InstigatedBy, AActor* DamageCauser)
+	{
+		NumHealthChanges++;
+		LastHealthDelta = HealthDelta;
+	}
+
+	UFUNCTION()
+	void HandlePointDamage(AActor* DamagedActor, float Damage, AController* InstigatedBy, FVector HitLocation, UPrimitiveComponent* HitComponent, FName BoneName, FVector ShotFromDirection, const UDamageType* DamageType, AActor* DamageCauser)
+	{
+		NumPointDamage++;
+		LastShotDirection = ShotFromDirection;
+	}
+};
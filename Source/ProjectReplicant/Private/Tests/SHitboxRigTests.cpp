@@ -0,0 +1,120 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "SHitboxRigComponent.h"
+
+
+namespace SHitboxRigTests
+{
+	const int32 TestFlags = EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter;
+
+	const float Tolerance = 0.001f;
+
+	// A 200 unit segment along X through the origin, entering 10 units from the centre at T 0.45
+	const FVector Start(-100.0f, 0.0f, 0.0f);
+	const FVector End(100.0f, 0.0f, 0.0f);
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSHitboxSegmentBoxTest, "CoopGame.Hitbox.SegmentBox", SHitboxRigTests::TestFlags)
+
+bool FSHitboxSegmentBoxTest::RunTest(const FString& Parameters)
+{
+	using namespace SHitboxRigTests;
+
+	const FVector Extent(10.0f, 20.0f, 30.0f);
+	float T = -1.0f;
+	FVector Normal;
+
+	TestTrue(TEXT("Segment through the box hits"), SHitboxRig::SegmentBox(Start, End, Extent, T, Normal));
+	TestEqual(TEXT("Entry is on the near face"), T, 0.45f, Tolerance);
+	TestEqual(TEXT("Normal faces the segment start"), Normal, FVector(-1.0f, 0.0f, 0.0f), Tolerance);
+
+	TestTrue(TEXT("Reversed segment hits"), SHitboxRig::SegmentBox(End, Start, Extent, T, Normal));
+	TestEqual(TEXT("Reversed normal faces the other way"), Normal, FVector(1.0f, 0.0f, 0.0f), Tolerance);
+
+	// Entering through a side face rather than the one facing the start
+	const FVector DiagonalStart(-5.0f, 0.0f, 50.0f);
+	const FVector DiagonalEnd(5.0f, 0.0f, 10.0f);
+	TestTrue(TEXT("Segment through the top face hits"), SHitboxRig::SegmentBox(DiagonalStart, DiagonalEnd, Extent, T, Normal));
+	TestEqual(TEXT("Entry is on the top face"), T, 0.5f, Tolerance);
+	TestEqual(TEXT("Normal points up"), Normal, FVector(0.0f, 0.0f, 1.0f), Tolerance);
+
+	TestFalse(TEXT("Segment beside the box misses"), SHitboxRig::SegmentBox(Start + FVector(0.0f, 21.0f, 0.0f), End + FVector(0.0f, 21.0f, 0.0f), Extent, T, Normal));
+	TestFalse(TEXT("Segment ending short of the box misses"), SHitboxRig::SegmentBox(Start, FVector(-11.0f, 0.0f, 0.0f), Extent, T, Normal));
+	TestFalse(TEXT("Axis parallel segment outside a slab misses"), SHitboxRig::SegmentBox(FVector(-100.0f, 0.0f, 31.0f), FVector(100.0f, 0.0f, 31.0f), Extent, T, Normal));
+
+	TestTrue(TEXT("Segment starting inside hits"), SHitboxRig::SegmentBox(FVector::ZeroVector, End, Extent, T, Normal));
+	TestEqual(TEXT("Starting inside hits at once"), T, 0.0f, Tolerance);
+
+	return true;
+}
+
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSHitboxSegmentSphereTest, "CoopGame.Hitbox.SegmentSphere", SHitboxRigTests::TestFlags)
+
+bool FSHitboxSegmentSphereTest::RunTest(const FString& Parameters)
+{
+	using namespace SHitboxRigTests;
+
+	float T = -1.0f;
+	FVector Normal;
+
+	TestTrue(TEXT("Segment through the centre hits"), SHitboxRig::SegmentSphere(Start, End, FVector::ZeroVector, 10.0f, T, Normal));
+	TestEqual(TEXT("Entry is one radius from the centre"), T, 0.45f, Tolerance);
+	TestEqual(TEXT("Normal faces the segment start"), Normal, FVector(-1.0f, 0.0f, 0.0f), Tolerance);
+
+	// Off centre the entry point is where the chord starts, 6 units short of the centre plane
+	TestTrue(TEXT("Segment off the centre hits"), SHitboxRig::SegmentSphere(Start, End, FVector(0.0f, 8.0f, 0.0f), 10.0f, T, Normal));
+	TestEqual(TEXT("Entry is at the chord start"), T, 0.47f, Tolerance);
+	TestEqual(TEXT("Normal is the surface normal"), Normal, FVector(-0.6f, -0.8f, 0.0f), Tolerance);
+
+	TestFalse(TEXT("Segment passing beside misses"), SHitboxRig::SegmentSphere(Start, End, FVector(0.0f, 11.0f, 0.0f), 10.0f, T, Normal));
+	TestFalse(TEXT("Segment ending short misses"), SHitboxRig::SegmentSphere(Start, FVector(-11.0f, 0.0f, 0.0f), FVector::ZeroVector, 10.0f, T, Normal));
+	TestFalse(TEXT("Segment pointing away misses"), SHitboxRig::SegmentSphere(Start, Start * 2.0f, FVector::ZeroVector, 10.0f, T, Normal));
+
+	TestTrue(TEXT("Segment starting inside hits"), SHitboxRig::SegmentSphere(FVector(5.0f, 0.0f, 0.0f), End, FVector::ZeroVector, 10.0f, T, Normal));
+	TestEqual(TEXT("Starting inside hits at once"), T, 0.0f, Tolerance);
+
+	return true;
+}
+
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSHitboxSegmentCapsuleTest, "CoopGame.Hitbox.SegmentCapsule", SHitboxRigTests::TestFlags)
+
+bool FSHitboxSegmentCapsuleTest::RunTest(const FString& Parameters)
+{
+	using namespace SHitboxRigTests;
+
+	const float Radius = 10.0f;
+	const float HalfLength = 20.0f;
+	float T = -1.0f;
+	FVector Normal;
+
+	TestTrue(TEXT("Segment through the cylinder hits"), SHitboxRig::SegmentCapsule(Start, End, Radius, HalfLength, T, Normal));
+	TestEqual(TEXT("Entry is on the cylinder wall"), T, 0.45f, Tolerance);
+	TestEqual(TEXT("Wall normal is horizontal"), Normal, FVector(-1.0f, 0.0f, 0.0f), Tolerance);
+
+	// Down the axis the top cap is reached first, 30 units above the centre
+	TestTrue(TEXT("Segment down the axis hits"), SHitboxRig::SegmentCapsule(FVector(0.0f, 0.0f, 100.0f), FVector(0.0f, 0.0f, -100.0f), Radius, HalfLength, T, Normal));
+	TestEqual(TEXT("Entry is on the top cap"), T, 0.35f, Tolerance);
+	TestEqual(TEXT("Cap normal points up"), Normal, FVector(0.0f, 0.0f, 1.0f), Tolerance);
+
+	// Above the cylinder part only the cap's sphere is hit, entering 6 units short of the axis
+	const FVector CapOffset(0.0f, 0.0f, HalfLength + 8.0f);
+	TestTrue(TEXT("Segment through the cap's side hits"), SHitboxRig::SegmentCapsule(Start + CapOffset, End + CapOffset, Radius, HalfLength, T, Normal));
+	TestEqual(TEXT("Entry is on the cap sphere"), T, 0.47f, Tolerance);
+	TestEqual(TEXT("Cap normal tilts up"), Normal, FVector(-0.6f, 0.0f, 0.8f), Tolerance);
+
+	const FVector PastCapOffset(0.0f, 0.0f, HalfLength + Radius + 1.0f);
+	TestFalse(TEXT("Segment past the cap misses"), SHitboxRig::SegmentCapsule(Start + PastCapOffset, End + PastCapOffset, Radius, HalfLength, T, Normal));
+	TestFalse(TEXT("Segment beside the cylinder misses"), SHitboxRig::SegmentCapsule(Start + FVector(0.0f, 11.0f, 0.0f), End + FVector(0.0f, 11.0f, 0.0f), Radius, HalfLength, T, Normal));
+	TestFalse(TEXT("Segment ending short misses"), SHitboxRig::SegmentCapsule(Start, FVector(-11.0f, 0.0f, 0.0f), Radius, HalfLength, T, Normal));
+
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,294 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "SGameplaySchedulerComponent.h"
+
+
+namespace SSchedulerTests
+{
+	const int32 TestFlags = EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter;
+
+	/* Counts how often a callback ran and the wheel time it last ran at, the wheel needs no world */
+	struct FFireCounter
+	{
+		int32 NumFired = 0;
+
+		double LastFireTime = -1.0;
+
+		FSimpleDelegate MakeCallback(const double& Now)
+		{
+			return FSimpleDelegate::CreateLambda([this, &Now]()
+			{
+				NumFired++;
+				LastFireTime = Now;
+			});
+		}
+	};
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSSchedulerCascadeTest, "CoopGame.Scheduler.Cascade", SSchedulerTests::TestFlags)
+
+bool FSSchedulerCascadeTest::RunTest(const FString& Parameters)
+{
+	// Delays landing on every level of the wheel, from an unaligned start so slots don't line up with turns
+	const float Delays[] = { 0.1f, 2.0f, 100.0f, 2000.0f };
+	const double StartTime = 3.7;
+
+	double Now = StartTime;
+	FSTimingWheel Wheel;
+	Wheel.Reset(Now);
+
+	SSchedulerTests::FFireCounter Counters[ARRAY_COUNT(Delays)];
+	FSScheduleHandle Handles[ARRAY_COUNT(Delays)];
+	for (int32 i = 0; i < ARRAY_COUNT(Delays); i++)
+	{
+		Wheel.Schedule(Handles[i], Now, ESScheduleGroup::Wave, Delays[i], Counters[i].MakeCallback(Now));
+	}
+
+	TestEqual(TEXT("All timers are scheduled"), Wheel.GetNumScheduled(), (int32)ARRAY_COUNT(Delays));
+
+	for (int32 i = 0; i < ARRAY_COUNT(Delays); i++)
+	{
+		Now = StartTime + Delays[i] - 0.01;
+		Wheel.Advance(Now);
+		TestEqual(FString::Printf(TEXT("%.1fs timer hasn't fired early"), Delays[i]), Counters[i].NumFired, 0);
+		TestTrue(FString::Printf(TEXT("%.1fs timer is still scheduled"), Delays[i]), Wheel.IsScheduled(Handles[i]));
+
+		Now = StartTime + Delays[i] + 0.01;
+		Wheel.Advance(Now);
+		TestEqual(FString::Printf(TEXT("%.1fs timer fired once"), Delays[i]), Counters[i].NumFired, 1);
+		TestFalse(FString::Printf(TEXT("%.1fs timer handle went stale"), Delays[i]), Wheel.IsScheduled(Handles[i]));
+	}
+
+	// One advance jumping across several turns of the coarse levels still runs everything due in order
+	TArray<int32> Order;
+	FSScheduleHandle LateHandle;
+	FSScheduleHandle EarlyHandle;
+	Wheel.Schedule(LateHandle, Now, ESScheduleGroup::Wave, 500.0f, FSimpleDelegate::CreateLambda([&Order]() { Order.Add(2); }));
+	Wheel.Schedule(EarlyHandle, Now, ESScheduleGroup::Wave, 20.0f, FSimpleDelegate::CreateLambda([&Order]() { Order.Add(1); }));
+
+	Now += 600.0;
+	Wheel.Advance(Now);
+
+	TestEqual(TEXT("Both timers fired in one advance"), Order.Num(), 2);
+	if (Order.Num() == 2)
+	{
+		TestEqual(TEXT("Earlier timer ran first"), Order[0], 1);
+	}
+	TestEqual(TEXT("Nothing left scheduled"), Wheel.GetNumScheduled(), 0);
+
+	return true;
+}
+
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSSchedulerCancelTest, "CoopGame.Scheduler.Cancel", SSchedulerTests::TestFlags)
+
+bool FSSchedulerCancelTest::RunTest(const FString& Parameters)
+{
+	double Now = 0.0;
+	FSTimingWheel Wheel;
+	Wheel.Reset(Now);
+
+	SSchedulerTests::FFireCounter Kept;
+	SSchedulerTests::FFireCounter Cancelled;
+	SSchedulerTests::FFireCounter CancelledFar;
+
+	FSScheduleHandle KeptHandle;
+	FSScheduleHandle CancelledHandle;
+	FSScheduleHandle CancelledFarHandle;
+	Wheel.Schedule(KeptHandle, Now, ESScheduleGroup::Wave, 1.0f, Kept.MakeCallback(Now));
+	Wheel.Schedule(CancelledHandle, Now, ESScheduleGroup::Wave, 1.0f, Cancelled.MakeCallback(Now));
+	Wheel.Schedule(CancelledFarHandle, Now, ESScheduleGroup::Wave, 300.0f, CancelledFar.MakeCallback(Now));
+
+	const FSScheduleHandle StaleCopy = CancelledHandle;
+	Wheel.Cancel(CancelledFarHandle);
+	Wheel.Cancel(CancelledHandle);
+
+	TestFalse(TEXT("Cancelled handle is reset"), Wheel.IsScheduled(CancelledHandle));
+	TestFalse(TEXT("Copies of a cancelled handle go stale"), Wheel.IsScheduled(StaleCopy));
+	TestEqual(TEXT("Only the kept timer is scheduled"), Wheel.GetNumScheduled(), 1);
+
+	// The last freed node is reused first, the old handle must not see the new timer
+	SSchedulerTests::FFireCounter Reused;
+	FSScheduleHandle ReusedHandle;
+	Wheel.Schedule(ReusedHandle, Now, ESScheduleGroup::Wave, 2.0f, Reused.MakeCallback(Now));
+	TestEqual(TEXT("Freed node is reused"), ReusedHandle.Index, StaleCopy.Index);
+	TestFalse(TEXT("Stale handle doesn't match the reused node"), Wheel.IsScheduled(StaleCopy));
+
+	FSScheduleHandle StaleCancel = StaleCopy;
+	Wheel.Cancel(StaleCancel);
+	TestTrue(TEXT("Cancelling a stale handle leaves the new timer alone"), Wheel.IsScheduled(ReusedHandle));
+
+	Now = 400.0;
+	Wheel.Advance(Now);
+
+	TestEqual(TEXT("Kept timer fired"), Kept.NumFired, 1);
+	TestEqual(TEXT("Cancelled timer never fired"), Cancelled.NumFired, 0);
+	TestEqual(TEXT("Cancelled coarse level timer never fired"), CancelledFar.NumFired, 0);
+	TestEqual(TEXT("Reused timer fired"), Reused.NumFired, 1);
+
+	// A callback cancelling a timer due in the same advance stops it from running
+	SSchedulerTests::FFireCounter Victim;
+	FSScheduleHandle VictimHandle;
+	FSScheduleHandle CancellerHandle;
+	Wheel.Schedule(CancellerHandle, Now, ESScheduleGroup::Wave, 1.0f, FSimpleDelegate::CreateLambda([&Wheel, &VictimHandle]() { Wheel.Cancel(VictimHandle); }));
+	Wheel.Schedule(VictimHandle, Now, ESScheduleGroup::Weapon, 1.0f, Victim.MakeCallback(Now));
+
+	Now += 2.0;
+	Wheel.Advance(Now);
+
+	TestEqual(TEXT("Timer cancelled by an earlier callback in the batch didn't fire"), Victim.NumFired, 0);
+	TestEqual(TEXT("Nothing left scheduled"), Wheel.GetNumScheduled(), 0);
+
+	return true;
+}
+
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSSchedulerRescheduleTest, "CoopGame.Scheduler.RescheduleInCallback", SSchedulerTests::TestFlags)
+
+bool FSSchedulerRescheduleTest::RunTest(const FString& Parameters)
+{
+	double Now = 0.0;
+	FSTimingWheel Wheel;
+	Wheel.Reset(Now);
+
+	// Pushed back by a callback running in the same advance it was due in
+	SSchedulerTests::FFireCounter Pushed;
+	FSScheduleHandle PushedHandle;
+	FSScheduleHandle PusherHandle;
+	Wheel.Schedule(PusherHandle, Now, ESScheduleGroup::Wave, 1.0f, FSimpleDelegate::CreateLambda([&Wheel, &PushedHandle, &Now]()
+	{
+		Wheel.Reschedule(PushedHandle, Now, 5.0f);
+	}));
+	Wheel.Schedule(PushedHandle, Now, ESScheduleGroup::Weapon, 1.0f, Pushed.MakeCallback(Now));
+
+	Now = 1.5;
+	Wheel.Advance(Now);
+	TestEqual(TEXT("Rescheduled timer didn't fire at its old time"), Pushed.NumFired, 0);
+	TestTrue(TEXT("Rescheduled timer is still scheduled"), Wheel.IsScheduled(PushedHandle));
+
+	Now = 6.4;
+	Wheel.Advance(Now);
+	TestEqual(TEXT("Rescheduled timer hasn't fired early"), Pushed.NumFired, 0);
+
+	Now = 6.6;
+	Wheel.Advance(Now);
+	TestEqual(TEXT("Rescheduled timer fired at its new time"), Pushed.NumFired, 1);
+
+	// A one-shot scheduling itself again through its own handle
+	int32 NumChained = 0;
+	FSScheduleHandle ChainHandle;
+	TFunction<void()> Chain;
+	Chain = [&]()
+	{
+		if (++NumChained < 3)
+		{
+			Wheel.Schedule(ChainHandle, Now, ESScheduleGroup::Wave, 1.0f, FSimpleDelegate::CreateLambda([&Chain]() { Chain(); }));
+		}
+	};
+	Wheel.Schedule(ChainHandle, Now, ESScheduleGroup::Wave, 1.0f, FSimpleDelegate::CreateLambda([&Chain]() { Chain(); }));
+
+	for (int32 Step = 0; Step < 10; Step++)
+	{
+		Now += 0.5;
+		Wheel.Advance(Now);
+	}
+
+	TestEqual(TEXT("Self-scheduling timer ran every time"), NumChained, 3);
+	TestFalse(TEXT("Self-scheduling timer stopped"), Wheel.IsScheduled(ChainHandle));
+
+	// A repeating timer moving itself
+	SSchedulerTests::FFireCounter Moved;
+	FSScheduleHandle MovedHandle;
+	Wheel.Schedule(MovedHandle, Now, ESScheduleGroup::Wave, 1.0f, FSimpleDelegate::CreateLambda([&Wheel, &MovedHandle, &Moved, &Now]()
+	{
+		Moved.NumFired++;
+		Moved.LastFireTime = Now;
+		Wheel.Reschedule(MovedHandle, Now, 10.0f);
+	}), 1.0f);
+
+	for (int32 Step = 0; Step < 20; Step++)
+	{
+		Now += 0.5;
+		Wheel.Advance(Now);
+	}
+
+	TestEqual(TEXT("Repeating timer moved by its callback skips its interval"), Moved.NumFired, 1);
+
+	Now = Moved.LastFireTime + 10.1;
+	Wheel.Advance(Now);
+	TestEqual(TEXT("Repeating timer fires again after the moved delay"), Moved.NumFired, 2);
+
+	return true;
+}
+
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSSchedulerRepeatTest, "CoopGame.Scheduler.Repeat", SSchedulerTests::TestFlags)
+
+bool FSSchedulerRepeatTest::RunTest(const FString& Parameters)
+{
+	double Now = 0.0;
+	FSTimingWheel Wheel;
+	Wheel.Reset(Now);
+
+	SSchedulerTests::FFireCounter Repeating;
+	FSScheduleHandle RepeatingHandle;
+	Wheel.Schedule(RepeatingHandle, Now, ESScheduleGroup::Powerup, 0.5f, Repeating.MakeCallback(Now), 0.5f);
+
+	// Frames shorter than the interval, like the game's
+	while (Now < 2.55)
+	{
+		Now += 0.05;
+		Wheel.Advance(Now);
+	}
+
+	TestEqual(TEXT("Repeating timer fired once per interval"), Repeating.NumFired, 5);
+	TestTrue(TEXT("Repeating timer is still scheduled"), Wheel.IsScheduled(RepeatingHandle));
+	TestTrue(TEXT("Repeating timer doesn't drift"), FMath::IsNearlyEqual(Repeating.LastFireTime, 2.5, 0.06));
+
+	// Repeating timers longer than a turn of the finest level cascade down every time
+	SSchedulerTests::FFireCounter Slow;
+	FSScheduleHandle SlowHandle;
+	Wheel.Schedule(SlowHandle, Now, ESScheduleGroup::Wave, 30.0f, Slow.MakeCallback(Now), 30.0f);
+
+	const double SlowStart = Now;
+	while (Now < SlowStart + 95.0)
+	{
+		Now += 0.1;
+		Wheel.Advance(Now);
+	}
+
+	TestEqual(TEXT("Slow repeating timer fired once per interval"), Slow.NumFired, 3);
+
+	// Cancelling from its own callback stops it
+	int32 NumBeforeCancel = 0;
+	FSScheduleHandle SelfCancelHandle;
+	Wheel.Schedule(SelfCancelHandle, Now, ESScheduleGroup::Wave, 1.0f, FSimpleDelegate::CreateLambda([&Wheel, &SelfCancelHandle, &NumBeforeCancel]()
+	{
+		if (++NumBeforeCancel == 3)
+		{
+			Wheel.Cancel(SelfCancelHandle);
+		}
+	}), 1.0f);
+
+	for (int32 Step = 0; Step < 100; Step++)
+	{
+		Now += 0.1;
+		Wheel.Advance(Now);
+	}
+
+	TestEqual(TEXT("Repeating timer cancelled in its callback stopped"), NumBeforeCancel, 3);
+	TestFalse(TEXT("Cancelled repeating timer is no longer scheduled"), Wheel.IsScheduled(SelfCancelHandle));
+
+	Wheel.Cancel(RepeatingHandle);
+	Wheel.Cancel(SlowHandle);
+	TestEqual(TEXT("Nothing left scheduled"), Wheel.GetNumScheduled(), 0);
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,37 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "BehaviorTree/Tasks/BTTask_BlackboardBase.h"
+#include "SBTTask_FlowFieldChase.generated.h"
+
+/**
+ * Chases the blackboard target actor by sampling the game mode flow field instead of issuing a navmesh path request.
+ * Drop-in replacement for the MoveTo in ChasePlayer when running large horde waves.
+ */
+UCLASS()
+class COOPGAME_API USBTTask_FlowFieldChase : public UBTTask_BlackboardBase
+{
+	GENERATED_BODY()
+
+public:
+
+	USBTTask_FlowFieldChase();
+
+	virtual EBTNodeResult::Type ExecuteTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) override;
+
+	virtual FString GetStaticDescription() const override;
+
+protected:
+
+	virtual void TickTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, float DeltaSeconds) override;
+
+	/* Task succeeds once the pawn is this close to the target */
+	UPROPERTY(EditAnywhere, Category = "FlowField", meta = (ClampMin = 0.0f))
+	float AcceptableRadius;
+
+	/* Steer straight at the target when the pawn is off the field, otherwise fail the task */
+	UPROPERTY(EditAnywhere, Category = "FlowField")
+	bool bSteerDirectlyWhenOffField;
+};
@@ -42,13 +42,27 @@ protected:
 
 	uint8 TeamNum;
 
-	void PlayImpactEffects(EPhysicalSurface SurfaceType, FVector ImpactPoint, UParticleSystem* DefaultImpactEffect, UParticleSystem* FleshImpactEffect);
+	// Weapon that fired this projectile, supplies damage and effects
+	TWeakObjectPtr<ASWeapon> SourceWeapon;
+
+	uint16 ProjectileId;
+
+	// Client-side copy of a server projectile, cosmetic only
+	bool bSimulated;
+
+	void PlayImpactEffects(EPhysicalSurface SurfaceType, FVector ImpactPoint);
 public:
 	UPROPERTY()
 		TEnumAsByte<EPhysicalSurface> SurfaceType;
 
 	AProjectile();
 
+	/* Must be called on a deferred spawn before FinishSpawning */
+	void InitProjectile(ASWeapon* Weapon, uint16 InProjectileId, float Speed, bool bInSimulated);
+
+	/* Ends a simulated projectile where the server's copy hit */
+	void TerminateAt(const FVector& ImpactPoint, EPhysicalSurface InSurfaceType);
+
 	/** called when projectile hits something */
 	UFUNCTION()
 		void OnHit(UPrimitiveComponent* HitComp, AActor* OtherActor, UPrimitiveComponent* OtherComp, FVector NormalImpulse, const FHitResult& Hit);
@@ -0,0 +1,126 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "SCompactMovementComponent.generated.h"
+
+class ACharacter;
+
+// Server-driven bot position, whole units and a byte of yaw instead of the full replicated movement
+USTRUCT()
+struct FSCompactMovement
+{
+	GENERATED_BODY()
+
+public:
+
+	UPROPERTY()
+	FVector Location = FVector::ZeroVector;
+
+	UPROPERTY()
+	uint8 Yaw = 0;
+
+	// Server time in 10 ms steps, wraps around, only differences between samples are used
+	UPROPERTY()
+	uint16 TimeStamp = 0;
+
+	bool NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess);
+};
+
+template<>
+struct TStructOpsTypeTraits<FSCompactMovement> : public TStructOpsTypeTraitsBase2<FSCompactMovement>
+{
+	enum
+	{
+		WithNetSerializer = true,
+	};
+};
+
+// A received sample on the client's interpolation buffer
+struct FSCompactMovementSample
+{
+	FVector Location;
+
+	float Yaw;
+
+	// Server time in seconds, rebuilt from the wrapping time stamps
+	double ServerTime;
+};
+
+
+/* Replaces ACharacter's movement replication for server-driven bots, clients interpolate between quantized samples */
+UCLASS( ClassGroup=(COOP), meta=(BlueprintSpawnableComponent) )
+class COOPGAME_API USCompactMovementComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	// Sets default values for this component's properties
+	USCompactMovementComponent();
+
+protected:
+
+	virtual void BeginPlay() override;
+
+	/* Turn on in bot blueprints, never for player characters which rely on predicted movement */
+	UPROPERTY(EditDefaultsOnly, Category = "Replication")
+	bool bCompactMovement;
+
+	/* Send rate when moving close to a player */
+	UPROPERTY(EditDefaultsOnly, Category = "Replication", meta = (ClampMin = 1.0f))
+	float MaxUpdateRate;
+
+	/* Send rate when standing still or far from every player */
+	UPROPERTY(EditDefaultsOnly, Category = "Replication", meta = (ClampMin = 0.5f))
+	float MinUpdateRate;
+
+	/* Beyond this distance from the nearest player the bot sends at MinUpdateRate and loses net priority */
+	UPROPERTY(EditDefaultsOnly, Category = "Replication", meta = (ClampMin = 500.0f))
+	float FarViewerDistance;
+
+	/* Clients keep moving a bot along its last velocity this long when samples are late */
+	UPROPERTY(EditDefaultsOnly, Category = "Replication", meta = (ClampMin = 0.0f))
+	float MaxExtrapolationTime;
+
+	/* Jumps longer than this between samples snap instead of interpolating, e.g. pooled bots being reused */
+	UPROPERTY(EditDefaultsOnly, Category = "Replication", meta = (ClampMin = 100.0f))
+	float TeleportDistance;
+
+	UPROPERTY(ReplicatedUsing = OnRep_Movement)
+	FSCompactMovement Movement;
+
+	UPROPERTY(Transient)
+	ACharacter* OwnerCharacter;
+
+	float TimeToRateUpdate;
+
+	TArray<FSCompactMovementSample> Samples;
+
+	// Estimated server time minus local time
+	double ServerTimeOffset;
+
+	// Smoothed time between samples, sets how far behind the client renders
+	float AverageSampleInterval;
+
+	uint16 LastTimeStamp;
+
+	UFUNCTION()
+	void OnRep_Movement();
+
+	void UpdateServer(float DeltaTime);
+
+	void UpdateClient();
+
+	float GetNearestViewerDistance() const;
+
+public:
+	// Called every frame
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+	bool IsCompactMovementEnabled() const;
+
+	/* Scales the owner's net priority for one viewer, far viewers get updates last when bandwidth is short */
+	float GetNetPriorityScale(const FVector& ViewLocation) const;
+};
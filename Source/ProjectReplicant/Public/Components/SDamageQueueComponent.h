@@ -0,0 +1,90 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "SDamageQueueComponent.generated.h"
+
+class UDamageType;
+class AController;
+
+// Which damage event a hit is delivered with, the same one the UGameplayStatics call it replaces would send
+enum class ESDamageKind : uint8
+{
+	Generic,
+
+	Point,
+
+	Radial,
+};
+
+// One hit waiting to be applied
+struct FSDamageRecord
+{
+	TWeakObjectPtr<AActor> Victim;
+
+	float Damage = 0.0f;
+
+	TSubclassOf<UDamageType> DamageType;
+
+	TWeakObjectPtr<AController> InstigatedBy;
+
+	TWeakObjectPtr<AActor> DamageCauser;
+
+	ESDamageKind Kind = ESDamageKind::Generic;
+
+	// Point hits, the shot's hit and direction
+	FHitResult HitInfo;
+
+	FVector ShotDirection = FVector::ZeroVector;
+
+	// Radial hits, HitInfo is where the blast reached the victim
+	FVector Origin = FVector::ZeroVector;
+
+	float Radius = 0.0f;
+};
+
+
+/* Server-side damage queue, hits from every weapon are recorded during the frame and applied in one pass at the end of it */
+UCLASS( ClassGroup=(COOP), meta=(BlueprintSpawnableComponent) )
+class COOPGAME_API USDamageQueueComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	// Sets default values for this component's properties
+	USDamageQueueComponent();
+
+	/* Damage queue of the current game mode, null on clients */
+	static USDamageQueueComponent* Get(const UObject* WorldContextObject);
+
+protected:
+
+	TArray<FSDamageRecord> PendingDamage;
+
+	// Hits being applied, damage dealt in response to them is queued for the next frame
+	TArray<FSDamageRecord> ResolvingDamage;
+
+	// Hits applied since the match started
+	int32 TotalHitsResolved;
+
+	void ResolveDamage();
+
+	FSDamageRecord* AddRecord(AActor* Victim, float Damage, TSubclassOf<UDamageType> DamageType, AController* InstigatedBy, AActor* DamageCauser);
+
+public:
+	// Called every frame
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+	int32 GetNumHitsResolved() const;
+
+	/* Queued ApplyDamage */
+	void QueueDamage(AActor* Victim, float Damage, TSubclassOf<UDamageType> DamageType, AController* InstigatedBy, AActor* DamageCauser);
+
+	/* Queued ApplyPointDamage */
+	void QueuePointDamage(AActor* Victim, float Damage, const FVector& ShotDirection, const FHitResult& HitInfo, TSubclassOf<UDamageType> DamageType, AController* InstigatedBy, AActor* DamageCauser);
+
+	/* Full damage to everything within Radius that has line of sight to Origin, matches ApplyRadialDamage with bDoFullDamage */
+	void QueueRadialDamage(const FVector& Origin, float Radius, float Damage, TSubclassOf<UDamageType> DamageType, const TArray<AActor*>& IgnoreActors, AController* InstigatedBy, AActor* DamageCauser);
+};
@@ -0,0 +1,136 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "SFXManagerComponent.generated.h"
+
+class UParticleSystem;
+class UParticleSystemComponent;
+class UAudioComponent;
+class USoundBase;
+class USceneComponent;
+
+// Effect categories, cheaper ones are dropped first under load
+UENUM()
+enum class ESFXKind : uint8
+{
+	Muzzle,
+
+	Tracer,
+
+	Impact,
+};
+
+
+/* Client-side pool for weapon and impact FX, bounds spawns per frame and per area and culls by distance and view */
+UCLASS( ClassGroup=(COOP), meta=(BlueprintSpawnableComponent) )
+class COOPGAME_API USFXManagerComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	// Sets default values for this component's properties
+	USFXManagerComponent();
+
+	/* FX manager of the current game state, null on dedicated servers and before the game state replicated */
+	static USFXManagerComponent* Get(const UObject* WorldContextObject);
+
+	/* False in server targets and on dedicated servers, callers skip all cosmetic work including socket lookups */
+	static bool ShouldPlayCosmetics(const UObject* WorldContextObject);
+
+protected:
+
+	virtual void BeginPlay() override;
+
+	/* Effects further than this from the local view are never spawned */
+	UPROPERTY(EditDefaultsOnly, Category = "FX", meta = (ClampMin = 0.0f))
+	float MaxEffectDistance;
+
+	/* Beyond this distance tracers are dropped and impacts need to be in view */
+	UPROPERTY(EditDefaultsOnly, Category = "FX", meta = (ClampMin = 0.0f))
+	float DetailDistance;
+
+	/* Effects behind the camera are still spawned within this distance, so nearby hits are heard and seen on turn */
+	UPROPERTY(EditDefaultsOnly, Category = "FX", meta = (ClampMin = 0.0f))
+	float OutOfViewDistance;
+
+	/* New emitters per frame across all weapons */
+	UPROPERTY(EditDefaultsOnly, Category = "FX", meta = (ClampMin = 1))
+	int32 MaxSpawnsPerFrame;
+
+	/* Live emitters per AreaCellSize square */
+	UPROPERTY(EditDefaultsOnly, Category = "FX", meta = (ClampMin = 1))
+	int32 MaxEffectsPerArea;
+
+	UPROPERTY(EditDefaultsOnly, Category = "FX", meta = (ClampMin = 100.0f))
+	float AreaCellSize;
+
+	/* Hard cap on pooled emitters, nothing spawns once all of them are live */
+	UPROPERTY(EditDefaultsOnly, Category = "FX", meta = (ClampMin = 1))
+	int32 MaxParticleComponents;
+
+	/* Hard cap on pooled audio components */
+	UPROPERTY(EditDefaultsOnly, Category = "FX", meta = (ClampMin = 1))
+	int32 MaxAudioComponents;
+
+	/* The same sound in the same area plays at most once per interval, repeated fire and impacts collapse into one voice */
+	UPROPERTY(EditDefaultsOnly, Category = "FX", meta = (ClampMin = 0.0f))
+	float SoundBatchInterval;
+
+	UPROPERTY(Transient)
+	TArray<UParticleSystemComponent*> FreeParticles;
+
+	UPROPERTY(Transient)
+	TArray<UAudioComponent*> FreeAudio;
+
+	// Area cell of every live pooled emitter
+	TMap<UParticleSystemComponent*, FIntVector> ActiveParticleAreas;
+
+	TMap<FIntVector, int32> ActiveEffectsPerArea;
+
+	int32 NumAudioComponents;
+
+	// Last play time per sound and area
+	TMap<TPair<const USoundBase*, FIntVector>, float> LastSoundPlayTimes;
+
+	int32 SpawnsThisFrame;
+
+	// Local view used for culling, refreshed every tick
+	FVector ViewLocation;
+
+	FVector ViewDirection;
+
+	float ViewCosHalfFOV;
+
+	bool bHasView;
+
+	void UpdateView();
+
+	bool ShouldSpawn(ESFXKind Kind, const FVector& Location, bool bLocallyOwned) const;
+
+	FIntVector GetAreaCell(const FVector& Location) const;
+
+	UParticleSystemComponent* AcquireParticleComponent(UParticleSystem* Template, const FVector& Location);
+
+	UFUNCTION()
+	void OnParticleFinished(UParticleSystemComponent* PSystem);
+
+	UFUNCTION()
+	void OnAudioFinished(UAudioComponent* AudioComp);
+
+public:
+	// Called every frame
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+	UParticleSystemComponent* SpawnEmitterAtLocation(ESFXKind Kind, UParticleSystem* Template, const FVector& Location, const FRotator& Rotation = FRotator::ZeroRotator);
+
+	/* bLocallyOwned effects (the local player's own weapon) skip distance and view culling */
+	UParticleSystemComponent* SpawnEmitterAttached(ESFXKind Kind, UParticleSystem* Template, USceneComponent* AttachToComponent, FName AttachPointName, bool bLocallyOwned);
+
+	void PlaySoundAtLocation(USoundBase* Sound, const FVector& Location);
+
+	/* Stops everything live and clears the frame budget and sound batching, so every benchmarked shot pays for a full spawn */
+	void ResetForBenchmark();
+};
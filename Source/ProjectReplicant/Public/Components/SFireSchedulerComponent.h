@@ -0,0 +1,67 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "SFireSchedulerComponent.generated.h"
+
+class ASWeapon;
+
+// A weapon that is currently holding its trigger down
+struct FSFireSchedule
+{
+	TWeakObjectPtr<ASWeapon> Weapon;
+
+	// World time of the next shot, advanced by Interval so shots never drift with the frame rate
+	float NextShotTime;
+
+	float Interval;
+};
+
+// One shot due this frame
+struct FSScheduledShot
+{
+	ASWeapon* Weapon;
+
+	float ShotTime;
+};
+
+
+/* Fires every automatic weapon from one place, shots due in a frame are collected, ordered by their exact time and fired as one batch */
+UCLASS( ClassGroup=(COOP), meta=(BlueprintSpawnableComponent) )
+class COOPGAME_API USFireSchedulerComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	// Sets default values for this component's properties
+	USFireSchedulerComponent();
+
+	/* Fire scheduler of the current game state, null before the game state exists */
+	static USFireSchedulerComponent* Get(const UObject* WorldContextObject);
+
+protected:
+
+	/* Shots owed to one weapon beyond this in a single frame are dropped, so a long hitch doesn't unload a whole magazine at once */
+	UPROPERTY(EditDefaultsOnly, Category = "Fire", meta = (ClampMin = 1))
+	int32 MaxShotsPerWeaponPerFrame;
+
+	TArray<FSFireSchedule> Schedules;
+
+	// Reused every frame to avoid reallocating
+	TArray<FSScheduledShot> ShotBatch;
+
+	int32 FindSchedule(const ASWeapon* Weapon) const;
+
+public:
+	// Called every frame
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+	/* Starts firing Weapon every Interval seconds, the first shot is fired right away if FirstShotTime is not in the future */
+	void StartFiring(ASWeapon* Weapon, float FirstShotTime, float Interval);
+
+	void StopFiring(ASWeapon* Weapon);
+
+	bool IsFiring(const ASWeapon* Weapon) const;
+};
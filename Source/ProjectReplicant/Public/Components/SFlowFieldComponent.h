@@ -0,0 +1,148 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "SFlowFieldComponent.generated.h"
+
+class APawn;
+
+// Navmesh sampled onto a grid, built at runtime or baked into the level by ASLevelBakeData
+USTRUCT()
+struct FSFlowFieldGrid
+{
+	GENERATED_BODY()
+
+public:
+
+	// Min corner
+	UPROPERTY()
+	FVector Origin = FVector::ZeroVector;
+
+	UPROPERTY()
+	float CellSize = 0.0f;
+
+	UPROPERTY()
+	int32 NumCellsX = 0;
+
+	UPROPERTY()
+	int32 NumCellsY = 0;
+
+	UPROPERTY()
+	TArray<float> CellHeights;
+
+	// Non-zero where the cell is on the navmesh
+	UPROPERTY()
+	TArray<uint8> Walkable;
+
+	bool IsValid() const { return NumCellsX > 0 && NumCellsY > 0 && Walkable.Num() == NumCellsX * NumCellsY && CellHeights.Num() == Walkable.Num(); }
+};
+
+// Integration field toward one human player, rebuilt a few cells per tick while the previous one keeps serving queries
+struct FSFlowFieldLayer
+{
+	TWeakObjectPtr<APawn> Target;
+
+	// Cell the served field was built toward, INDEX_NONE until the first build completes
+	int32 GoalCell = INDEX_NONE;
+
+	// Steps to the goal per cell, MAX_uint16 when unreachable
+	TArray<uint16> Integration;
+
+	// Field being built toward PendingGoalCell
+	TArray<uint16> PendingIntegration;
+
+	TArray<int32> Frontier;
+
+	int32 FrontierHead = 0;
+
+	int32 PendingGoalCell = INDEX_NONE;
+};
+
+
+/* Server-side grid flow field over the navigable area, lets any number of bots chase players without per-bot path queries */
+UCLASS( ClassGroup=(COOP), meta=(BlueprintSpawnableComponent) )
+class COOPGAME_API USFlowFieldComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	// Sets default values for this component's properties
+	USFlowFieldComponent();
+
+protected:
+	// Called when the game starts
+	virtual void BeginPlay() override;
+
+	/* Size of a grid cell in world units */
+	UPROPERTY(EditDefaultsOnly, Category = "FlowField", meta = (ClampMin = 25.0f))
+	float CellSize;
+
+	/* Upper bound on cells per axis, the cell size grows to fit large maps */
+	UPROPERTY(EditDefaultsOnly, Category = "FlowField", meta = (ClampMin = 16, ClampMax = 1024))
+	int32 MaxCellsPerAxis;
+
+	/* Neighbouring cells further apart than this vertically are not connected */
+	UPROPERTY(EditDefaultsOnly, Category = "FlowField")
+	float MaxStepHeight;
+
+	/* Integration cells expanded per tick across all players, keeps the update cost fixed */
+	UPROPERTY(EditDefaultsOnly, Category = "FlowField", meta = (ClampMin = 64))
+	int32 MaxCellsPerTick;
+
+	// Grid origin (min corner) and size
+	FVector GridOrigin;
+
+	int32 NumCellsX;
+
+	int32 NumCellsY;
+
+	// Navmesh height per cell, only valid where Walkable is set
+	TArray<float> CellHeights;
+
+	TBitArray<> Walkable;
+
+	TArray<FSFlowFieldLayer> Layers;
+
+	// Pawns chased besides player-controlled ones, e.g. match replay puppets
+	TArray<TWeakObjectPtr<APawn>> ExtraTargets;
+
+	void BuildGrid();
+
+	void RefreshTargets();
+
+	void UpdateLayers(int32 CellBudget);
+
+	bool AreCellsConnected(int32 CellA, int32 CellB) const;
+
+	int32 WorldToCell(const FVector& Location) const;
+
+	FVector CellToWorld(int32 Cell) const;
+
+public:
+	// Called every frame
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+	bool IsGridReady() const;
+
+	/* Samples the navmesh of World onto a grid, used at runtime when the level has no baked grid and by the level bake in the editor */
+	static bool BuildGridData(UWorld* World, float MinCellSize, int32 MaxCellsPerAxis, float MaxStepHeight, FSFlowFieldGrid& OutGrid);
+
+	/* Builds a field toward Pawn as if it were a player, for pawns without a player controller */
+	void AddExtraTarget(APawn* Pawn);
+
+	const TArray<TWeakObjectPtr<APawn>>& GetExtraTargets() const;
+
+	/* Navmesh height of the cell under Location, false off the walkable grid */
+	bool GetGroundHeight(const FVector& Location, float& OutHeight) const;
+
+	/* Field built toward Target, null if it has none. Game thread only, layers are added and removed as targets come and go */
+	const FSFlowFieldLayer* FindLayer(const AActor* Target) const;
+
+	/* Desired 2D move direction from Location toward Target, false if Target has no field or Location is off the field */
+	bool GetFlowDirection(const FVector& Location, const AActor* Target, FVector& OutDirection) const;
+
+	/* Same with the layer and target location looked up beforehand, reads no actors so it is safe on worker threads while the field doesn't tick */
+	bool GetFlowDirection(const FVector& Location, const FSFlowFieldLayer* Layer, const FVector& GoalLocation, FVector& OutDirection) const;
+};
@@ -0,0 +1,149 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "SScheduleHandle.h"
+#include "SGameplaySchedulerComponent.generated.h"
+
+/* Hierarchical timing wheel, scheduling and cancelling cost the same however many timers are pending */
+class COOPGAME_API FSTimingWheel
+{
+public:
+
+	FSTimingWheel();
+
+	/* Starts the wheel at Now, nothing scheduled before is kept */
+	void Reset(double Now);
+
+	/* Runs Callback Delay seconds after Now, then every Interval seconds if Interval is above zero. Reuses Handle's slot when it is still scheduled */
+	void Schedule(FSScheduleHandle& Handle, double Now, ESScheduleGroup Group, float Delay, FSimpleDelegate Callback, float Interval = 0.0f);
+
+	/* Moves a scheduled callback to Delay seconds after Now, false when Handle is no longer scheduled */
+	bool Reschedule(const FSScheduleHandle& Handle, double Now, float Delay);
+
+	void Cancel(FSScheduleHandle& Handle);
+
+	bool IsScheduled(const FSScheduleHandle& Handle) const;
+
+	/* Runs every callback due by Now */
+	void Advance(double Now);
+
+	int32 GetNumScheduled() const;
+
+	int32 GetNumFiredLastAdvance() const;
+
+private:
+
+	// Slots on the finest level are one tick apart, every coarser level spans a whole turn of the one below per slot
+	static const int32 TickBits = 10;
+	static const int32 Level0Bits = 8;
+	static const int32 LevelBits = 6;
+	static const int32 NumLevels = 4;
+	static const int32 Level0Slots = 1 << Level0Bits;
+	static const int32 LevelSlots = 1 << LevelBits;
+
+	struct FNode
+	{
+		FSimpleDelegate Callback;
+
+		int64 ExpireTick = 0;
+
+		int64 IntervalTicks = 0;
+
+		int32 Prev = INDEX_NONE;
+
+		int32 Next = INDEX_NONE;
+
+		int32 Slot = INDEX_NONE;
+
+		uint32 Serial = 0;
+
+		ESScheduleGroup Group = ESScheduleGroup::Wave;
+	};
+
+	struct FDueNode
+	{
+		int32 Index;
+
+		uint32 Serial;
+
+		int64 ExpireTick;
+
+		ESScheduleGroup Group;
+	};
+
+	TArray<FNode> Nodes;
+
+	TArray<int32> FreeNodes;
+
+	// List head per slot, the finest level first
+	TArray<int32> SlotHeads;
+
+	// Reused every advance to avoid reallocating
+	TArray<FDueNode> DueBatch;
+
+	int64 CurrentTick;
+
+	uint32 NextSerial;
+
+	int32 NumScheduled;
+
+	int32 NumFiredLastAdvance;
+
+	int64 ToTick(double Seconds) const;
+
+	int32 AllocNode();
+
+	void FreeNode(int32 Index);
+
+	void Link(int32 Index);
+
+	void Unlink(int32 Index);
+
+	void Cascade(int32 Level, int32 LevelSlot);
+
+	bool IsValidHandle(const FSScheduleHandle& Handle) const;
+};
+
+
+/* Gameplay timers of every system on one timing wheel, run once per frame with due callbacks batched by system */
+UCLASS( ClassGroup=(COOP), meta=(BlueprintSpawnableComponent) )
+class COOPGAME_API USGameplaySchedulerComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	// Sets default values for this component's properties
+	USGameplaySchedulerComponent();
+
+	/* Scheduler of the current game state, null before the game state exists */
+	static USGameplaySchedulerComponent* Get(const UObject* WorldContextObject);
+
+	/* Same as a world timer: runs Callback after Delay, then every Interval if it is above zero, replacing what Handle had scheduled */
+	void Schedule(FSScheduleHandle& Handle, ESScheduleGroup Group, float Delay, FSimpleDelegate Callback, float Interval = 0.0f);
+
+	/* Moves an already scheduled callback without touching anything else, false when Handle is no longer scheduled */
+	bool Reschedule(const FSScheduleHandle& Handle, float Delay);
+
+	void Cancel(FSScheduleHandle& Handle);
+
+	bool IsScheduled(const FSScheduleHandle& Handle) const;
+
+	int32 GetNumScheduled() const;
+
+protected:
+
+	virtual void BeginPlay() override;
+
+	FSTimingWheel Wheel;
+
+	bool bWheelStarted;
+
+	double GetNow() const;
+
+public:
+	// Called every frame
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+};
@@ -4,6 +4,8 @@
 
 #include "CoreMinimal.h"
 #include "Components/ActorComponent.h"
+#include "Containers/ArrayView.h"
+#include "SDamageQueueComponent.h"
 #include "SHealthComponent.generated.h"
 
 // OnHealthChanged event
@@ -33,16 +35,40 @@ protected:
 	UFUNCTION()
 	void OnRep_Health(float OldHealth);
 
+	// Bumped with every SetHealth that changes health, so clients can tell a reset from damage or healing
+	UPROPERTY(Replicated)
+	uint8 HealthResetCount;
+
+	uint8 LastHealthResetCount;
+
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "HealthComponent")
 	float DefaultHealth;
 
 	UFUNCTION()
 	void HandleTakeAnyDamage(AActor* DamagedActor, float Damage, const class UDamageType* DamageType, class AController* InstigatedBy, AActor* DamageCauser);
+
+	// Between BeginDamageBatch and EndDamageBatch hits taken are collected instead of applied
+	bool bBatchingDamage;
+
+	TArray<FSDamageRecord> BatchedHits;
 	
 public:
 
 	float GetHealth() const;
 
+	float GetDefaultHealth() const;
+
+	/* Server only, restores a pooled character's health when it is reused. Not a health change, nothing is broadcast on the server or on clients */
+	void SetHealth(float NewHealth);
+
+	/* Applies all of a frame's hits on the owner as one health change, the hit that drops health to zero gets the kill */
+	void ApplyDamageBatch(TArrayView<const FSDamageRecord> Hits);
+
+	/* The damage queue delivers a victim's hits through TakeDamage one by one between these, health changes once at the end */
+	void BeginDamageBatch();
+
+	void EndDamageBatch();
+
 	UPROPERTY(BlueprintAssignable, Category = "Events")
 	FOnHealthChangedSignature OnHealthChanged;
 
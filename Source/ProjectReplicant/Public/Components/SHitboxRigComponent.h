@@ -0,0 +1,118 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "SHitZone.h"
+#include "SHitboxRigComponent.generated.h"
+
+class USkeletalMeshComponent;
+class UPhysicalMaterial;
+
+enum class ESHitboxShape : uint8
+{
+	Sphere,
+
+	Capsule,
+
+	Box,
+};
+
+// One shape copied from the physics asset, sized and placed relative to its bone
+struct FSHitbox
+{
+	FName BoneName;
+
+	int32 BoneIndex;
+
+	ESHitboxShape Shape;
+
+	ESHitZone Zone;
+
+	FTransform BoneLocalTransform;
+
+	// Radius for spheres and capsules, half size for boxes
+	FVector Extent;
+
+	// Half length of a capsule's cylinder along its Z axis
+	float HalfLength;
+
+	TWeakObjectPtr<UPhysicalMaterial> PhysMaterial;
+
+	// Bone is the aim bone or below it, so it turns with the aim where the mesh isn't animated
+	bool bFollowsAim;
+
+	// In mesh component space, from the last pose sample
+	FTransform ComponentTransform;
+};
+
+// Segment tests against shapes centred on the origin, T is the entry fraction along the segment
+namespace SHitboxRig
+{
+	bool SegmentBox(const FVector& S, const FVector& E, const FVector& Extent, float& OutT, FVector& OutNormal);
+
+	bool SegmentSphere(const FVector& S, const FVector& E, const FVector& Center, float Radius, float& OutT, FVector& OutNormal);
+
+	// Capsule along Z, HalfLength is the cylinder part only
+	bool SegmentCapsule(const FVector& S, const FVector& E, float Radius, float HalfLength, float& OutT, FVector& OutNormal);
+}
+
+
+/* Server-side hitboxes for weapon traces, a few shapes from the physics asset posed from a low-rate sample so the skinned mesh needn't be evaluated */
+UCLASS( ClassGroup=(COOP), meta=(BlueprintSpawnableComponent) )
+class COOPGAME_API USHitboxRigComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	// Sets default values for this component's properties
+	USHitboxRigComponent();
+
+	/* Copies the physics asset's shapes, bones missing from ZoneBones are body hits unless their material is vulnerable flesh */
+	void BuildFromMesh(USkeletalMeshComponent* InMesh, const TMap<FName, ESHitZone>& ZoneBones);
+
+	bool HasHitboxes() const;
+
+	/* Closest hitbox along the segment, OutHit is filled in like a trace against the mesh would */
+	bool LineTrace(const FVector& TraceStart, const FVector& TraceEnd, FHitResult& OutHit, ESHitZone& OutZone);
+
+protected:
+
+	/* Times per second the pose is resampled from the mesh, only when traced. Where the mesh isn't animated the reference pose is used, turned by the aim */
+	UPROPERTY(EditDefaultsOnly, Category = "Hitboxes", meta = (ClampMin = 1.0f))
+	float PoseSampleRate;
+
+	/* Without animation the reference pose is squashed down to the crouched capsule */
+	UPROPERTY(EditDefaultsOnly, Category = "Hitboxes")
+	bool bApproximateCrouch;
+
+	/* Without animation this bone and everything below it are turned by the pawn's aim pitch and yaw, like an aim offset */
+	UPROPERTY(EditDefaultsOnly, Category = "Hitboxes")
+	FName AimBone;
+
+	/* Aim yaw away from the actor's facing is clamped to this, past it characters turn in place */
+	UPROPERTY(EditDefaultsOnly, Category = "Hitboxes", meta = (ClampMin = 0.0f, ClampMax = 180.0f))
+	float MaxAimYaw;
+
+	/* Local rotations added to reference pose bones, to bring the arms down from the bind pose to holding a weapon */
+	UPROPERTY(EditDefaultsOnly, Category = "Hitboxes")
+	TMap<FName, FRotator> PoseBoneRotations;
+
+	TWeakObjectPtr<USkeletalMeshComponent> Mesh;
+
+	TArray<FSHitbox> Hitboxes;
+
+	// Bone transforms in component space from the reference skeleton, with PoseBoneRotations applied
+	TArray<FTransform> ReferencePose;
+
+	int32 AimBoneIndex;
+
+	bool bUseReferencePose;
+
+	float LastPoseSampleTime;
+
+	float StandingHalfHeight;
+
+	void SamplePose();
+};
@@ -0,0 +1,126 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "Containers/Queue.h"
+#include "SHordeComponent.generated.h"
+
+class ASCharacter;
+class USFlowFieldComponent;
+
+// A horde bot, far away it is only a point moving along the flow field
+struct FSHordeAgent
+{
+	// On the navmesh, not the capsule centre
+	FVector Location;
+
+	float Health;
+
+	bool bPromoted = false;
+
+	// Full character while promoted
+	TWeakObjectPtr<ASCharacter> Character;
+};
+
+
+// Promotion or demotion found by the parallel update, applied on the game thread after it
+struct FSHordeAction
+{
+	int32 AgentIndex;
+
+	bool bPromote;
+
+	bool bTargeted;
+
+	float NearestDistSquared;
+};
+
+
+/* Server-side horde, bots far from every player are plain agents and become pooled ASCharacters when players get close or aim at them */
+UCLASS( ClassGroup=(COOP), meta=(BlueprintSpawnableComponent) )
+class COOPGAME_API USHordeComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	// Sets default values for this component's properties
+	USHordeComponent();
+
+protected:
+
+	virtual void BeginPlay() override;
+
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	/* Character used for promoted agents, the horde is off when unset and the game mode spawns bots through BP */
+	UPROPERTY(EditDefaultsOnly, Category = "Horde")
+	TSubclassOf<ASCharacter> BotClass;
+
+	/* Agents closer than this to a player become characters */
+	UPROPERTY(EditDefaultsOnly, Category = "Horde", meta = (ClampMin = 500.0f))
+	float PromoteDistance;
+
+	/* Characters further than this from every player go back to being agents, larger than PromoteDistance so bots don't flicker */
+	UPROPERTY(EditDefaultsOnly, Category = "Horde", meta = (ClampMin = 500.0f))
+	float DemoteDistance;
+
+	/* Agents a player aims at within this distance are promoted too, so they can be shot */
+	UPROPERTY(EditDefaultsOnly, Category = "Horde", meta = (ClampMin = 0.0f))
+	float TargetedDistance;
+
+	/* Half angle of a player's aim cone in degrees */
+	UPROPERTY(EditDefaultsOnly, Category = "Horde", meta = (ClampMin = 0.1f, ClampMax = 45.0f))
+	float TargetedHalfAngle;
+
+	/* Cap on live characters, agents past it wait their turn */
+	UPROPERTY(EditDefaultsOnly, Category = "Horde", meta = (ClampMin = 1))
+	int32 MaxPromotedBots;
+
+	/* Ground speed of agents, should match the bot's max walk speed */
+	UPROPERTY(EditDefaultsOnly, Category = "Horde", meta = (ClampMin = 0.0f))
+	float AgentSpeed;
+
+	/* New agents are scattered this far around their spawn point */
+	UPROPERTY(EditDefaultsOnly, Category = "Horde", meta = (ClampMin = 0.0f))
+	float SpawnScatterRadius;
+
+	TArray<FSHordeAgent> Agents;
+
+	UPROPERTY(Transient)
+	TArray<ASCharacter*> FreeBots;
+
+	UPROPERTY(Transient)
+	USFlowFieldComponent* FlowField;
+
+	int32 NumPromoted;
+
+	// Filled from worker threads during the parallel update, only drained on the game thread
+	TQueue<FSHordeAction, EQueueMode::Mpsc> PendingActions;
+
+	// Reused every tick to avoid reallocating
+	TArray<FSHordeAction> ActionBatch;
+
+	/* Drops agents whose character died and moves promoted agents to their character, game thread only */
+	void GatherPromotedAgents();
+
+	/* Applies what the parallel update queued, demotions first so freed slots go to the nearest waiting agents */
+	void ApplyActions();
+
+	void Promote(FSHordeAgent& Agent);
+
+	void Demote(FSHordeAgent& Agent);
+
+public:
+	// Called every frame
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+	bool IsHordeEnabled() const;
+
+	/* Adds Count agents around a navmesh location */
+	void SpawnAgents(const FVector& Location, int32 Count);
+
+	/* Living agents, promoted or not */
+	int32 GetNumAgents() const;
+};
@@ -0,0 +1,41 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "SLevelStreamerComponent.generated.h"
+
+
+/* Streams the deferred sublevels listed in the map's ASWorldSettings in one at a time after the persistent level is playing */
+UCLASS( ClassGroup=(COOP), meta=(BlueprintSpawnableComponent) )
+class COOPGAME_API USLevelStreamerComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	// Sets default values for this component's properties
+	USLevelStreamerComponent();
+
+protected:
+
+	virtual void BeginPlay() override;
+
+	TArray<FName> PendingLevels;
+
+	double StreamingStartTime;
+
+	int32 NextLatentUUID;
+
+	bool bStreamingComplete;
+
+	void LoadNextLevel();
+
+	UFUNCTION()
+	void OnLevelLoaded();
+
+public:
+
+	/* True once every sublevel this machine streams has loaded, right away on maps without any */
+	bool IsStreamingComplete() const;
+};
@@ -0,0 +1,173 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "SMatchRecorderComponent.generated.h"
+
+class APawn;
+class AController;
+enum class EWaveState : uint8;
+
+UENUM()
+enum class ESMatchEventType : uint8
+{
+	// Where a player is and where they aim, sampled every SampleInterval
+	PlayerSample,
+
+	// A player shot, with the aim it was fired with
+	Shot,
+
+	BotSpawn,
+
+	WaveState,
+
+	// Damage resolved on a victim, compared against the replay's damage
+	Damage,
+
+	Kill,
+};
+
+// One entry of the match log, only the fields its type needs are serialized
+struct FSMatchEvent
+{
+	float Time = 0.0f;
+
+	ESMatchEventType Type = ESMatchEventType::PlayerSample;
+
+	// Player slot, or wave state for WaveState events
+	uint8 Slot = 0;
+
+	FVector Location = FVector::ZeroVector;
+
+	FRotator Rotation = FRotator::ZeroRotator;
+
+	float Value = 0.0f;
+
+	friend FArchive& operator<<(FArchive& Ar, FSMatchEvent& Event);
+};
+
+// Gameplay totals of a recording or a replay
+struct FSMatchStats
+{
+	int32 Shots = 0;
+
+	int32 BotSpawns = 0;
+
+	int32 Kills = 0;
+
+	double Damage = 0.0;
+};
+
+
+/* Server-side match event log. -CoopRecord writes one per match, -CoopReplay=<file> re-drives it headless with a fixed timestep and reports frame times */
+UCLASS( ClassGroup=(COOP), meta=(BlueprintSpawnableComponent) )
+class COOPGAME_API USMatchRecorderComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	// Sets default values for this component's properties
+	USMatchRecorderComponent();
+
+	/* Recorder of the current game mode, null on clients */
+	static USMatchRecorderComponent* Get(const UObject* WorldContextObject);
+
+protected:
+	// Called when the game starts
+	virtual void BeginPlay() override;
+
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	/* Seconds between player position and aim samples */
+	UPROPERTY(EditDefaultsOnly, Category = "MatchRecorder", meta = (ClampMin = 0.01f))
+	float SampleInterval;
+
+	/* Tick rate the replay is stepped at */
+	UPROPERTY(EditDefaultsOnly, Category = "MatchRecorder", meta = (ClampMin = 1.0f))
+	float ReplayTickRate;
+
+	bool bRecording;
+
+	bool bReplaying;
+
+	int32 Seed;
+
+	float StartTime;
+
+	float LastSampleTime;
+
+	// Recording: serialized events, written out at the end of the match
+	TArray<uint8> EventData;
+
+	TUniquePtr<FArchive> EventWriter;
+
+	// Recording: slot of every player seen so far
+	TMap<TWeakObjectPtr<AController>, uint8> PlayerSlots;
+
+	// Replay: the whole log and a reader over it
+	TArray<uint8> ReplayData;
+
+	TUniquePtr<FArchive> EventReader;
+
+	FSMatchEvent NextEvent;
+
+	bool bHasNextEvent;
+
+	FString ReplayFileName;
+
+	// Replay: stand-in pawn for every recorded player slot
+	TMap<uint8, TWeakObjectPtr<APawn>> Puppets;
+
+	FSMatchStats RecordedStats;
+
+	FSMatchStats ReplayedStats;
+
+	TArray<float> FrameTimes;
+
+	double LastFrameRealTime;
+
+	float ReplayEndTime;
+
+	void StartRecording();
+
+	void StartReplay(const FString& FileName);
+
+	void WriteEvent(FSMatchEvent& Event);
+
+	bool ReadNextEvent();
+
+	void SamplePlayers();
+
+	// Slot of a player-controlled pawn, INDEX_NONE for bots
+	int32 FindOrAddSlot(APawn* Pawn);
+
+	void ApplyEvent(const FSMatchEvent& Event);
+
+	APawn* GetOrSpawnPuppet(uint8 Slot, const FVector& Location, const FRotator& Rotation);
+
+	void FinishReplay();
+
+	FString GetRecordingDir() const;
+
+	UFUNCTION()
+	void HandleActorKilled(AActor* VictimActor, AActor* KillerActor, AController* KillerController);
+
+public:
+	// Called every frame
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+	bool IsRecording() const;
+
+	/* While replaying, waves and bot spawns come from the log instead of the game mode's own timers */
+	bool IsReplaying() const;
+
+	void RecordShot(APawn* Shooter, float ShotTime);
+
+	void RecordBotSpawn();
+
+	void RecordWaveState(EWaveState NewState);
+
+	void RecordDamage(AActor* Victim, float Damage);
+};
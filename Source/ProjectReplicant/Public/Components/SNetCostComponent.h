@@ -0,0 +1,195 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "SNetCostComponent.generated.h"
+
+class UNetDriver;
+class UProperty;
+struct FOutParmRec;
+
+enum class ESNetCostKind : uint8
+{
+	// Everything sent for one actor class, properties of its replicated components included
+	Actor,
+
+	Property,
+
+	RPC,
+};
+
+// One row of the report, Name is None for actor rows
+struct FSNetCostKey
+{
+	ESNetCostKind Kind;
+
+	FName Owner;
+
+	FName Name;
+
+	bool operator==(const FSNetCostKey& Other) const
+	{
+		return Kind == Other.Kind && Owner == Other.Owner && Name == Other.Name;
+	}
+
+	friend uint32 GetTypeHash(const FSNetCostKey& Key)
+	{
+		return HashCombine(HashCombine(GetTypeHash(Key.Owner), GetTypeHash(Key.Name)), (uint32)Key.Kind);
+	}
+};
+
+struct FSNetCostCounters
+{
+	int64 Bits = 0;
+
+	int32 Sends = 0;
+
+	uint64 CompareCycles = 0;
+
+	void Add(const FSNetCostCounters& Other)
+	{
+		Bits += Other.Bits;
+		Sends += Other.Sends;
+		CompareCycles += Other.CompareCycles;
+	}
+};
+
+// Replicated properties of one object as last serialized, to tell which ones changed
+struct FSNetCostShadow
+{
+	TArray<TArray<uint8>> Values;
+
+	double NextSampleTime = 0.0;
+};
+
+// Who changes to a replicated property go to, from its replication condition
+enum class ESNetCostAudience : uint8
+{
+	Everyone,
+
+	OwnerOnly,
+
+	SkipOwner,
+};
+
+struct FSNetCostProperty
+{
+	UProperty* Property;
+
+	ESNetCostAudience Audience;
+};
+
+// Client connections with an actor's channel open, the owning connection counted apart
+struct FSNetCostChannels
+{
+	int32 NumOthers = 0;
+
+	bool bOwner = false;
+
+	int32 Num() const
+	{
+		return NumOthers + (bOwner ? 1 : 0);
+	}
+
+	int32 Num(ESNetCostAudience Audience) const
+	{
+		switch (Audience)
+		{
+		case ESNetCostAudience::OwnerOnly:
+			return bOwner ? 1 : 0;
+		case ESNetCostAudience::SkipOwner:
+			return NumOthers;
+		default:
+			return Num();
+		}
+	}
+};
+
+// Latest count of one actor class, not windowed
+struct FSNetCostActorState
+{
+	int32 NumActors = 0;
+
+	int32 NumDormant = 0;
+
+	// Open actor channels summed over client connections
+	int32 NumChannels = 0;
+};
+
+
+/* Server-side net cost inspector for CoopGame actors, sums bytes, sends and compare time per actor class, property and RPC over a rolling window. Off until coop.NetCostStart */
+UCLASS( ClassGroup=(COOP), meta=(BlueprintSpawnableComponent) )
+class COOPGAME_API USNetCostComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	// Sets default values for this component's properties
+	USNetCostComponent();
+
+	/* Clears what was gathered and starts sampling, WindowSeconds of zero keeps the default */
+	void StartInspecting(float InWindowSeconds);
+
+	void StopInspecting();
+
+	bool IsInspecting() const;
+
+	/* Logs the MaxRows most expensive rows by bytes */
+	void LogReport(int32 MaxRows) const;
+
+	/* Writes every row to Saved/Profiling/NetCost, returns the file path or an empty string */
+	FString DumpToCSV() const;
+
+protected:
+
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	/* Seconds of history reports cover */
+	UPROPERTY(EditDefaultsOnly, Category = "Net Cost", meta = (ClampMin = 1.0f))
+	float WindowSeconds;
+
+	bool bInspecting;
+
+	double StartTime;
+
+	double LastSampleTime;
+
+	// One second each, the oldest is cleared when the window moves on
+	TArray<TMap<FSNetCostKey, FSNetCostCounters>> Buckets;
+
+	int32 CurrentBucket;
+
+	double CurrentBucketStartTime;
+
+	TMap<TWeakObjectPtr<UObject>, FSNetCostShadow> Shadows;
+
+	// Replicated properties per class, in the order shadows store them
+	TMap<const UClass*, TArray<FSNetCostProperty>> ClassProperties;
+
+	TMap<FName, FSNetCostActorState> ActorStates;
+
+	TWeakObjectPtr<UNetDriver> BoundNetDriver;
+
+	void AdvanceBuckets(double Now);
+
+	void SampleActor(AActor* Actor, FName ActorClassName, const FSNetCostChannels& Channels, double Now);
+
+	/* Serializes Object's replicated properties and counts the ones that changed since the last sample once per channel their condition sends them to. Flags whether the owner and the others got anything */
+	void CompareObject(UObject* Object, FSNetCostShadow& Shadow, FSNetCostCounters& ActorCounters, const FSNetCostChannels& Channels, bool& bOutOwnerSent, bool& bOutOthersSent);
+
+	/* Properties and their audience from the class's GetLifetimeReplicatedProps, ones only sent in the initial bunch are left out */
+	const TArray<FSNetCostProperty>& GetReplicatedProperties(const UClass* Class);
+
+	void HandleSendRPC(AActor* Actor, UFunction* Function, void* Parameters, FOutParmRec* OutParms, FFrame* Stack, UObject* SubObject, bool& bBlockSendRPC);
+
+	/* Sum of all buckets, the window so far */
+	void GatherTotals(TMap<FSNetCostKey, FSNetCostCounters>& OutTotals) const;
+
+	double GetWindowLength() const;
+
+public:
+	// Called every frame
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+};
@@ -0,0 +1,45 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "SPickupGridComponent.generated.h"
+
+class ASPickupActor;
+
+
+/* Server-side pickup proximity, pickups register in a grid of cells and only living players' cells are checked at a fixed rate, no overlap events needed */
+UCLASS( ClassGroup=(COOP), meta=(BlueprintSpawnableComponent) )
+class COOPGAME_API USPickupGridComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	// Sets default values for this component's properties
+	USPickupGridComponent();
+
+	/* Pickup grid of the current game mode, null on clients */
+	static USPickupGridComponent* Get(const UObject* WorldContextObject);
+
+	void RegisterPickup(ASPickupActor* Pickup);
+
+	void UnregisterPickup(ASPickupActor* Pickup);
+
+protected:
+
+	/* Edge length of a grid cell, keep it larger than a pickup radius plus a capsule radius */
+	UPROPERTY(EditDefaultsOnly, Category = "Pickups", meta = (ClampMin = 100.0f))
+	float CellSize;
+
+	// Pickups never move, so a cell's list only changes when one is added or removed
+	TMap<FIntPoint, TArray<TWeakObjectPtr<ASPickupActor>>> Cells;
+
+	int32 NumPickups;
+
+	FIntPoint GetCell(const FVector& Location) const;
+
+public:
+
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+};
@@ -0,0 +1,79 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "SRPCGuardComponent.generated.h"
+
+class UNetConnection;
+
+// Token bucket for one server RPC on one connection
+struct FSRPCBucket
+{
+	float Tokens = 0.0f;
+
+	float LastRefillTime = -1.0f;
+};
+
+// Everything the guard tracks per client connection
+struct FSConnectionRPCState
+{
+	TMap<FName, FSRPCBucket> Buckets;
+
+	uint64 LastFrame = 0;
+
+	int32 CallsThisFrame = 0;
+
+	// Drops since the last one second sweep, kicking is decided on this
+	int32 RecentDrops = 0;
+
+	int32 TotalAccepted = 0;
+
+	int32 TotalDropped = 0;
+};
+
+
+/* Server-side budget for client RPCs, caps calls per connection per frame and per function per second and kicks clients that keep flooding */
+UCLASS( ClassGroup=(COOP), meta=(BlueprintSpawnableComponent) )
+class COOPGAME_API USRPCGuardComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	// Sets default values for this component's properties
+	USRPCGuardComponent();
+
+	/* Call first in a server RPC's _Implementation and return when it fails. RPCs that stop something still do the stop and only skip extra work. Always true on listen hosts and when there is no guard */
+	static bool AllowRPC(const UObject* RPCTarget, FName FunctionName, float MaxCallsPerSecond);
+
+protected:
+
+	/* RPCs one connection may have processed per frame, across all functions */
+	UPROPERTY(EditDefaultsOnly, Category = "RPC Guard", meta = (ClampMin = 1))
+	int32 MaxRPCsPerFrame;
+
+	/* Seconds of a function's rate a client may bank for bursts */
+	UPROPERTY(EditDefaultsOnly, Category = "RPC Guard", meta = (ClampMin = 0.1f))
+	float BurstSeconds;
+
+	/* Kick a client that has more calls dropped than this within one second */
+	UPROPERTY(EditDefaultsOnly, Category = "RPC Guard", meta = (ClampMin = 1))
+	int32 MaxDropsPerSecond;
+
+	UPROPERTY(EditDefaultsOnly, Category = "RPC Guard")
+	bool bKickFloodingClients;
+
+	TMap<TWeakObjectPtr<UNetConnection>, FSConnectionRPCState> Connections;
+
+	bool ConsumeBudget(UNetConnection* Connection, FName FunctionName, float MaxCallsPerSecond);
+
+	void KickConnection(UNetConnection* Connection);
+
+public:
+	// Called every frame
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+	/* Accepted and dropped calls per connected player */
+	void LogReport() const;
+};
@@ -0,0 +1,165 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "SSoakTestComponent.generated.h"
+
+class ASCharacter;
+class APawn;
+enum class EWaveState : uint8;
+
+// Taken at the end of every soak wave
+struct FSSoakSample
+{
+	int32 Wave = 0;
+
+	float GameTime = 0.0f;
+
+	int32 NumActors = 0;
+
+	int32 NumObjects = 0;
+
+	int32 NumScheduledTimers = 0;
+
+	double UsedPhysicalMB = 0.0;
+
+	double UsedVirtualMB = 0.0;
+
+	// Real time per frame during the wave
+	float AvgFrameMs = 0.0f;
+
+	float P95FrameMs = 0.0f;
+
+	float MaxFrameMs = 0.0f;
+
+	TMap<FName, int32> ActorsPerClass;
+};
+
+// One value of a sample checked for growth, drops within Tolerance don't count
+struct FSSoakMetric
+{
+	FString Name;
+
+	double Value;
+
+	double Tolerance;
+};
+
+// A bot on the players' team the soak test spawns and aims in their place
+struct FSSoakDefender
+{
+	TWeakObjectPtr<ASCharacter> Character;
+
+	FTransform SpawnTransform;
+
+	// Game time to respawn at after dying, negative while alive
+	float RespawnTime = -1.0f;
+
+	bool bFiring = false;
+};
+
+
+/* Server-side soak test. -CoopSoak[=Waves] runs automatic waves headless with bots fighting bots, samples actors, objects, memory and frame time per wave and flags anything that keeps growing */
+UCLASS( ClassGroup=(COOP), meta=(BlueprintSpawnableComponent) )
+class COOPGAME_API USSoakTestComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	// Sets default values for this component's properties
+	USSoakTestComponent();
+
+protected:
+
+	virtual void BeginPlay() override;
+
+	/* Waves to run when -CoopSoak gives no count, the server exits after the last one */
+	UPROPERTY(EditDefaultsOnly, Category = "Soak Test", meta = (ClampMin = 1))
+	int32 NumWaves;
+
+	/* Bot spawns every wave, the same each wave so growth points at leaks rather than wave size */
+	UPROPERTY(EditDefaultsOnly, Category = "Soak Test", meta = (ClampMin = 1))
+	int32 BotSpawnsPerWave;
+
+	/* Bots on the players' team spawned at player starts */
+	UPROPERTY(EditDefaultsOnly, Category = "Soak Test", meta = (ClampMin = 1))
+	int32 NumDefenders;
+
+	/* Defenders shoot at enemy bots within this distance they can see */
+	UPROPERTY(EditDefaultsOnly, Category = "Soak Test", meta = (ClampMin = 100.0f))
+	float DefenderRange;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Soak Test", meta = (ClampMin = 0.0f))
+	float DefenderRespawnDelay;
+
+	/* Fixed tick rate the soak is stepped at, as fast as the machine allows */
+	UPROPERTY(EditDefaultsOnly, Category = "Soak Test", meta = (ClampMin = 1.0f))
+	float SoakTickRate;
+
+	/* Waves at the start left out of growth checks while pools and caches fill up */
+	UPROPERTY(EditDefaultsOnly, Category = "Soak Test", meta = (ClampMin = 0))
+	int32 WarmupWaves;
+
+	/* A value is flagged when it hasn't dropped once over this many waves and ended higher */
+	UPROPERTY(EditDefaultsOnly, Category = "Soak Test", meta = (ClampMin = 3))
+	int32 GrowthWaves;
+
+	/* Memory and frame time drops smaller than these count as no drop */
+	UPROPERTY(EditDefaultsOnly, Category = "Soak Test", meta = (ClampMin = 0.0f))
+	float MemoryToleranceMB;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Soak Test", meta = (ClampMin = 0.0f))
+	float FrameTimeToleranceMs;
+
+	bool bSoaking;
+
+	int32 WavesToRun;
+
+	TArray<FSSoakDefender> Defenders;
+
+	TArray<FSSoakSample> Samples;
+
+	// Names of values already flagged, each is only reported once
+	TSet<FString> GrowingMetrics;
+
+	// Real time per frame since the last sample
+	TArray<float> FrameTimes;
+
+	double LastFrameRealTime;
+
+	float TimeToDefenderUpdate;
+
+	FString CSVPath;
+
+	void StartSoak(int32 InNumWaves);
+
+	void SpawnDefender(FSSoakDefender& Defender);
+
+	void UpdateDefenders();
+
+	ASCharacter* FindDefenderTarget(ASCharacter* Defender) const;
+
+	void TakeSample();
+
+	void CheckGrowth();
+
+	void AppendToCSV(const FSSoakSample& Sample) const;
+
+	void FinishSoak();
+
+public:
+	// Called every frame
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+	/* While soaking, waves have a fixed size and defenders are respawned instead of the match ending */
+	bool IsSoaking() const;
+
+	int32 GetBotSpawnsPerWave() const;
+
+	/* Defenders stand in for players, waves don't wait for them to die */
+	bool IsDefender(const APawn* Pawn) const;
+
+	void HandleWaveState(EWaveState NewState);
+};
@@ -0,0 +1,109 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "STickRateComponent.generated.h"
+
+// Why the server runs at its current tick rate
+UENUM(BlueprintType)
+enum class ESTickRateReason : uint8
+{
+	NoPlayers,
+
+	BetweenWaves,
+
+	Calm,
+
+	Combat,
+
+	// Wanted more than the game thread can afford
+	CpuBudget,
+};
+
+
+/* Server-side tick rate controller, runs slow between waves and fast in heavy combat as long as the frame fits the CPU budget */
+UCLASS( ClassGroup=(COOP), meta=(BlueprintSpawnableComponent) )
+class COOPGAME_API USTickRateComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	// Sets default values for this component's properties
+	USTickRateComponent();
+
+	/* Tick rate the dedicated server is aiming for, zero on clients and listen servers. Net update rates above it are wasted */
+	static int32 GetServerTickRate(const UObject* WorldContextObject);
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Tick Rate")
+	int32 GetCurrentTickRate() const;
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Tick Rate")
+	ESTickRateReason GetCurrentReason() const;
+
+	void LogReport() const;
+
+protected:
+
+	virtual void BeginPlay() override;
+
+	/* With no players connected, and between waves */
+	UPROPERTY(EditDefaultsOnly, Category = "Tick Rate", meta = (ClampMin = 1))
+	int32 IdleTickRate;
+
+	/* During a wave while nobody is taking damage */
+	UPROPERTY(EditDefaultsOnly, Category = "Tick Rate", meta = (ClampMin = 1))
+	int32 CalmTickRate;
+
+	/* During a wave at CombatHitsPerSecond or more */
+	UPROPERTY(EditDefaultsOnly, Category = "Tick Rate", meta = (ClampMin = 1))
+	int32 CombatTickRate;
+
+	/* The CPU budget never pushes the rate below this */
+	UPROPERTY(EditDefaultsOnly, Category = "Tick Rate", meta = (ClampMin = 1))
+	int32 MinTickRate;
+
+	/* Damage hits per second that count as full combat */
+	UPROPERTY(EditDefaultsOnly, Category = "Tick Rate", meta = (ClampMin = 1.0f))
+	float CombatHitsPerSecond;
+
+	/* Share of one core the game thread may use, lower it when several instances share a host */
+	UPROPERTY(EditDefaultsOnly, Category = "Tick Rate", meta = (ClampMin = 0.05f, ClampMax = 1.0f))
+	float CpuBudget;
+
+	/* The rate only drops after wanting a lower one for this long, it rises right away */
+	UPROPERTY(EditDefaultsOnly, Category = "Tick Rate", meta = (ClampMin = 0.0f))
+	float RateDecreaseDelay;
+
+	/* Game mode tick interval during waves, and between them */
+	UPROPERTY(EditDefaultsOnly, Category = "Tick Rate", meta = (ClampMin = 0.05f))
+	float WaveGameModeTickInterval;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Tick Rate", meta = (ClampMin = 0.05f))
+	float IdleGameModeTickInterval;
+
+	int32 CurrentTickRate;
+
+	ESTickRateReason CurrentReason;
+
+	// Seconds of game thread work per frame, smoothed
+	float AverageWorkSeconds;
+
+	float HitsPerSecond;
+
+	int32 LastHitsResolved;
+
+	float TimeToEvaluate;
+
+	// World time since a lower rate has been wanted, negative while it hasn't
+	float LowerRateWantedSince;
+
+	void Evaluate(float ElapsedSeconds);
+
+	void ApplyTickRate(int32 NewTickRate, ESTickRateReason NewReason);
+
+public:
+	// Called every frame
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+};
@@ -0,0 +1,139 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "SWeapon.h"
+#include "SWeaponComponent.generated.h"
+
+// Latest melee swing, replicated to everyone but the swinging player
+USTRUCT()
+struct FSMeleeSwing
+{
+	GENERATED_BODY()
+
+public:
+
+	// Bumped per swing so repeating the same combo step still replicates
+	UPROPERTY()
+	uint8 SwingCounter = 0;
+
+	UPROPERTY()
+	uint8 ComboStep = 0;
+};
+
+
+/* Replicated weapon state of a character. The weapon actor itself is spawned locally on every machine and never gets its own channel */
+UCLASS( ClassGroup=(COOP), meta=(BlueprintSpawnableComponent) )
+class COOPGAME_API USWeaponComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	// Sets default values for this component's properties
+	USWeaponComponent();
+
+protected:
+
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	UPROPERTY(ReplicatedUsing = OnRep_WeaponClass)
+	TSubclassOf<ASWeapon> WeaponClass;
+
+	// This machine's copy of the weapon
+	UPROPERTY(Transient)
+	ASWeapon* Weapon;
+
+	UPROPERTY(ReplicatedUsing = OnRep_HitScanTrace)
+	FHitScanTrace HitScanTrace;
+
+	UPROPERTY(ReplicatedUsing = OnRep_MeleeSwing)
+	FSMeleeSwing MeleeSwing;
+
+	/* Most aim updates a remote player sends per second while the trigger is held */
+	UPROPERTY(EditDefaultsOnly, Category = "Weapon", meta = (ClampMin = 1.0f))
+	float MaxAimUpdateRate;
+
+	/* How far a remote player's eye location may be from where the server has their pawn, for latency and quantization. Further is clamped */
+	UPROPERTY(EditDefaultsOnly, Category = "Weapon", meta = (ClampMin = 0.0f))
+	float MaxAimLocationError;
+
+	// Client side, last aim sent and when
+	FVector SentAimLocation;
+
+	FRotator SentAimRotation;
+
+	float SentAimTime;
+
+	// Server side, the remote player's latest aim and when it arrived
+	FVector ClientAimLocation;
+
+	FRotator ClientAimRotation;
+
+	float ClientAimTime;
+
+	// Server side, when the trigger went down in the client's estimate of server time and when the press arrived
+	float TriggerDownTime;
+
+	float TriggerArrivalTime;
+
+	FSScheduleHandle TimerHandle_TriggerRelease;
+
+	void ReleaseTrigger();
+
+	/* Stores the client's aim, its eye location clamped to MaxAimLocationError around the server pawn's eyes */
+	void SetClientAim(const FVector_NetQuantize& EyeLocation, uint16 Pitch, uint16 Yaw);
+
+	float GetServerTime() const;
+
+	UFUNCTION(Server, Reliable, WithValidation)
+	void ServerPressTrigger(float PressTime, FVector_NetQuantize EyeLocation, uint16 Pitch, uint16 Yaw);
+
+	UFUNCTION(Server, Reliable, WithValidation)
+	void ServerReleaseTrigger(float ReleaseTime);
+
+	UFUNCTION(Server, Unreliable, WithValidation)
+	void ServerShotAim(FVector_NetQuantize EyeLocation, uint16 Pitch, uint16 Yaw);
+
+	void SpawnWeapon();
+
+	UFUNCTION()
+	void OnRep_WeaponClass();
+
+	UFUNCTION()
+	void OnRep_HitScanTrace();
+
+	UFUNCTION()
+	void OnRep_MeleeSwing();
+
+public:
+
+	/* Server only, every machine spawns its own copy of the new weapon */
+	void EquipWeapon(TSubclassOf<ASWeapon> NewWeaponClass);
+
+	ASWeapon* GetWeapon() const;
+
+	// Server only, replicated to everyone but the shooter who already played the shot
+	void SetHitScanTrace(const FVector& TraceTo, EPhysicalSurface SurfaceType);
+
+	void SetMeleeSwing(int32 ComboStep);
+
+	// Remote player side, one reliable RPC per trigger change instead of one per shot
+	void SendTriggerPressed(const FVector& EyeLocation, const FRotator& EyeRotation);
+
+	void SendTriggerReleased();
+
+	/* Unreliable and throttled to MaxAimUpdateRate, the server falls back to the pawn's view when none arrived lately */
+	void SendShotAim(const FVector& EyeLocation, const FRotator& EyeRotation);
+
+	/* Server side, the remote player's aim if it is recent enough to trust */
+	bool GetClientAim(FVector& OutEyeLocation, FRotator& OutEyeRotation) const;
+
+	/* Fire effects plus the projectile to simulate, replaces a replicated projectile actor */
+	UFUNCTION(NetMulticast, Unreliable)
+	void MultiCastProjectileSpawned(const FSProjectileSpawn& SpawnInfo);
+
+	UFUNCTION(NetMulticast, Unreliable)
+	void MultiCastProjectileImpact(uint16 ProjectileId, FVector_NetQuantize ImpactPoint, uint8 SurfaceType);
+};
@@ -4,12 +4,16 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Character.h"
+#include "SHitZone.h"
 #include "SCharacter.generated.h"
 
 class UCameraComponent;
 class USpringArmComponent;
 class ASWeapon;
 class USHealthComponent;
+class USWeaponComponent;
+class USCompactMovementComponent;
+class USHitboxRigComponent;
 
 UCLASS()
 class COOPGAME_API ASCharacter : public ACharacter
@@ -43,6 +47,16 @@ protected:
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Components")
 	USHealthComponent* HealthComp;
 
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Components")
+	USWeaponComponent* WeaponComp;
+
+	/* Off by default, bot blueprints turn it on to replace the full movement replication */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Components")
+	USCompactMovementComponent* CompactMovementComp;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Components")
+	USHitboxRigComponent* HitboxRigComp;
+
 	UPROPERTY(Replicated, BlueprintReadOnly, Category = "Player")
 	bool bWantsToZoom;
 
@@ -65,7 +79,8 @@ protected:
 
 	void EndZoom();
 
-	UPROPERTY(Replicated, VisibleAnywhere, BlueprintReadOnly, Category = "Player")
+	/* This machine's copy of the weapon, spawned by WeaponComp */
+	UPROPERTY(Transient, VisibleAnywhere, BlueprintReadOnly, Category = "Player")
 	ASWeapon* CurrentWeapon;
 
 	UPROPERTY(EditDefaultsOnly, Category = "Player")
@@ -82,6 +97,12 @@ protected:
 	UPROPERTY(Replicated, BlueprintReadOnly, Category = "Player")
 	bool bAttacked;
 
+	/* Hit zone per mesh bone, bones not listed fall back to the body's physical material */
+	UPROPERTY(EditDefaultsOnly, Category = "Player")
+	TMap<FName, ESHitZone> HitZoneBones;
+
+	bool bPooled;
+
 public:	
 	// Called every frame
 	virtual void Tick(float DeltaTime) override;
@@ -91,8 +112,24 @@ public:
 
 	virtual FVector GetPawnViewLocation() const override;
 
+	virtual float GetNetPriority(const FVector& ViewPos, const FVector& ViewDir, AActor* Viewer, AActor* ViewTarget, UActorChannel* InChannel, float Time, bool bLowBandwidth) override;
+
 	ASWeapon* GetCurrentWeapon();
 
+	void SetCurrentWeapon(ASWeapon* NewWeapon);
+
+	USHealthComponent* GetHealthComp() const;
+
+	bool IsDead() const;
+
+	/* Parks a horde bot without destroying it, pooled characters are hidden, don't tick or collide and aren't relevant to clients */
+	void SetPooled(bool bNewPooled);
+
+	bool IsPooled() const;
+
+	/* Refines a capsule hit against the hitbox rig, or the mesh bodies without one, returns false if the shot passes between them */
+	bool TraceHitZone(const FVector& TraceStart, const FVector& TraceEnd, FHitResult& OutHit, ESHitZone& OutZone) const;
+
 	UFUNCTION(BlueprintCallable, Category = "Player")
 	void StartFire();
 
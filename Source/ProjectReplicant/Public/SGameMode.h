@@ -4,10 +4,21 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/GameModeBase.h"
+#include "SScheduleHandle.h"
 #include "SGameMode.generated.h"
 
 
 enum class EWaveState : uint8;
+class USFlowFieldComponent;
+class USDamageQueueComponent;
+class USMatchRecorderComponent;
+class USHordeComponent;
+class USRPCGuardComponent;
+class USPickupGridComponent;
+class USTickRateComponent;
+class USNetCostComponent;
+class USSoakTestComponent;
+class ASLevelBakeData;
 
 
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_ThreeParams(FOnActorKilled, AActor*, VictimActor, AActor*, KillerActor, AController*, KillerController);
@@ -23,9 +34,36 @@ class COOPGAME_API ASGameMode : public AGameModeBase
 	
 protected:
 
-	FTimerHandle TimerHandle_BotSpawner;
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Components")
+	USFlowFieldComponent* FlowFieldComp;
 
-	FTimerHandle TimerHandle_NextWaveStart;
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Components")
+	USDamageQueueComponent* DamageQueueComp;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Components")
+	USMatchRecorderComponent* MatchRecorderComp;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Components")
+	USHordeComponent* HordeComp;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Components")
+	USRPCGuardComponent* RPCGuardComp;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Components")
+	USPickupGridComponent* PickupGridComp;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Components")
+	USTickRateComponent* TickRateComp;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Components")
+	USNetCostComponent* NetCostComp;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Components")
+	USSoakTestComponent* SoakTestComp;
+
+	FSScheduleHandle TimerHandle_BotSpawner;
+
+	FSScheduleHandle TimerHandle_NextWaveStart;
 
 	// Bots to spawn in current wave
 	int32 NrOfBotsToSpawn;
@@ -34,6 +72,21 @@ protected:
 
 	UPROPERTY(EditDefaultsOnly, Category = "GameMode")
 	float TimeBetweenWaves;
+
+	/* Horde agents added per bot spawn, when the horde component has a bot class */
+	UPROPERTY(EditDefaultsOnly, Category = "GameMode", meta = (ClampMin = 1))
+	int32 HordeGroupSize;
+
+	/* Bots spawned at baked points stay at least this far from every player */
+	UPROPERTY(EditDefaultsOnly, Category = "GameMode")
+	float MinBotSpawnDistance;
+
+	TWeakObjectPtr<ASLevelBakeData> LevelBakeData;
+
+	// Startup metrics, logged once when the first wave starts
+	double StartPlayTime;
+
+	bool bFirstWaveStarted;
 	
 protected:
 
@@ -41,8 +94,15 @@ protected:
 	UFUNCTION(BlueprintImplementableEvent, Category = "GameMode")
 	void SpawnNewBot();
 
+	/* Spawn point from the level's bake data, false when the map has none and SpawnNewBot should fall back to EQS */
+	UFUNCTION(BlueprintCallable, Category = "GameMode")
+	bool GetBakedBotSpawnPoint(FVector& OutLocation) const;
+
 	void SpawnBotTimerElapsed();
 
+	// Adds a horde group at a baked spawn point, or a single bot through BP
+	void SpawnBotGroup();
+
 	// Start Spawning Bots
 	void StartWave();
 
@@ -70,6 +130,29 @@ public:
 
 	virtual void Tick(float DeltaSeconds) override;
 
+	USFlowFieldComponent* GetFlowFieldComp() const;
+
+	USDamageQueueComponent* GetDamageQueueComp() const;
+
+	USMatchRecorderComponent* GetMatchRecorderComp() const;
+
+	USHordeComponent* GetHordeComp() const;
+
+	USRPCGuardComponent* GetRPCGuardComp() const;
+
+	USPickupGridComponent* GetPickupGridComp() const;
+
+	USTickRateComponent* GetTickRateComp() const;
+
+	USNetCostComponent* GetNetCostComp() const;
+
+	USSoakTestComponent* GetSoakTestComp() const;
+
+	// Driven by the match recorder while replaying
+	void ReplayBotSpawn();
+
+	void ReplayWaveState(EWaveState NewState);
+
 	UPROPERTY(BlueprintAssignable, Category = "GameMode")
 	FOnActorKilled OnActorKilled;
 };
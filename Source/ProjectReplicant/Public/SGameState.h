@@ -4,8 +4,15 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/GameStateBase.h"
+#include "SScoreboard.h"
 #include "SGameState.generated.h"
 
+class USFXManagerComponent;
+class USFireSchedulerComponent;
+class USLevelStreamerComponent;
+class USGameplaySchedulerComponent;
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnScoreboardChanged);
 
 UENUM(BlueprintType)
 enum class EWaveState : uint8
@@ -34,6 +41,18 @@ class COOPGAME_API ASGameState : public AGameStateBase
 
 protected:
 
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Components")
+	USFXManagerComponent* FXManagerComp;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Components")
+	USFireSchedulerComponent* FireSchedulerComp;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Components")
+	USLevelStreamerComponent* LevelStreamerComp;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Components")
+	USGameplaySchedulerComponent* GameplaySchedulerComp;
+
 	UFUNCTION()
 	void OnRep_WaveState(EWaveState OldState);
 
@@ -43,8 +62,45 @@ protected:
 	UPROPERTY(BlueprintReadOnly, ReplicatedUsing = OnRep_WaveState, Category = "GameState")
 	EWaveState WaveState;
 
+	UPROPERTY(BlueprintReadOnly, Replicated, Category = "GameState")
+	FSScoreboard Scoreboard;
+
+	virtual void PostInitializeComponents() override;
+
+	virtual void BeginPlay() override;
+
+	UFUNCTION()
+	void HandleActorKilled(AActor* VictimActor, AActor* KillerActor, AController* KillerController);
+
 public:
 
+	ASGameState();
+
+	virtual void AddPlayerState(APlayerState* PlayerState) override;
+
+	virtual void RemovePlayerState(APlayerState* PlayerState) override;
+
+	/* Fires on server and clients whenever a scoreboard row is added, removed or changed */
+	UPROPERTY(BlueprintAssignable, Category = "GameState")
+	FOnScoreboardChanged OnScoreboardChanged;
+
+	const FSScoreboard& GetScoreboard() const;
+
+	// Server only scoreboard updates
+	void RecordScore(APlayerState* PlayerState, float ScoreDelta);
+
+	void RecordDamage(AController* InstigatedBy, float Damage);
+
 	void SetWaveState(EWaveState NewState);
+
+	EWaveState GetWaveState() const;
+
+	USFXManagerComponent* GetFXManager() const;
+
+	USFireSchedulerComponent* GetFireScheduler() const;
+
+	USGameplaySchedulerComponent* GetGameplayScheduler() const;
+
+	USLevelStreamerComponent* GetLevelStreamer() const;
 	
 };
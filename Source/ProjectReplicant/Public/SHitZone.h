@@ -0,0 +1,17 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SHitZone.generated.h"
+
+// Coarse body regions used to scale weapon damage
+UENUM(BlueprintType)
+enum class ESHitZone : uint8
+{
+	Body,
+
+	Head,
+
+	Limb,
+};
@@ -0,0 +1,70 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "SFlowFieldComponent.h"
+#include "SLevelBakeData.generated.h"
+
+/**
+ * Place one per map. Holds bot spawn points and the flow field grid sampled from the navmesh in the editor,
+ * so the server doesn't compute them between loading the map and starting the first wave.
+ */
+UCLASS()
+class COOPGAME_API ASLevelBakeData : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	// Sets default values for this actor's properties
+	ASLevelBakeData();
+
+protected:
+
+	/* Bot spawn points are sampled on the navmesh within this radius of the actor */
+	UPROPERTY(EditAnywhere, Category = "Bake", meta = (ClampMin = 100.0f))
+	float SpawnPointRadius;
+
+	UPROPERTY(EditAnywhere, Category = "Bake", meta = (ClampMin = 1))
+	int32 NumSpawnPoints;
+
+	UPROPERTY(EditAnywhere, Category = "Bake", meta = (ClampMin = 0.0f))
+	float MinSpawnPointSpacing;
+
+	/* Should match the flow field component on the game mode */
+	UPROPERTY(EditAnywhere, Category = "Bake", meta = (ClampMin = 25.0f))
+	float FlowFieldCellSize;
+
+	UPROPERTY(EditAnywhere, Category = "Bake", meta = (ClampMin = 16, ClampMax = 1024))
+	int32 FlowFieldMaxCellsPerAxis;
+
+	UPROPERTY(EditAnywhere, Category = "Bake")
+	float FlowFieldMaxStepHeight;
+
+	/* Re-bake every time the level is saved or cooked, keeps the data in step with the navmesh */
+	UPROPERTY(EditAnywhere, Category = "Bake")
+	bool bBakeOnSave;
+
+	UPROPERTY(VisibleAnywhere, Category = "Bake")
+	TArray<FVector> BotSpawnPoints;
+
+	UPROPERTY()
+	FSFlowFieldGrid FlowFieldGrid;
+
+#if WITH_EDITOR
+	virtual void PreSave(const class ITargetPlatform* TargetPlatform) override;
+#endif
+
+public:
+
+	/* Samples spawn points and the flow field grid from the level's navmesh, keeps the previous data if there is no navmesh */
+	UFUNCTION(CallInEditor, Category = "Bake")
+	void Bake();
+
+	const FSFlowFieldGrid& GetFlowFieldGrid() const;
+
+	/* Random baked spawn point at least MinDistanceToPlayers from every player, for SpawnNewBot in place of an EQS query */
+	UFUNCTION(BlueprintCallable, Category = "Bake")
+	bool GetBotSpawnPoint(float MinDistanceToPlayers, FVector& OutLocation) const;
+};
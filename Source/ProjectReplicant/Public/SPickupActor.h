@@ -4,6 +4,7 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
+#include "SScheduleHandle.h"
 #include "SPickupActor.generated.h"
 
 class USphereComponent;
@@ -23,6 +24,8 @@ protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
 
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 	UPROPERTY(VisibleAnywhere, Category = "Components")
 	USphereComponent* SphereComp;
 
@@ -32,18 +35,22 @@ protected:
 	UPROPERTY(EditInstanceOnly, Category = "PickupActor")
 	TSubclassOf<ASPowerupActor> PowerUpClass;
 
+	UPROPERTY(Transient)
 	ASPowerupActor* PowerUpInstance;
 
 	UPROPERTY(EditInstanceOnly, Category = "PickupActor")
 	float CooldownDuration;
 
-	FTimerHandle TimerHandle_RespawnTimer;
+	FSScheduleHandle TimerHandle_RespawnTimer;
 
 	void Respawn();
 
 public:	
 
-	virtual void NotifyActorBeginOverlap(AActor* OtherActor) override;
+	/* Server only, called by the pickup grid when a living player is in reach */
+	void ActivateFor(AActor* OtherActor);
 
-	
+	bool HasPowerup() const;
+
+	float GetPickupRadius() const;
 };
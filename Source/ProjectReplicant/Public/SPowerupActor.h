@@ -4,6 +4,7 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
+#include "SScheduleHandle.h"
 #include "SPowerupActor.generated.h"
 
 UCLASS()
@@ -25,7 +26,7 @@ protected:
 	UPROPERTY(EditDefaultsOnly, Category = "Powerups")
 	int32 TotalNrOfTicks;
 
-	FTimerHandle TimerHandle_PowerupTick;
+	FSScheduleHandle TimerHandle_PowerupTick;
 
 	// Total number of ticks applied
 	int32 TicksProcessed;
@@ -0,0 +1,25 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+// Due callbacks run grouped by system in this order, each group in the order its timers expired
+enum class ESScheduleGroup : uint8
+{
+	Wave,
+
+	Pickup,
+
+	Powerup,
+
+	Weapon,
+};
+
+// Refers to one callback on the gameplay scheduler, goes stale on its own once the callback has run or was cancelled
+struct FSScheduleHandle
+{
+	int32 Index = INDEX_NONE;
+
+	uint32 Serial = 0;
+};
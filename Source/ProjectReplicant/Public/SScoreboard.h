@@ -0,0 +1,96 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/NetSerialization.h"
+#include "SScoreboard.generated.h"
+
+class APlayerState;
+class ASGameState;
+struct FSScoreboard;
+
+// One player's row, only rows that changed are sent
+USTRUCT(BlueprintType)
+struct FSScoreboardEntry : public FFastArraySerializerItem
+{
+	GENERATED_BODY()
+
+public:
+
+	UPROPERTY(BlueprintReadOnly, Category = "Scoreboard")
+	APlayerState* PlayerState = nullptr;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Scoreboard")
+	int32 Score = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Scoreboard")
+	int32 Kills = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Scoreboard")
+	int32 Deaths = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Scoreboard")
+	int32 DamageDealt = 0;
+
+	void PreReplicatedRemove(const FSScoreboard& InArraySerializer);
+
+	void PostReplicatedAdd(const FSScoreboard& InArraySerializer);
+
+	void PostReplicatedChange(const FSScoreboard& InArraySerializer);
+};
+
+
+// Per-player stats for the whole match, delta replicated through the game state
+USTRUCT(BlueprintType)
+struct FSScoreboard : public FFastArraySerializer
+{
+	GENERATED_BODY()
+
+public:
+
+	UPROPERTY(BlueprintReadOnly, Category = "Scoreboard")
+	TArray<FSScoreboardEntry> Entries;
+
+	// Receives change notifications on clients
+	UPROPERTY(NotReplicated)
+	ASGameState* OwnerGameState = nullptr;
+
+	bool NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParms)
+	{
+		return FFastArraySerializer::FastArrayDeltaSerialize<FSScoreboardEntry, FSScoreboard>(Entries, DeltaParms, *this);
+	}
+
+	const FSScoreboardEntry* FindEntry(const APlayerState* PlayerState) const;
+
+	// Server only, each call dirties just the row it touches
+	void AddPlayer(APlayerState* PlayerState);
+
+	void RemovePlayer(APlayerState* PlayerState);
+
+	void AddScore(APlayerState* PlayerState, float ScoreDelta);
+
+	void AddKill(APlayerState* PlayerState);
+
+	void AddDeath(APlayerState* PlayerState);
+
+	void AddDamage(APlayerState* PlayerState, float Damage);
+
+	void NotifyChanged() const;
+
+protected:
+
+	// Row per player state, rebuilt when rows are removed
+	TMap<const APlayerState*, int32> EntryIndices;
+
+	FSScoreboardEntry* FindOrAddEntry(APlayerState* PlayerState);
+};
+
+template<>
+struct TStructOpsTypeTraits<FSScoreboard> : public TStructOpsTypeTraitsBase2<FSScoreboard>
+{
+	enum
+	{
+		WithNetDeltaSerializer = true,
+	};
+};
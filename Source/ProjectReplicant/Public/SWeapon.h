@@ -4,6 +4,8 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
+#include "SHitZone.h"
+#include "SScheduleHandle.h"
 #include "SWeapon.generated.h"
 
 class USkeletalMeshComponent;
@@ -12,6 +14,12 @@ class UParticleSystem;
 class AProjectile;
 class UBoxComponent;
 class ASCharacter;
+class USWeaponData;
+class USWeaponComponent;
+class UAnimMontage;
+class USoundBase;
+class UCameraShake;
+struct FStreamableHandle;
 
 // Contains information of a single hitscan weapon linetrace
 USTRUCT()
@@ -21,6 +29,10 @@ struct FHitScanTrace
 
 public:
 
+	// Bumped per shot so two shots at the same spot still replicate
+	UPROPERTY()
+	uint8 ShotCounter = 0;
+
 	UPROPERTY()
 	TEnumAsByte<EPhysicalSurface> SurfaceType;
 
@@ -28,10 +40,33 @@ public:
 	FVector_NetQuantize TraceTo;
 };
 
+// Everything a client needs to simulate a projectile the server fired
+USTRUCT()
+struct FSProjectileSpawn
+{
+	GENERATED_BODY()
+
+public:
+
+	UPROPERTY()
+	FVector_NetQuantize Origin;
+
+	UPROPERTY()
+	FVector_NetQuantizeNormal Direction;
+
+	UPROPERTY()
+	uint16 Speed;
+
+	// Matches the server's projectile to the client's simulation, also seeds it
+	UPROPERTY()
+	uint16 ProjectileId;
+};
+
 UENUM()
 enum class WeaponType : uint8 { Melee, Hitscan, Projectile };
 
 
+/* Not replicated, every machine spawns its own copy through the owner's USWeaponComponent which carries the weapon's network state */
 UCLASS()
 class COOPGAME_API ASWeapon : public AActor
 {
@@ -45,6 +80,8 @@ protected:
 
 	virtual void BeginPlay() override;
 
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Components")
 	USkeletalMeshComponent* MeshComp;
 
@@ -58,10 +95,6 @@ protected:
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Weapon")
 	UBoxComponent* CollisionComp;
 
-	/** Projectile class to spawn */
-	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Weapon")
-	TSubclassOf<AProjectile> ProjectileClass;
-
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Weapon")
 	TSubclassOf<UDamageType> DamageType;
 
@@ -74,72 +107,103 @@ protected:
 	UPROPERTY(VisibleDefaultsOnly, BlueprintReadOnly, Category = "Weapon")
 	FName TracerTargetName;
 
+	/* Projectile, montages and effects, streamed in through the asset manager after spawn */
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Weapon")
+	USWeaponData* WeaponData;
+
+	// Keeps the loaded WeaponData bundles resident for the weapon's lifetime
+	TSharedPtr<FStreamableHandle> WeaponDataHandle;
+
+	void LoadWeaponData();
+
+	void OnWeaponDataLoaded();
+
+	/* Legacy hard references, only used while WeaponData is unset. Clear them once the weapon has a data asset, Blueprint graphs still reading them get the legacy value */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Weapon|Legacy")
+	TSubclassOf<AProjectile> ProjectileClass;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Weapon|Legacy")
 	UParticleSystem* MuzzleEffect;
 
-	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Weapon")
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Weapon|Legacy")
 	UParticleSystem* DefaultImpactEffect;
 
-	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Weapon")
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Weapon|Legacy")
 	UParticleSystem* FleshImpactEffect;
 
-	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Weapon")
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Weapon|Legacy")
 	UParticleSystem* TracerEffect;
 
-	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Weapon")
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Weapon|Legacy")
 	USoundBase* FireSound;
 
-	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Weapon")
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Weapon|Legacy")
 	USoundBase* ImpactSound;
 
-	UPROPERTY(EditDefaultsOnly, Category = "Weapon")
+	UPROPERTY(EditDefaultsOnly, Category = "Weapon|Legacy")
 	TSubclassOf<UCameraShake> FireCamShake;
 
+	UPROPERTY(EditDefaultsOnly, Category = "Weapon|Legacy")
+	UAnimMontage* ComboMontage1;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Weapon|Legacy")
+	UAnimMontage* ComboMontage2;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Weapon|Legacy")
+	UAnimMontage* ComboMontage3;
+
 	UPROPERTY(EditDefaultsOnly, Category = "Weapon")
 	float BaseDamage;
 
-	void Fire();
+	/* BaseDamage multiplier per hit zone, zones not listed deal BaseDamage */
+	UPROPERTY(EditDefaultsOnly, Category = "Weapon")
+	TMap<ESHitZone, float> HitZoneDamageMultipliers;
+
+	/* Snap impact effects onto complex geometry with a short local trace, cosmetic only */
+	UPROPERTY(EditDefaultsOnly, Category = "Weapon")
+	bool bTraceComplexForImpactEffects;
+
+	void OnHitScanFire(float ShotTime);
 
-	void OnHitScanFire();
+	bool TraceHitScanShot(const FVector& TraceStart, const FVector& TraceEnd, FCollisionQueryParams& QueryParams, FHitResult& OutHit, ESHitZone& OutZone) const;
 
 	void OnProjectileFire();
 
 	void OnMeleeFire();
 
-	void PlayAnimation();
+	// Plays the next combo montage and arms the melee hitbox, returns the combo step played or 0
+	int32 PlayAnimation();
 	void PlaySoundEffect();
 	void SpawnProjectile();
 
-	UFUNCTION(NetMulticast, Reliable, WithValidation)
-	void MultiCastAnimation();
-	UFUNCTION(NetMulticast, Reliable, WithValidation)
-	void MultiCastPlayParticleEffect();
-	UFUNCTION(NetMulticast, Reliable, WithValidation)
-	void MultiCastPlaySoundEffect();
-	UFUNCTION(NetMulticast, Reliable, WithValidation)
-	void MultiCastSpawnProjectile();
+	AProjectile* SpawnLocalProjectile(const FSProjectileSpawn& SpawnInfo, bool bSimulated);
 
+	// Next id handed to a server projectile, wraps around
+	uint16 NextProjectileId;
 
-	UFUNCTION(Server, Reliable, WithValidation)
-	void ServerFire();
+	// Client-side simulations of server projectiles still in flight
+	TMap<uint16, TWeakObjectPtr<AProjectile>> SimulatedProjectiles;
 
-	UFUNCTION(Server, Reliable, WithValidation)
-	void ServerAnimation();
+	// Replicated state and RPCs live on the owning character
+	USWeaponComponent* GetWeaponComp() const;
 
-	UFUNCTION(Server, Reliable, WithValidation)
-	void ServerPlayParticleEffect();
+	// The weapon is local everywhere, authority is the owner's
+	bool HasOwnerAuthority() const;
 
-	UFUNCTION(Server, Reliable, WithValidation)
-	void ServerPlaySoundEffect();
+	FSScheduleHandle MeleeTimerHandle;
+	FSScheduleHandle ComboResetTimerHandle;
 
-	UFUNCTION(Server, Reliable, WithValidation)
-	void ServerSpawnProjectile();
+	// Exact time of the last shot, not the frame it was processed in
+	float LastFireTime;
 
-	FTimerHandle TimerHandle_TimeBetweenShots;
-	FTimerHandle MeleeTimerHandle;
-	FTimerHandle ComboResetTimerHandle;
+	// Owner's aim when the fire scheduler last ran, shots between two frames interpolate from here
+	FVector CachedEyeLocation;
 
-	float LastFireTime;
+	FRotator CachedEyeRotation;
+
+	float CachedEyeTime;
+
+	void GetShotViewPoint(float ShotTime, FVector& OutEyeLocation, FRotator& OutEyeRotation) const;
 
 	/* RPM - Bullets per minute fired by weapon */
 	UPROPERTY(EditDefaultsOnly, Category = "Weapon")
@@ -149,27 +213,23 @@ protected:
 	UPROPERTY(EditDefaultsOnly, Category = "Weapon", meta = (ClampMin=0.0f))
 	float BulletSpread;
 
-	UPROPERTY(EditDefaultsOnly, Category = "Montage")
-	UAnimMontage* ComboMontage1;
+	int ComboCounter = 1;
 
-	UPROPERTY(EditDefaultsOnly, Category = "Montage")
-	UAnimMontage* ComboMontage2;
-	
-	UPROPERTY(EditDefaultsOnly, Category = "Montage")
-	UAnimMontage* ComboMontage3;
+	UAnimMontage* GetComboMontage(int32 ComboStep) const;
 
-	int ComboCounter = 1;
+	UClass* GetProjectileClass() const;
 
-	// Derived from RateOfFire
-	float TimeBetweenShots;
+	UParticleSystem* GetMuzzleEffect() const;
 
-	UPROPERTY(ReplicatedUsing=OnRep_HitScanTrace)
-	FHitScanTrace HitScanTrace;
+	UParticleSystem* GetTracerEffect() const;
 
-	TArray<ASCharacter*> RecentlyHit;
+	TSubclassOf<UCameraShake> GetFireCamShake() const;
 
-	UFUNCTION()
-	void OnRep_HitScanTrace();
+	// Derived from RateOfFire
+	float TimeBetweenShots;
+
+	// Weak so a character destroyed mid-swing can't leave a dangling entry
+	TArray<TWeakObjectPtr<ASCharacter>> RecentlyHit;
 
 	UFUNCTION()
 	void OnWeaponOverlap(UPrimitiveComponent* HitComp, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult);
@@ -192,8 +252,15 @@ public:
 
 	void StopFire();
 
+	/* Fires one shot that happened at ShotTime, called by the fire scheduler */
+	void Fire(float ShotTime);
+
+	void CacheShotViewPoint();
+
 	float GetBaseDamage();
 
+	float GetTimeBetweenShots() const;
+
 	TSubclassOf<UDamageType> GetDamageType();
 
 	USkeletalMeshComponent* GetWepMesh();
@@ -206,4 +273,19 @@ public:
 	UParticleSystem* GetFleshImpactEffect();
 	USoundBase* GetFireSound();
 	USoundBase* GetImpactSound();
+
+	/* Called by the server's projectile when it hits, ends the matching simulation on clients */
+	void OnProjectileImpact(uint16 ProjectileId, const FVector& ImpactPoint, EPhysicalSurface SurfaceType);
+
+	// Replicated through USWeaponComponent, plays what another machine fired
+	void OnRemoteHitScanShot(const FHitScanTrace& Trace);
+
+	void OnRemoteMeleeSwing(int32 ComboStep);
+
+	void OnRemoteProjectileSpawned(const FSProjectileSpawn& SpawnInfo);
+
+	void OnRemoteProjectileImpact(uint16 ProjectileId, const FVector& ImpactPoint, EPhysicalSurface SurfaceType);
+
+	/* Average seconds spent on one shot's effects, sound and impact, used by coop.BenchmarkShotCosmetics. Only meaningful where cosmetics play, negative where they don't */
+	double MeasureShotCosmeticsCost(int32 NumShots);
 };
@@ -0,0 +1,67 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "SWeaponData.generated.h"
+
+class AProjectile;
+class UAnimMontage;
+class UParticleSystem;
+class USoundBase;
+class UCameraShake;
+
+/**
+ * Assets used by a weapon, soft referenced so they stream in after the weapon spawns.
+ * Gameplay bundle loads everywhere, Cosmetic bundle is never loaded on dedicated servers.
+ */
+UCLASS(BlueprintType)
+class COOPGAME_API USWeaponData : public UPrimaryDataAsset
+{
+	GENERATED_BODY()
+
+public:
+
+	static const FPrimaryAssetType PrimaryAssetType;
+
+	static const FName GameplayBundle;
+
+	static const FName CosmeticBundle;
+
+	virtual FPrimaryAssetId GetPrimaryAssetId() const override;
+
+	/** Projectile class to spawn */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Weapon", meta = (AssetBundles = "Gameplay"))
+	TSoftClassPtr<AProjectile> ProjectileClass;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Montage", meta = (AssetBundles = "Gameplay"))
+	TSoftObjectPtr<UAnimMontage> ComboMontage1;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Montage", meta = (AssetBundles = "Gameplay"))
+	TSoftObjectPtr<UAnimMontage> ComboMontage2;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Montage", meta = (AssetBundles = "Gameplay"))
+	TSoftObjectPtr<UAnimMontage> ComboMontage3;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Effects", meta = (AssetBundles = "Cosmetic"))
+	TSoftObjectPtr<UParticleSystem> MuzzleEffect;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Effects", meta = (AssetBundles = "Cosmetic"))
+	TSoftObjectPtr<UParticleSystem> DefaultImpactEffect;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Effects", meta = (AssetBundles = "Cosmetic"))
+	TSoftObjectPtr<UParticleSystem> FleshImpactEffect;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Effects", meta = (AssetBundles = "Cosmetic"))
+	TSoftObjectPtr<UParticleSystem> TracerEffect;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Effects", meta = (AssetBundles = "Cosmetic"))
+	TSoftObjectPtr<USoundBase> FireSound;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Effects", meta = (AssetBundles = "Cosmetic"))
+	TSoftObjectPtr<USoundBase> ImpactSound;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Effects", meta = (AssetBundles = "Cosmetic"))
+	TSoftClassPtr<UCameraShake> FireCamShake;
+};
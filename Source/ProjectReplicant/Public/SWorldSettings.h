@@ -0,0 +1,42 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/WorldSettings.h"
+#include "SWorldSettings.generated.h"
+
+
+USTRUCT()
+struct FSStreamedLevel
+{
+	GENERATED_BODY()
+
+	/* Sublevel name as shown in the Levels window */
+	UPROPERTY(EditAnywhere, Category = "Streaming")
+	FName LevelName;
+
+	/* Dedicated servers only stream levels with gameplay collision, bots or pickups in them */
+	UPROPERTY(EditAnywhere, Category = "Streaming")
+	bool bServerRelevant = false;
+};
+
+
+/**
+ * Per-map settings, loaded on every machine. Set as the project's World Settings class in DefaultEngine.ini
+ */
+UCLASS()
+class COOPGAME_API ASWorldSettings : public AWorldSettings
+{
+	GENERATED_BODY()
+
+protected:
+
+	/* Sublevels left out of the persistent level's always loaded set, in load order */
+	UPROPERTY(EditAnywhere, Category = "Streaming")
+	TArray<FSStreamedLevel> DeferredLevels;
+
+public:
+
+	const TArray<FSStreamedLevel>& GetDeferredLevels() const;
+};